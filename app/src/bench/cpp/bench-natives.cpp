@@ -0,0 +1,114 @@
+#include <jni.h>
+#include <pthread.h>
+#include "jni-cache.h"
+#include "jni-thread.h"
+#include "jni-util.h"
+
+/**
+ * BenchNatives.java 的JNI实现，只编译进桌面版的libstudy_jni.so
+ *
+ * 这里只放study_jni中没有对应入口的基准：空调用、注册方式对比、单次字段读写、单次上行调用、线程附加。
+ * 其余基准直接调用study_jni中真实的native函数(MainActivity、NativeArrays、NativeStrings...)
+ */
+
+//=======================空调用：静态注册 vs RegisterNatives=======================
+extern "C" JNIEXPORT void JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_emptyStatic(JNIEnv *env, jclass clazz) {
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_emptyInstance(JNIEnv *env, jobject thiz) {
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_addInts(JNIEnv *env, jclass clazz, jint a, jint b) {
+    return a + b;
+}
+
+//没有Java_前缀，只能通过RegisterNatives找到
+static void empty_registered(JNIEnv *env, jclass clazz) {
+}
+
+static jint add_ints_registered(JNIEnv *env, jclass clazz, jint a, jint b) {
+    return a + b;
+}
+
+static const JNINativeMethod kRegisteredMethods[] = {
+        {"emptyRegistered", "()V", (void *) empty_registered},
+        {"addIntsRegistered", "(II)I", (void *) add_ints_registered},
+};
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_nativeRegister(JNIEnv *env, jclass clazz) {
+    jint count = sizeof(kRegisteredMethods) / sizeof(JNINativeMethod);
+    return env->RegisterNatives(clazz, kRegisteredMethods, count) == JNI_OK ? JNI_TRUE : JNI_FALSE;
+}
+
+//=======================单次字段读写、上行调用(使用JNI ID缓存)=======================
+extern "C" JNIEXPORT jint JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_readAge(JNIEnv *env, jclass clazz, jobject student) {
+    return jni_cache().studentAgeFid.get(env, student);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_writeAge(JNIEnv *env, jclass clazz, jobject student, jint age) {
+    jni_cache().studentAgeFid.set(env, student, age);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_upcallGetAge(JNIEnv *env, jclass clazz, jobject student) {
+    return jni_cache().studentGetAgeMid(env, student);
+}
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_newDog(JNIEnv *env, jclass clazz) {
+    const JniCache &cache = jni_cache();
+    return cache.dogInitMid(env, cache.dogClass).release();
+}
+
+//=======================线程附加=======================
+struct AttachArgs {
+    jint rounds;
+    bool cached;
+    jlong nsPerOp;
+};
+
+/**
+ * 在一个新的C++线程中测量：
+ *      cached == false：每次都 AttachCurrentThread + DetachCurrentThread(以前nativeThread的写法)
+ *      cached == true：attach_current_thread()，只有第一次真正附加，之后只是GetEnv(线程池的写法)
+ */
+static void *attach_main(void *args) {
+    auto *attach = static_cast<AttachArgs *>(args);
+    JavaVMAttachArgs attachArgs{JNI_VERSION_1_6, "study_jni-bench", nullptr};
+    jlong start = now_ns();
+    for (jint i = 0; i < attach->rounds; ++i) {
+        JNIEnv *env = nullptr;
+        if (attach->cached) {
+            env = attach_current_thread("study_jni-bench");
+        } else if (::jvm->AttachCurrentThread(&env, &attachArgs) == JNI_OK) {
+            ::jvm->DetachCurrentThread();
+        }
+        if (!env) {
+            attach->nsPerOp = -1;
+            return nullptr;
+        }
+    }
+    attach->nsPerOp = (now_ns() - start) / attach->rounds;
+    return nullptr; //cached模式下线程退出时自动Detach
+}
+
+//返回单次耗时ns，失败返回-1
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_sawyer_studyjni_bench_BenchNatives_attachNs(JNIEnv *env, jclass clazz, jint rounds, jboolean cached) {
+    if (rounds <= 0) {
+        return -1;
+    }
+    AttachArgs args{rounds, cached == JNI_TRUE, -1};
+    pthread_t tid;
+    if (pthread_create(&tid, nullptr, attach_main, &args) != 0) {
+        return -1;
+    }
+    pthread_join(tid, nullptr);
+    return args.nsPerOp;
+}
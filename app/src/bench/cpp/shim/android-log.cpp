@@ -0,0 +1,35 @@
+#include <android/log.h>
+#include <cstdarg>
+#include <cstdio>
+
+static char priority_char(int prio) {
+    switch (prio) {
+        case ANDROID_LOG_VERBOSE:
+            return 'V';
+        case ANDROID_LOG_DEBUG:
+            return 'D';
+        case ANDROID_LOG_INFO:
+            return 'I';
+        case ANDROID_LOG_WARN:
+            return 'W';
+        case ANDROID_LOG_ERROR:
+            return 'E';
+        case ANDROID_LOG_FATAL:
+            return 'F';
+        default:
+            return '?';
+    }
+}
+
+extern "C" int __android_log_write(int prio, const char *tag, const char *text) {
+    return fprintf(stderr, "%c/%s: %s\n", priority_char(prio), tag ? tag : "", text ? text : "");
+}
+
+extern "C" int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    char buffer[1024];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    return __android_log_write(prio, tag, buffer);
+}
@@ -0,0 +1,33 @@
+#ifndef STUDYJNI_BENCH_ANDROID_LOG_H
+#define STUDYJNI_BENCH_ANDROID_LOG_H
+
+/**
+ * 桌面Linux上代替NDK的<android/log.h>，只保留study_jni用到的部分
+ * 实现在android-log.cpp中，输出到stderr
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+} android_LogPriority;
+
+int __android_log_write(int prio, const char *tag, const char *text);
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...)
+__attribute__((__format__(printf, 3, 4)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //STUDYJNI_BENCH_ANDROID_LOG_H
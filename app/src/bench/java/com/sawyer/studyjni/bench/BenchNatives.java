@@ -0,0 +1,38 @@
+package com.sawyer.studyjni.bench;
+
+import com.sawyer.studyjni.Dog;
+import com.sawyer.studyjni.Student;
+
+/**
+ * 只用于基准测试的native函数，见bench-natives.cpp
+ */
+final class BenchNatives {
+
+    static {
+        System.loadLibrary("study_jni");
+        if (!nativeRegister()) {
+            throw new UnsatisfiedLinkError("BenchNatives: RegisterNatives失败");
+        }
+    }
+
+    private BenchNatives() {
+    }
+
+    //静态注册(按Java_包名_类名_函数名查找)
+    static native void emptyStatic();
+    native void emptyInstance();
+    static native int addInts(int a, int b);
+
+    //动态注册(RegisterNatives)
+    static native void emptyRegistered();
+    static native int addIntsRegistered(int a, int b);
+    private static native boolean nativeRegister();
+
+    static native int readAge(Student student);
+    static native void writeAge(Student student, int age);
+    static native int upcallGetAge(Student student);
+    static native Dog newDog();
+
+    //在一个新的C++线程中附加rounds次，返回单次耗时ns
+    static native long attachNs(int rounds, boolean cached);
+}
@@ -0,0 +1,686 @@
+package com.sawyer.studyjni.bench;
+
+import com.sawyer.studyjni.Dog;
+import com.sawyer.studyjni.DogFactory;
+import com.sawyer.studyjni.FieldMirror;
+import com.sawyer.studyjni.GraphCodec;
+import com.sawyer.studyjni.MainActivity;
+import com.sawyer.studyjni.NativeArrays;
+import com.sawyer.studyjni.NativeStrings;
+import com.sawyer.studyjni.ParallelArrays;
+import com.sawyer.studyjni.Person;
+import com.sawyer.studyjni.Student;
+
+import java.io.BufferedReader;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStreamReader;
+import java.io.OutputStreamWriter;
+import java.io.PrintStream;
+import java.io.Writer;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
+
+/**
+ * study_jni的JNI微基准，在桌面JVM上运行(构建方法见app/src/bench/CMakeLists.txt)
+ *
+ * 每个基准：
+ *      1.预热：至少warmupMs，同时确定每个样本的迭代次数(使一个样本耗时约sampleMs)
+ *      2.采样：samples个样本，每个样本 = 迭代次数次调用的平均耗时
+ *      3.统计：mean、median、p90、min、max、stddev，单位ns/op
+ * 线程附加这类无法在Java端计时的基准，由native计时，每次调用返回一个样本
+ * 冷启动(startup.*)只能测量一次：在所有基准之前加载so，每个结果只有一个样本
+ *
+ * 结果以JSON输出(每个结果一行，方便diff)，--baseline 可以与之前的结果比较中位数
+ *
+ * 参数：
+ *      --warmup-ms N   --samples N   --sample-ms N   --filter 名字包含的字符串
+ *      --out 结果文件(默认stdout)   --baseline 旧的结果文件   --threshold 允许变慢的百分比(默认10)
+ */
+public final class JniBench {
+
+    //执行iterations次被测操作
+    interface Op {
+        void run(int iterations);
+    }
+
+    //native计时：执行rounds次，返回单次耗时ns
+    interface NativeTimed {
+        long nsPerOp(int rounds);
+    }
+
+    static final class Result {
+        final String name;
+        final long param;
+        final double[] samples;
+        double mean;
+        double median;
+        double p90;
+        double min;
+        double max;
+        double stddev;
+
+        Result(String name, long param, double[] samples) {
+            this.name = name;
+            this.param = param;
+            this.samples = samples;
+            computeStats();
+        }
+
+        private void computeStats() {
+            double[] sorted = samples.clone();
+            Arrays.sort(sorted);
+            int n = sorted.length;
+            double sum = 0;
+            for (double v : sorted) {
+                sum += v;
+            }
+            mean = sum / n;
+            median = n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+            p90 = sorted[Math.max(0, (int) Math.ceil(n * 0.9) - 1)];
+            min = sorted[0];
+            max = sorted[n - 1];
+            double squares = 0;
+            for (double v : sorted) {
+                squares += (v - mean) * (v - mean);
+            }
+            stddev = n > 1 ? Math.sqrt(squares / (n - 1)) : 0;
+        }
+
+        String key() {
+            return name + "@" + param;
+        }
+    }
+
+    static final class Options {
+        long warmupMs = 300;
+        int samples = 25;
+        long sampleMs = 20;
+        String filter;
+        String out;
+        String baseline;
+        double threshold = 10;
+
+        static Options parse(String[] args) {
+            Options o = new Options();
+            for (int i = 0; i < args.length; i++) {
+                String value = i + 1 < args.length ? args[i + 1] : null;
+                switch (args[i]) {
+                    case "--warmup-ms":
+                        o.warmupMs = Long.parseLong(value);
+                        break;
+                    case "--samples":
+                        o.samples = Math.max(1, Integer.parseInt(value));
+                        break;
+                    case "--sample-ms":
+                        o.sampleMs = Long.parseLong(value);
+                        break;
+                    case "--filter":
+                        o.filter = value;
+                        break;
+                    case "--out":
+                        o.out = value;
+                        break;
+                    case "--baseline":
+                        o.baseline = value;
+                        break;
+                    case "--threshold":
+                        o.threshold = Double.parseDouble(value);
+                        break;
+                    default:
+                        throw new IllegalArgumentException("未知参数: " + args[i]);
+                }
+                i++;
+            }
+            return o;
+        }
+    }
+
+    private static final int[] ARRAY_SIZES = {16, 256, 4096, 65536, 1 << 20};
+    private static final int[] STRING_COUNTS = {1, 16, 256, 4096};
+    private static final int[] DOG_COUNTS = {1000, 100000};
+    private static final int PARALLEL_SIZE = 1 << 22;
+
+    //防止JIT把被测代码当作无用代码消除
+    static volatile long sink;
+
+    private final Options options;
+    private final List<Result> results = new ArrayList<>();
+
+    private JniBench(Options options) {
+        this.options = options;
+    }
+
+    private boolean enabled(String name) {
+        return options.filter == null || name.contains(options.filter);
+    }
+
+    private void measure(String name, long param, Op op) {
+        if (!enabled(name)) {
+            return;
+        }
+        final long targetNs = options.sampleMs * 1_000_000L;
+        final long warmupEnd = System.nanoTime() + options.warmupMs * 1_000_000L;
+        int iterations = 1;
+        //预热的同时校准：迭代次数翻倍，直到一个样本接近sampleMs
+        while (true) {
+            long start = System.nanoTime();
+            op.run(iterations);
+            long elapsed = System.nanoTime() - start;
+            if (elapsed < targetNs && iterations < (1 << 30)) {
+                long scaled = elapsed > 0 ? iterations * targetNs / elapsed : iterations * 2L;
+                iterations = (int) Math.min(1 << 30, Math.max(iterations + 1L, Math.min(scaled, iterations * 2L)));
+            } else if (System.nanoTime() >= warmupEnd) {
+                break;
+            }
+        }
+        double[] samples = new double[options.samples];
+        for (int i = 0; i < samples.length; i++) {
+            long start = System.nanoTime();
+            op.run(iterations);
+            samples[i] = (double) (System.nanoTime() - start) / iterations;
+        }
+        record(new Result(name, param, samples));
+    }
+
+    private void measureNative(String name, int rounds, NativeTimed op) {
+        if (!enabled(name)) {
+            return;
+        }
+        final long warmupEnd = System.nanoTime() + options.warmupMs * 1_000_000L;
+        do {
+            if (op.nsPerOp(rounds) < 0) {
+                System.err.println(name + ": native返回失败，跳过");
+                return;
+            }
+        } while (System.nanoTime() < warmupEnd);
+        double[] samples = new double[options.samples];
+        for (int i = 0; i < samples.length; i++) {
+            samples[i] = op.nsPerOp(rounds);
+        }
+        record(new Result(name, rounds, samples));
+    }
+
+    private void record(Result result) {
+        results.add(result);
+        System.err.println(String.format(Locale.ROOT, "%-28s %9d  median %12.1f ns/op  p90 %12.1f  stddev %10.1f",
+                result.name, result.param, result.median, result.p90, result.stddev));
+    }
+
+    //只有一个样本的结果
+    private void recordOnce(String name, long param, long ns) {
+        if (enabled(name)) {
+            record(new Result(name, param, new double[]{ns}));
+        }
+    }
+
+    //===================================基准===================================
+    private void runAll() {
+        runStartup();
+        runCalls();
+        runFields();
+        runUpcalls();
+        runArrays();
+        runStrings();
+        runObjects();
+        runThreads();
+        runParallel();
+    }
+
+    //必须最先运行：此时so还没有被加载，native函数还没有被调用过
+    private void runStartup() {
+        long start = System.nanoTime();
+        System.loadLibrary("study_jni"); //JNI_OnLoad：ID缓存 + 注册所有native函数
+        long loadNs = System.nanoTime() - start;
+
+        MainActivity activity = new MainActivity(); //类初始化不计入首次调用
+        start = System.nanoTime();
+        sink += activity.stringFromJNI().length();
+        long firstCallNs = System.nanoTime() - start;
+        start = System.nanoTime();
+        sink += activity.stringFromJNI().length();
+        long secondCallNs = System.nanoTime() - start;
+
+        //[JNI_OnLoad总耗时ns, ID缓存ns, 注册ns, 注册的函数个数]
+        long[] stats = activity.nativeStartupStats();
+        recordOnce("startup.load_library", 0, loadNs);
+        recordOnce("startup.on_load", 0, stats[0]);
+        recordOnce("startup.id_cache", 0, stats[1]);
+        recordOnce("startup.register_natives", stats[3], stats[2]);
+        recordOnce("startup.first_call", 0, firstCallNs);
+        recordOnce("startup.second_call", 0, secondCallNs);
+    }
+
+    private void runCalls() {
+        final BenchNatives natives = new BenchNatives();
+        measure("call.empty_static", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                BenchNatives.emptyStatic();
+            }
+        });
+        measure("call.empty_instance", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                natives.emptyInstance();
+            }
+        });
+        measure("call.empty_registered", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                BenchNatives.emptyRegistered();
+            }
+        });
+        measure("call.add_ints_static", 0, n -> {
+            long acc = 0;
+            for (int i = 0; i < n; i++) {
+                acc += BenchNatives.addInts(i, 1);
+            }
+            sink = acc;
+        });
+        measure("call.add_ints_registered", 0, n -> {
+            long acc = 0;
+            for (int i = 0; i < n; i++) {
+                acc += BenchNatives.addIntsRegistered(i, 1);
+            }
+            sink = acc;
+        });
+    }
+
+    private void runFields() {
+        final Student student = new Student();
+        student.age = 12;
+        final MainActivity activity = new MainActivity();
+        measure("field.read_int", 0, n -> {
+            long acc = 0;
+            for (int i = 0; i < n; i++) {
+                acc += BenchNatives.readAge(student);
+            }
+            sink = acc;
+        });
+        measure("field.write_int", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                BenchNatives.writeAge(student, i);
+            }
+        });
+        measure("field.change_age_static", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                MainActivity.changeAge();
+            }
+        });
+        measure("field.change_num_final", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                activity.changeNum();
+            }
+        });
+        measure("field.change_name_string", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                activity.changeName();
+            }
+        });
+        //镜像：native修改rounds轮(每轮相当于上面三个change*)，再一次sync()只写回变化了的字段，param为轮数
+        final FieldMirror mirror = FieldMirror.create(FieldMirror.MAP_MAIN_ACTIVITY);
+        mirror.refresh(activity);
+        for (int rounds : new int[]{1, 100}) {
+            measure("field.mirror_step_sync", rounds, n -> {
+                long acc = 0;
+                for (int i = 0; i < n; i++) {
+                    mirror.step(rounds);
+                    acc += mirror.sync(activity);
+                }
+                sink = acc;
+            });
+        }
+        measure("field.mirror_refresh", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                mirror.refresh(activity);
+            }
+        });
+        mirror.close();
+    }
+
+    private void runUpcalls() {
+        final Student student = new Student();
+        student.age = 12;
+        student.name = "lee";
+        final MainActivity activity = new MainActivity();
+        measure("upcall.get_age", 0, n -> {
+            long acc = 0;
+            for (int i = 0; i < n; i++) {
+                acc += BenchNatives.upcallGetAge(student);
+            }
+            sink = acc;
+        });
+        measure("upcall.call_add_method", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                activity.callAddMethod();
+            }
+        });
+        measure("upcall.put_student", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                activity.putStudent(student, "game");
+            }
+        });
+    }
+
+    private void runArrays() {
+        for (int size : ARRAY_SIZES) {
+            final int[] ints = new int[size];
+            final float[] floats = new float[size];
+            for (int i = 0; i < size; i++) {
+                ints[i] = i;
+                floats[i] = i * 0.5f;
+            }
+            measure("array.sum_int", size, n -> {
+                long acc = 0;
+                for (int i = 0; i < n; i++) {
+                    acc += NativeArrays.sum(ints);
+                }
+                sink = acc;
+            });
+            measure("array.scale_float", size, n -> {
+                for (int i = 0; i < n; i++) {
+                    NativeArrays.scale(floats, 1.0f);
+                }
+            });
+        }
+    }
+
+    private void runStrings() {
+        for (int count : STRING_COUNTS) {
+            final String[] strings = new String[count];
+            for (int i = 0; i < count; i++) {
+                strings[i] = "学生_" + i + "_kobe";
+            }
+            final byte[] packed = NativeStrings.pack(strings);
+            measure("string.pack", count, n -> {
+                long acc = 0;
+                for (int i = 0; i < n; i++) {
+                    acc += NativeStrings.pack(strings).length;
+                }
+                sink = acc;
+            });
+            measure("string.unpack", count, n -> {
+                long acc = 0;
+                for (int i = 0; i < n; i++) {
+                    acc += NativeStrings.unpack(packed).length;
+                }
+                sink = acc;
+            });
+        }
+    }
+
+    private void runObjects() {
+        final MainActivity activity = new MainActivity();
+        measure("object.new_dog_java", 0, n -> {
+            long acc = 0;
+            for (int i = 0; i < n; i++) {
+                acc += new Dog().hashCode();
+            }
+            sink = acc;
+        });
+        measure("object.new_dog_native", 0, n -> {
+            long acc = 0;
+            for (int i = 0; i < n; i++) {
+                acc += BenchNatives.newDog().hashCode();
+            }
+            sink = acc;
+        });
+        //三个构造函数各调用一次
+        measure("object.test_quote", 0, n -> {
+            for (int i = 0; i < n; i++) {
+                activity.testQuote();
+            }
+        });
+        //一次创建count个Dog(int, int)，结果为每批的耗时
+        for (int count : DOG_COUNTS) {
+            final int[] args = new int[count * 2];
+            final ByteBuffer direct = DogFactory.allocateArgs(DogFactory.CTOR_INT_INT, count);
+            for (int i = 0; i < args.length; i++) {
+                args[i] = i;
+                direct.putInt(i);
+            }
+            direct.flip();
+            measure("object.dog_batch_java", count, n -> {
+                for (int i = 0; i < n; i++) {
+                    Dog[] dogs = new Dog[count];
+                    for (int j = 0; j < count; j++) {
+                        dogs[j] = new Dog(args[2 * j], args[2 * j + 1]);
+                    }
+                    sink = dogs.length;
+                }
+            });
+            measure("object.dog_batch_factory", count, n -> {
+                for (int i = 0; i < n; i++) {
+                    sink = DogFactory.create(DogFactory.CTOR_INT_INT, count, args).length;
+                }
+            });
+            measure("object.dog_batch_direct", count, n -> {
+                for (int i = 0; i < n; i++) {
+                    sink = DogFactory.create(DogFactory.CTOR_INT_INT, count, direct).length;
+                }
+            });
+        }
+        //Person ---> Student：逐字段上行调用(每个Person一次insertObject) vs 扁平编码一次传递，param为Person个数
+        for (int count : DOG_COUNTS) {
+            measure("object.graph_setters", count, n -> {
+                for (int i = 0; i < n; i++) {
+                    for (int j = 0; j < count; j++) {
+                        activity.insertObject();
+                    }
+                }
+            });
+            measure("object.graph_flat", count, n -> {
+                for (int i = 0; i < n; i++) {
+                    sink = GraphCodec.decode(GraphCodec.sample(count)).length;
+                }
+            });
+            final ByteBuffer encoded = GraphCodec.sample(count);
+            final Person[] persons = GraphCodec.decode(encoded.duplicate());
+            final ByteBuffer out = ByteBuffer.allocateDirect(encoded.remaining());
+            if (GraphCodec.echo(GraphCodec.encode(persons), out) != encoded.remaining()
+                    || !out.equals(encoded)) {
+                throw new AssertionError("GraphCodec: Java编码与native编码不一致, count = " + count);
+            }
+            measure("object.graph_flat_to_native", count, n -> {
+                for (int i = 0; i < n; i++) {
+                    sink = GraphCodec.summary(GraphCodec.encode(persons))[4];
+                }
+            });
+        }
+    }
+
+    private void runThreads() {
+        measureNative("thread.attach_detach", 100, rounds -> BenchNatives.attachNs(rounds, false));
+        measureNative("thread.attach_cached", 10000, rounds -> BenchNatives.attachNs(rounds, true));
+    }
+
+    /**
+     * 多核扩展性：同一个运算分别用1、2、4...个线程，param为线程数，输出相对1个线程的加速比
+     * 每个线程数的结果都先与1个线程的结果比较，不一致直接退出
+     */
+    private void runParallel() {
+        final int[] source = new int[PARALLEL_SIZE];
+        final float[] floats = new float[PARALLEL_SIZE];
+        long seed = 42;
+        for (int i = 0; i < PARALLEL_SIZE; i++) {
+            seed = seed * 6364136223846793005L + 1442695040888963407L;
+            source[i] = (int) (seed >>> 33);
+            floats[i] = (float) (seed >>> 40) / (1 << 20);
+        }
+        final int[] work = new int[PARALLEL_SIZE];
+        final long expectSum = ParallelArrays.reduce(source, ParallelArrays.REDUCE_SUM, 1);
+        final double expectFloat = ParallelArrays.reduce(floats, ParallelArrays.REDUCE_SUM, 1);
+        final long[] expectHistogram = ParallelArrays.histogram(source, 0, Integer.MAX_VALUE, 256, 1);
+        final int[] expectSorted = source.clone();
+        ParallelArrays.sort(expectSorted, 1);
+
+        List<Integer> threadCounts = new ArrayList<>();
+        for (int t = 1; t < ParallelArrays.concurrency(); t *= 2) {
+            threadCounts.add(t);
+        }
+        threadCounts.add(ParallelArrays.concurrency());
+
+        Map<String, Double> single = new HashMap<>();
+        for (int threads : threadCounts) {
+            System.arraycopy(source, 0, work, 0, PARALLEL_SIZE);
+            ParallelArrays.sort(work, threads);
+            if (ParallelArrays.reduce(source, ParallelArrays.REDUCE_SUM, threads) != expectSum
+                    || ParallelArrays.reduce(floats, ParallelArrays.REDUCE_SUM, threads) != expectFloat
+                    || !Arrays.equals(ParallelArrays.histogram(source, 0, Integer.MAX_VALUE, 256, threads),
+                    expectHistogram)
+                    || !Arrays.equals(work, expectSorted)) {
+                System.err.println("parallel: " + threads + "个线程的结果与串行不一致");
+                System.exit(2);
+            }
+
+            measure("parallel.reduce_int", threads, n -> {
+                long acc = 0;
+                for (int i = 0; i < n; i++) {
+                    acc += ParallelArrays.reduce(source, ParallelArrays.REDUCE_SUM, threads);
+                }
+                sink = acc;
+            });
+            measure("parallel.reduce_float", threads, n -> {
+                double acc = 0;
+                for (int i = 0; i < n; i++) {
+                    acc += ParallelArrays.reduce(floats, ParallelArrays.REDUCE_SUM, threads);
+                }
+                sink = (long) acc;
+            });
+            measure("parallel.map_int", threads, n -> {
+                for (int i = 0; i < n; i++) {
+                    ParallelArrays.map(work, ParallelArrays.MAP_MUL, 3, threads);
+                }
+            });
+            measure("parallel.histogram", threads, n -> {
+                for (int i = 0; i < n; i++) {
+                    sink = ParallelArrays.histogram(source, 0, Integer.MAX_VALUE, 256, threads)[0];
+                }
+            });
+            //每次都从未排序的数据开始，包含一次arraycopy
+            measure("parallel.sort_int", threads, n -> {
+                for (int i = 0; i < n; i++) {
+                    System.arraycopy(source, 0, work, 0, PARALLEL_SIZE);
+                    ParallelArrays.sort(work, threads);
+                }
+            });
+            for (Result r : results) {
+                if (r.name.startsWith("parallel.") && r.param == threads) {
+                    if (threads == 1) {
+                        single.put(r.name, r.median);
+                    } else if (single.containsKey(r.name)) {
+                        System.err.println(String.format(Locale.ROOT, "%-28s %9d  speedup %.2fx",
+                                r.name, threads, single.get(r.name) / r.median));
+                    }
+                }
+            }
+        }
+    }
+
+    //===================================输出===================================
+    private static String quote(String s) {
+        StringBuilder sb = new StringBuilder("\"");
+        for (char c : s.toCharArray()) {
+            if (c == '"' || c == '\\') {
+                sb.append('\\').append(c);
+            } else if (c < 0x20) {
+                sb.append(String.format(Locale.ROOT, "\\u%04x", (int) c));
+            } else {
+                sb.append(c);
+            }
+        }
+        return sb.append('"').toString();
+    }
+
+    private String toJson() {
+        StringBuilder sb = new StringBuilder();
+        sb.append("{\"suite\":\"study_jni\",\"schema\":1")
+                .append(",\"timestamp\":").append(System.currentTimeMillis())
+                .append(",\"java\":").append(quote(System.getProperty("java.vm.name") + " "
+                        + System.getProperty("java.version")))
+                .append(",\"os\":").append(quote(System.getProperty("os.name") + " "
+                        + System.getProperty("os.arch")))
+                .append(",\"cpus\":").append(Runtime.getRuntime().availableProcessors())
+                .append(",\"warmup_ms\":").append(options.warmupMs)
+                .append(",\"sample_ms\":").append(options.sampleMs)
+                .append(",\"results\":[\n");
+        for (int i = 0; i < results.size(); i++) {
+            Result r = results.get(i);
+            sb.append(String.format(Locale.ROOT,
+                    "{\"name\":%s,\"param\":%d,\"unit\":\"ns/op\",\"samples\":%d,\"mean\":%.2f,"
+                            + "\"median\":%.2f,\"p90\":%.2f,\"min\":%.2f,\"max\":%.2f,\"stddev\":%.2f}",
+                    quote(r.name), r.param, r.samples.length, r.mean, r.median, r.p90, r.min, r.max, r.stddev));
+            sb.append(i + 1 < results.size() ? ",\n" : "\n");
+        }
+        sb.append("]}\n");
+        return sb.toString();
+    }
+
+    private static final Pattern BASELINE_LINE = Pattern.compile(
+            "\"name\":\"([^\"]+)\",\"param\":(-?\\d+),.*\"median\":([0-9.eE+-]+)");
+
+    //读取之前的结果文件：name@param ---> median
+    private static Map<String, Double> readBaseline(String path) throws IOException {
+        Map<String, Double> medians = new HashMap<>();
+        try (BufferedReader reader = new BufferedReader(
+                new InputStreamReader(new FileInputStream(path), StandardCharsets.UTF_8))) {
+            String line;
+            while ((line = reader.readLine()) != null) {
+                Matcher m = BASELINE_LINE.matcher(line);
+                if (m.find()) {
+                    medians.put(m.group(1) + "@" + m.group(2), Double.parseDouble(m.group(3)));
+                }
+            }
+        }
+        return medians;
+    }
+
+    //返回变慢超过阈值的基准个数
+    private int compare(Map<String, Double> baseline, PrintStream out) {
+        int regressions = 0;
+        for (Result r : results) {
+            Double old = baseline.get(r.key());
+            if (old == null || old <= 0) {
+                continue;
+            }
+            double change = (r.median - old) / old * 100;
+            boolean regressed = change > options.threshold;
+            if (regressed) {
+                regressions++;
+            }
+            out.println(String.format(Locale.ROOT, "%s %-28s %9d  %12.1f -> %12.1f ns/op  %+7.1f%%",
+                    regressed ? "REGRESSION" : "ok        ", r.name, r.param, old, r.median, change));
+        }
+        return regressions;
+    }
+
+    public static void main(String[] args) throws IOException {
+        Options options = Options.parse(args);
+        JniBench bench = new JniBench(options);
+        bench.runAll();
+
+        String json = bench.toJson();
+        if (options.out != null) {
+            try (Writer writer = new OutputStreamWriter(new FileOutputStream(options.out), StandardCharsets.UTF_8)) {
+                writer.write(json);
+            }
+        } else {
+            System.out.print(json);
+        }
+
+        if (options.baseline != null) {
+            int regressions = bench.compare(readBaseline(options.baseline), System.err);
+            if (regressions > 0) {
+                System.err.println(regressions + "个基准变慢超过" + options.threshold + "%");
+                System.exit(1);
+            }
+        }
+    }
+}
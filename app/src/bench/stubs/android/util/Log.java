@@ -0,0 +1,26 @@
+package android.util;
+
+/**
+ * 桌面JVM上代替android.util.Log：什么都不输出，避免日志开销混进基准结果
+ */
+public final class Log {
+
+    private Log() {
+    }
+
+    public static int d(String tag, String msg) {
+        return 0;
+    }
+
+    public static int i(String tag, String msg) {
+        return 0;
+    }
+
+    public static int w(String tag, String msg) {
+        return 0;
+    }
+
+    public static int e(String tag, String msg) {
+        return 0;
+    }
+}
@@ -0,0 +1,26 @@
+package android.view;
+
+/**
+ * 桌面JVM上代替android.view.Choreographer，只用于让NativeEventDispatcher通过编译，没有帧回调
+ */
+public final class Choreographer {
+
+    public interface FrameCallback {
+        void doFrame(long frameTimeNanos);
+    }
+
+    private static final Choreographer INSTANCE = new Choreographer();
+
+    private Choreographer() {
+    }
+
+    public static Choreographer getInstance() {
+        return INSTANCE;
+    }
+
+    public void postFrameCallback(FrameCallback callback) {
+    }
+
+    public void removeFrameCallback(FrameCallback callback) {
+    }
+}
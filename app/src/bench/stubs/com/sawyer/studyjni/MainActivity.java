@@ -0,0 +1,57 @@
+package com.sawyer.studyjni;
+
+/**
+ * 桌面JVM上代替MainActivity(真正的MainActivity继承AppCompatActivity，无法在桌面JVM上加载)
+ *
+ * JNI_OnLoad会查找MainActivity的属性、方法并注册native函数(少一个都会导致加载失败)，所以这里必须与
+ * app/src/main/java/com/sawyer/studyjni/MainActivity.java 保持一致：
+ *      被C++访问的属性、方法：name、age、num、add()、showString()、updateActivityUI()
+ *      所有native函数
+ */
+public class MainActivity {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    private String name = "lee";
+    public static int age = 12;
+    public final double num = 1.234;
+
+    //updateActivityUI()被调用的次数
+    public int updateCount;
+
+    private int add(int num1, int num2) {
+        return num1 + num2;
+    }
+
+    private String showString(String str, int value) {
+        return str + "_" + value;
+    }
+
+    public void updateActivityUI() {
+        updateCount++;
+    }
+
+    public native String stringFromJNI();
+    public native void changeName();
+    public static native void changeAge();
+    public native void changeNum();
+    public native void callAddMethod();
+    public native void testArrayAction(int[] intArray, String[] strArray);
+    public native void putStudent(Student student, String str);
+    public native void insertObject();
+    public native void testQuote();
+    public native void deleteQuote();
+    public native void dynamicJavaMethod01();
+    public native int dynamicJavaMethod02(String str);
+    public native void nativeThread();
+    public native void closeThread();
+    public native void nativeFun1();
+    public native void nativeFun2();
+    public static native void staticFun3();
+    public static native void staticFun4();
+    public native long[] benchIdCache(Student student, int rounds);
+    public native long[] benchTypedCall(Student student, int rounds);
+    public native long[] nativeStartupStats();
+}
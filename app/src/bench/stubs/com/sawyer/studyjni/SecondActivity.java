@@ -0,0 +1,13 @@
+package com.sawyer.studyjni;
+
+/**
+ * 桌面JVM上代替SecondActivity：只保留native函数的声明
+ */
+public class SecondActivity {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    public native void nativeFun5();
+}
@@ -0,0 +1,143 @@
+#ifndef STUDYJNI_ARRAY_BRIDGE_H
+#define STUDYJNI_ARRAY_BRIDGE_H
+
+#include <jni.h>
+#include <cstddef>
+#include "jni-stats.h"
+
+/**
+ * 基本类型数组桥接：
+ *      一次性拿到整个Java数组的数据，而不是在循环里反复 Get<Type>ArrayElements / Release<Type>ArrayElements
+ *
+ * 两种访问方式，按数组大小自动选择：
+ *  (1)小数组：Get<Type>ArrayRegion 拷贝到栈上的缓冲区，可写时析构再 Set<Type>ArrayRegion 写回
+ *      拷贝很小的数组，比锁定(pin)数组更便宜，并且期间可以随意调用JNI函数
+ *  (2)大数组：GetPrimitiveArrayCritical 直接拿到Java堆上的地址，一般不需要拷贝
+ *      注意：Critical期间可能会暂停GC，所以这段时间内
+ *          1.不能调用任何JNI函数(包括GetArrayLength、NewXXX、CallXXX)
+ *          2.不能阻塞，要尽快释放
+ *      所以数组长度要在获取之前拿到，返回给Java的新数组要在释放之后再创建
+ *
+ * 释放模式：
+ *      ReadOnly:  JNI_ABORT，只释放，不把数据拷贝回Java(数据本来就没改)
+ *      ReadWrite: 0，拷贝回Java并释放
+ */
+enum class ArrayAccess {
+    ReadOnly,
+    ReadWrite
+};
+
+//jint -> jintArray、Get/SetIntArrayRegion 的对应关系
+template<typename T>
+struct JniArrayTraits;
+
+#define STUDYJNI_ARRAY_TRAITS(T, Name)                                                      \
+template<>                                                                                  \
+struct JniArrayTraits<T> {                                                                  \
+    using ArrayType = T##Array;                                                             \
+    static ArrayType newArray(JNIEnv *env, jsize len) { return env->New##Name##Array(len); } \
+    static void getRegion(JNIEnv *env, ArrayType array, jsize start, jsize len, T *buf) {   \
+        env->Get##Name##ArrayRegion(array, start, len, buf);                                \
+    }                                                                                       \
+    static void setRegion(JNIEnv *env, ArrayType array, jsize start, jsize len, const T *buf) { \
+        env->Set##Name##ArrayRegion(array, start, len, buf);                                \
+    }                                                                                       \
+};
+
+STUDYJNI_ARRAY_TRAITS(jboolean, Boolean)
+STUDYJNI_ARRAY_TRAITS(jbyte, Byte)
+STUDYJNI_ARRAY_TRAITS(jchar, Char)
+STUDYJNI_ARRAY_TRAITS(jshort, Short)
+STUDYJNI_ARRAY_TRAITS(jint, Int)
+STUDYJNI_ARRAY_TRAITS(jlong, Long)
+STUDYJNI_ARRAY_TRAITS(jfloat, Float)
+STUDYJNI_ARRAY_TRAITS(jdouble, Double)
+
+#undef STUDYJNI_ARRAY_TRAITS
+
+//不超过这个字节数的数组，走Region拷贝
+constexpr size_t kArrayInlineBytes = 256;
+
+template<typename T>
+class PrimitiveArray {
+public:
+    using ArrayType = typename JniArrayTraits<T>::ArrayType;
+
+    static constexpr jsize kInlineCount = kArrayInlineBytes / sizeof(T);
+
+    PrimitiveArray(JNIEnv *env, ArrayType array, ArrayAccess access)
+            : PrimitiveArray(env, array, access, array ? env->GetArrayLength(array) : 0) {}
+
+    /**
+     * @length: 调用者已经拿到的数组长度。
+     *      同时打开多个大数组时(e.g: dot(a, b))，必须先把所有长度拿到再构造，
+     *      否则第二次GetArrayLength会落在第一个数组的Critical区间内
+     */
+    PrimitiveArray(JNIEnv *env, ArrayType array, ArrayAccess access, jsize length)
+            : mEnv(env), mArray(array), mAccess(access), mSize(array ? length : 0) {
+        if (!mArray) {
+            return;
+        }
+        if (mSize <= kInlineCount) {
+            JniArrayTraits<T>::getRegion(mEnv, mArray, 0, mSize, mInline);
+            mData = mInline;
+        } else {
+            mData = static_cast<T *>(mEnv->GetPrimitiveArrayCritical(mArray, nullptr));
+            mCritical = true;
+        }
+        jni_stats_add_bytes((size_t) mSize * sizeof(T));
+    }
+
+    ~PrimitiveArray() {
+        release();
+    }
+
+    PrimitiveArray(const PrimitiveArray &) = delete;
+    PrimitiveArray &operator=(const PrimitiveArray &) = delete;
+
+    //提前释放，之后data()为nullptr。可写模式下会把数据写回Java
+    void release() {
+        if (!mData) {
+            return;
+        }
+        if (mCritical) {
+            mEnv->ReleasePrimitiveArrayCritical(mArray, mData,
+                                                mAccess == ArrayAccess::ReadOnly ? JNI_ABORT : 0);
+        } else if (mAccess == ArrayAccess::ReadWrite) {
+            JniArrayTraits<T>::setRegion(mEnv, mArray, 0, mSize, mInline);
+            jni_stats_add_bytes((size_t) mSize * sizeof(T));
+        }
+        mData = nullptr;
+        mCritical = false;
+    }
+
+    //数组为null或者获取失败时返回nullptr
+    T *data() const { return mData; }
+
+    jsize size() const { return mSize; }
+
+    bool isCritical() const { return mCritical; }
+
+private:
+    JNIEnv *mEnv;
+    ArrayType mArray;
+    ArrayAccess mAccess;
+    jsize mSize;
+    T *mData = nullptr;
+    bool mCritical = false;
+    T mInline[kInlineCount];
+};
+
+//创建一个新的Java数组，并把data中的数据一次性拷贝进去
+template<typename T>
+static inline typename JniArrayTraits<T>::ArrayType
+new_java_array(JNIEnv *env, const T *data, jsize len) {
+    auto array = JniArrayTraits<T>::newArray(env, len);
+    if (array && len > 0) {
+        JniArrayTraits<T>::setRegion(env, array, 0, len, data);
+        jni_stats_add_bytes((size_t) len * sizeof(T));
+    }
+    return array;
+}
+
+#endif //STUDYJNI_ARRAY_BRIDGE_H
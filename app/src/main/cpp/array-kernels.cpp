@@ -0,0 +1,324 @@
+#include "array-kernels.h"
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define STUDYJNI_NEON 1
+#endif
+
+//整数按无符号运算，溢出时回绕，与Java的int/long运算结果一致
+static inline jlong acc_add(jlong a, jlong b) { return (jlong) ((uint64_t) a + (uint64_t) b); }
+static inline jdouble acc_add(jdouble a, jdouble b) { return a + b; }
+static inline jlong acc_mul(jlong a, jlong b) { return (jlong) ((uint64_t) a * (uint64_t) b); }
+static inline jdouble acc_mul(jdouble a, jdouble b) { return a * b; }
+
+template<typename T>
+static inline T wrap_add(T a, T b) {
+    if constexpr (std::is_integral<T>::value) {
+        using U = typename std::make_unsigned<T>::type;
+        return (T) (U) ((U) a + (U) b);
+    } else {
+        return a + b;
+    }
+}
+
+template<typename T>
+static inline T wrap_mul(T a, T b) {
+    if constexpr (std::is_integral<T>::value) {
+        using U = typename std::make_unsigned<T>::type;
+        return (T) (U) ((U) a * (U) b);
+    } else {
+        return a * b;
+    }
+}
+
+//========================通用实现：4个累加器，打断依赖链，便于自动向量化========================
+
+template<typename Acc, typename T>
+static Acc sum_generic(const T *data, size_t n) {
+    Acc s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 = acc_add(s0, (Acc) data[i]);
+        s1 = acc_add(s1, (Acc) data[i + 1]);
+        s2 = acc_add(s2, (Acc) data[i + 2]);
+        s3 = acc_add(s3, (Acc) data[i + 3]);
+    }
+    for (; i < n; ++i) {
+        s0 = acc_add(s0, (Acc) data[i]);
+    }
+    return acc_add(acc_add(s0, s1), acc_add(s2, s3));
+}
+
+template<typename T>
+static void min_max_generic(const T *data, size_t n, T *outMin, T *outMax) {
+    T lo = data[0];
+    T hi = data[0];
+    for (size_t i = 1; i < n; ++i) {
+        T v = data[i];
+        lo = v < lo ? v : lo;
+        hi = v > hi ? v : hi;
+    }
+    *outMin = lo;
+    *outMax = hi;
+}
+
+template<typename T>
+static void scale_generic(T *data, size_t n, T factor) {
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = wrap_mul(data[i], factor);
+    }
+}
+
+template<typename T>
+static void add_generic(T *data, size_t n, T addend) {
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = wrap_add(data[i], addend);
+    }
+}
+
+//前缀和每一项都依赖前一项，无法简单向量化，保持串行
+template<typename T>
+static void prefix_sum_generic(T *data, size_t n) {
+    T running = 0;
+    for (size_t i = 0; i < n; ++i) {
+        running = wrap_add(running, data[i]);
+        data[i] = running;
+    }
+}
+
+template<typename Acc, typename T>
+static Acc dot_generic(const T *a, const T *b, size_t n) {
+    Acc s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 = acc_add(s0, acc_mul((Acc) a[i], (Acc) b[i]));
+        s1 = acc_add(s1, acc_mul((Acc) a[i + 1], (Acc) b[i + 1]));
+        s2 = acc_add(s2, acc_mul((Acc) a[i + 2], (Acc) b[i + 2]));
+        s3 = acc_add(s3, acc_mul((Acc) a[i + 3], (Acc) b[i + 3]));
+    }
+    for (; i < n; ++i) {
+        s0 = acc_add(s0, acc_mul((Acc) a[i], (Acc) b[i]));
+    }
+    return acc_add(acc_add(s0, s1), acc_add(s2, s3));
+}
+
+//========================sum========================
+
+jlong kernel_sum(const jbyte *data, size_t n) {
+    return sum_generic<jlong>(data, n);
+}
+
+jlong kernel_sum(const jint *data, size_t n) {
+#ifdef STUDYJNI_NEON
+    //vpadalq_s32: 相邻两个int32相加后累加到int64，不会溢出
+    int64x2_t acc0 = vdupq_n_s64(0);
+    int64x2_t acc1 = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vpadalq_s32(acc0, vld1q_s32(data + i));
+        acc1 = vpadalq_s32(acc1, vld1q_s32(data + i + 4));
+    }
+    jlong sum = vaddvq_s64(vaddq_s64(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += data[i];
+    }
+    return sum;
+#else
+    return sum_generic<jlong>(data, n);
+#endif
+}
+
+jlong kernel_sum(const jlong *data, size_t n) {
+    return sum_generic<jlong>(data, n);
+}
+
+jdouble kernel_sum(const jfloat *data, size_t n) {
+#ifdef STUDYJNI_NEON
+    float64x2_t acc0 = vdupq_n_f64(0);
+    float64x2_t acc1 = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(data + i);
+        acc0 = vaddq_f64(acc0, vcvt_f64_f32(vget_low_f32(v)));
+        acc1 = vaddq_f64(acc1, vcvt_high_f64_f32(v));
+    }
+    jdouble sum = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += data[i];
+    }
+    return sum;
+#else
+    return sum_generic<jdouble>(data, n);
+#endif
+}
+
+jdouble kernel_sum(const jdouble *data, size_t n) {
+    return sum_generic<jdouble>(data, n);
+}
+
+//========================minMax========================
+
+void kernel_min_max(const jbyte *data, size_t n, jbyte *outMin, jbyte *outMax) {
+    min_max_generic(data, n, outMin, outMax);
+}
+
+void kernel_min_max(const jint *data, size_t n, jint *outMin, jint *outMax) {
+#ifdef STUDYJNI_NEON
+    int32x4_t lo = vdupq_n_s32(data[0]);
+    int32x4_t hi = lo;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t v = vld1q_s32(data + i);
+        lo = vminq_s32(lo, v);
+        hi = vmaxq_s32(hi, v);
+    }
+    jint mn = vminvq_s32(lo);
+    jint mx = vmaxvq_s32(hi);
+    for (; i < n; ++i) {
+        mn = data[i] < mn ? data[i] : mn;
+        mx = data[i] > mx ? data[i] : mx;
+    }
+    *outMin = mn;
+    *outMax = mx;
+#else
+    min_max_generic(data, n, outMin, outMax);
+#endif
+}
+
+void kernel_min_max(const jlong *data, size_t n, jlong *outMin, jlong *outMax) {
+    min_max_generic(data, n, outMin, outMax);
+}
+
+//浮点不走NEON：vminq_f32遇到NaN的行为与标量比较不同，保持各平台结果一致
+void kernel_min_max(const jfloat *data, size_t n, jfloat *outMin, jfloat *outMax) {
+    min_max_generic(data, n, outMin, outMax);
+}
+
+void kernel_min_max(const jdouble *data, size_t n, jdouble *outMin, jdouble *outMax) {
+    min_max_generic(data, n, outMin, outMax);
+}
+
+//========================scale========================
+
+void kernel_scale(jbyte *data, size_t n, jbyte factor) {
+    scale_generic(data, n, factor);
+}
+
+void kernel_scale(jint *data, size_t n, jint factor) {
+    scale_generic(data, n, factor);
+}
+
+void kernel_scale(jlong *data, size_t n, jlong factor) {
+    scale_generic(data, n, factor);
+}
+
+void kernel_scale(jfloat *data, size_t n, jfloat factor) {
+    scale_generic(data, n, factor);
+}
+
+void kernel_scale(jdouble *data, size_t n, jdouble factor) {
+    scale_generic(data, n, factor);
+}
+
+//========================add========================
+
+void kernel_add(jbyte *data, size_t n, jbyte addend) {
+    add_generic(data, n, addend);
+}
+
+void kernel_add(jint *data, size_t n, jint addend) {
+    add_generic(data, n, addend);
+}
+
+void kernel_add(jlong *data, size_t n, jlong addend) {
+    add_generic(data, n, addend);
+}
+
+void kernel_add(jfloat *data, size_t n, jfloat addend) {
+    add_generic(data, n, addend);
+}
+
+void kernel_add(jdouble *data, size_t n, jdouble addend) {
+    add_generic(data, n, addend);
+}
+
+//========================prefixSum========================
+
+void kernel_prefix_sum(jbyte *data, size_t n) {
+    prefix_sum_generic(data, n);
+}
+
+void kernel_prefix_sum(jint *data, size_t n) {
+    prefix_sum_generic(data, n);
+}
+
+void kernel_prefix_sum(jlong *data, size_t n) {
+    prefix_sum_generic(data, n);
+}
+
+void kernel_prefix_sum(jfloat *data, size_t n) {
+    prefix_sum_generic(data, n);
+}
+
+void kernel_prefix_sum(jdouble *data, size_t n) {
+    prefix_sum_generic(data, n);
+}
+
+//========================dot========================
+
+jlong kernel_dot(const jbyte *a, const jbyte *b, size_t n) {
+    return dot_generic<jlong>(a, b, n);
+}
+
+jlong kernel_dot(const jint *a, const jint *b, size_t n) {
+#ifdef STUDYJNI_NEON
+    //vmlal_s32: int32 * int32 -> int64 再累加
+    int64x2_t acc0 = vdupq_n_s64(0);
+    int64x2_t acc1 = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t va = vld1q_s32(a + i);
+        int32x4_t vb = vld1q_s32(b + i);
+        acc0 = vmlal_s32(acc0, vget_low_s32(va), vget_low_s32(vb));
+        acc1 = vmlal_high_s32(acc1, va, vb);
+    }
+    jlong sum = acc_add(vaddvq_s64(acc0), vaddvq_s64(acc1));
+    for (; i < n; ++i) {
+        sum = acc_add(sum, (jlong) a[i] * b[i]);
+    }
+    return sum;
+#else
+    return dot_generic<jlong>(a, b, n);
+#endif
+}
+
+jlong kernel_dot(const jlong *a, const jlong *b, size_t n) {
+    return dot_generic<jlong>(a, b, n);
+}
+
+jdouble kernel_dot(const jfloat *a, const jfloat *b, size_t n) {
+#ifdef STUDYJNI_NEON
+    float64x2_t acc0 = vdupq_n_f64(0);
+    float64x2_t acc1 = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t va = vld1q_f32(a + i);
+        float32x4_t vb = vld1q_f32(b + i);
+        acc0 = vfmaq_f64(acc0, vcvt_f64_f32(vget_low_f32(va)), vcvt_f64_f32(vget_low_f32(vb)));
+        acc1 = vfmaq_f64(acc1, vcvt_high_f64_f32(va), vcvt_high_f64_f32(vb));
+    }
+    jdouble sum = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += (jdouble) a[i] * b[i];
+    }
+    return sum;
+#else
+    return dot_generic<jdouble>(a, b, n);
+#endif
+}
+
+jdouble kernel_dot(const jdouble *a, const jdouble *b, size_t n) {
+    return dot_generic<jdouble>(a, b, n);
+}
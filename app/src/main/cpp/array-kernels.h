@@ -0,0 +1,58 @@
+#ifndef STUDYJNI_ARRAY_KERNELS_H
+#define STUDYJNI_ARRAY_KERNELS_H
+
+#include <jni.h>
+#include <cstddef>
+
+/**
+ * 基本类型数组的运算内核，只操作C++内存，不涉及任何JNI调用，可以放在Critical区间内执行
+ *
+ * 向量化：
+ *      arm64下sum/minMax/dot对int、float使用NEON指令；
+ *      其它情况使用多累加器的循环，方便编译器自动向量化
+ *
+ * 整数运算与Java保持一致：溢出时回绕，不是未定义行为
+ * 浮点求和、点积用double累加，减少大数组的精度损失
+ */
+
+jlong kernel_sum(const jbyte *data, size_t n);
+jlong kernel_sum(const jint *data, size_t n);
+jlong kernel_sum(const jlong *data, size_t n);
+jdouble kernel_sum(const jfloat *data, size_t n);
+jdouble kernel_sum(const jdouble *data, size_t n);
+
+//n必须大于0
+void kernel_min_max(const jbyte *data, size_t n, jbyte *outMin, jbyte *outMax);
+void kernel_min_max(const jint *data, size_t n, jint *outMin, jint *outMax);
+void kernel_min_max(const jlong *data, size_t n, jlong *outMin, jlong *outMax);
+void kernel_min_max(const jfloat *data, size_t n, jfloat *outMin, jfloat *outMax);
+void kernel_min_max(const jdouble *data, size_t n, jdouble *outMin, jdouble *outMax);
+
+//原地：data[i] *= factor
+void kernel_scale(jbyte *data, size_t n, jbyte factor);
+void kernel_scale(jint *data, size_t n, jint factor);
+void kernel_scale(jlong *data, size_t n, jlong factor);
+void kernel_scale(jfloat *data, size_t n, jfloat factor);
+void kernel_scale(jdouble *data, size_t n, jdouble factor);
+
+//原地：data[i] += addend
+void kernel_add(jbyte *data, size_t n, jbyte addend);
+void kernel_add(jint *data, size_t n, jint addend);
+void kernel_add(jlong *data, size_t n, jlong addend);
+void kernel_add(jfloat *data, size_t n, jfloat addend);
+void kernel_add(jdouble *data, size_t n, jdouble addend);
+
+//原地包含式前缀和：data[i] = data[0] + ... + data[i]
+void kernel_prefix_sum(jbyte *data, size_t n);
+void kernel_prefix_sum(jint *data, size_t n);
+void kernel_prefix_sum(jlong *data, size_t n);
+void kernel_prefix_sum(jfloat *data, size_t n);
+void kernel_prefix_sum(jdouble *data, size_t n);
+
+jlong kernel_dot(const jbyte *a, const jbyte *b, size_t n);
+jlong kernel_dot(const jint *a, const jint *b, size_t n);
+jlong kernel_dot(const jlong *a, const jlong *b, size_t n);
+jdouble kernel_dot(const jfloat *a, const jfloat *b, size_t n);
+jdouble kernel_dot(const jdouble *a, const jdouble *b, size_t n);
+
+#endif //STUDYJNI_ARRAY_KERNELS_H
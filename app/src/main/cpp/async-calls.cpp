@@ -0,0 +1,191 @@
+#include "async-calls.h"
+#include "array-bridge.h"
+#include "jni-cache.h"
+#include "jni-log.h"
+#include "worker-pool.h"
+#include <ctime>
+
+//Sum任务每算这么多个数检查一次取消
+static constexpr jlong kAsyncSumSlice = 1 << 16;
+
+AsyncCalls &AsyncCalls::instance() {
+    static AsyncCalls calls;
+    return calls;
+}
+
+jlong AsyncCalls::submit(Job job) {
+    if (!job || !jni_cache_ready()) {
+        return 0;
+    }
+    auto call = std::make_shared<Call>();
+    call->job = std::move(job);
+    const jlong handle = mNextHandle.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCalls.emplace(handle, call);
+    }
+    bool submitted = WorkerPool::instance().submit([this, handle, call](JNIEnv *env) {
+        run(env, handle, call);
+    });
+    if (!submitted) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCalls.erase(handle);
+        LOGE("AsyncCalls: 提交任务失败")
+        return 0;
+    }
+    mSubmitted.fetch_add(1, std::memory_order_relaxed);
+    return handle;
+}
+
+bool AsyncCalls::cancel(jlong handle) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mCalls.find(handle);
+    if (it == mCalls.end()) {
+        return false;
+    }
+    it->second->cancelRequested.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void AsyncCalls::release(jlong handle) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mCalls.find(handle);
+    if (it != mCalls.end()) {
+        //任务本身还被线程池中的lambda持有，看到取消标记后很快结束，结束时发现句柄已不在mCalls中，不会通知Java
+        it->second->cancelRequested.store(true, std::memory_order_relaxed);
+        mCalls.erase(it);
+    }
+}
+
+size_t AsyncCalls::releaseAll() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t count = mCalls.size();
+    for (auto &entry : mCalls) {
+        entry.second->cancelRequested.store(true, std::memory_order_relaxed);
+    }
+    mCalls.clear();
+    mCompleted.clear(); //已经完成但还没通知的，也不再通知
+    return count;
+}
+
+AsyncStats AsyncCalls::stats() const {
+    AsyncStats s;
+    s.submitted = mSubmitted.load(std::memory_order_relaxed);
+    s.completed = mFinished.load(std::memory_order_relaxed);
+    s.cancelled = mCancelled.load(std::memory_order_relaxed);
+    s.batches = mBatches.load(std::memory_order_relaxed);
+    return s;
+}
+
+void AsyncCalls::run(JNIEnv *env, jlong handle, const std::shared_ptr<Call> &call) {
+    AsyncStatus status = AsyncStatus::Cancelled;
+    jlong result = 0;
+    //还没开始就被取消的任务不执行
+    if (!call->cancelRequested.load(std::memory_order_relaxed)) {
+        status = call->job(env, AsyncToken(call->cancelRequested), result);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            status = AsyncStatus::Failed;
+        }
+    }
+    call->job = nullptr; //任务捕获的资源(e.g: 全局引用)尽早释放
+    complete(env, handle, status, result);
+}
+
+void AsyncCalls::complete(JNIEnv *env, jlong handle, AsyncStatus status, jlong result) {
+    mFinished.fetch_add(1, std::memory_order_relaxed);
+    if (status == AsyncStatus::Cancelled) {
+        mCancelled.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mCalls.erase(handle) == 0) {
+            return; //已经release()
+        }
+        mCompleted.push_back(handle);
+        mCompleted.push_back((jlong) status);
+        mCompleted.push_back(result);
+    }
+    //已经有flush在排队时，这次完成会被它一起带走
+    if (mFlushPending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    bool submitted = WorkerPool::instance().submit([this](JNIEnv *flushEnv) {
+        flush(flushEnv);
+    });
+    if (!submitted) {
+        flush(env); //队列满了，在当前工作线程中直接通知
+    }
+}
+
+void AsyncCalls::flush(JNIEnv *env) {
+    //先清标记再取数据：取完之后完成的任务会再提交一次flush，不会漏掉
+    mFlushPending.store(false, std::memory_order_release);
+    std::vector<jlong> batch;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        batch.swap(mCompleted);
+    }
+    if (batch.empty() || !jni_cache_ready()) {
+        return;
+    }
+    jlongArray array = new_java_array(env, batch.data(), (jsize) batch.size());
+    if (!array) {
+        env->ExceptionClear();
+        LOGE("AsyncCalls: 创建long[]失败，丢弃%zu个完成通知", batch.size() / 3)
+        return;
+    }
+    //一批完成通知只有这一次JNI调用
+    const JniCache &cache = jni_cache();
+    cache.nativeAsyncOnCompletedMid(env, cache.nativeAsyncClass, array);
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+    env->DeleteLocalRef(array); //工作线程不会返回Java，局部引用要自己释放
+    mBatches.fetch_add(1, std::memory_order_relaxed);
+}
+
+//==================================内置任务==================================
+static AsyncStatus sum_job(const AsyncToken &token, jlong count, jlong &result) {
+    uint64_t sum = 0; //无符号：溢出时回绕，不是未定义行为
+    for (jlong begin = 0; begin < count; begin += kAsyncSumSlice) {
+        if (token.cancelled()) {
+            return AsyncStatus::Cancelled;
+        }
+        jlong end = count - begin > kAsyncSumSlice ? begin + kAsyncSumSlice : count;
+        for (jlong i = begin; i < end; ++i) {
+            sum += (uint64_t) i;
+        }
+    }
+    result = (jlong) sum;
+    return AsyncStatus::Done;
+}
+
+static AsyncStatus sleep_job(const AsyncToken &token, jlong ms, jlong &result) {
+    const timespec slice{0, 1000000L};
+    for (jlong i = 0; i < ms; ++i) {
+        if (token.cancelled()) {
+            result = i; //已经睡了多少毫秒
+            return AsyncStatus::Cancelled;
+        }
+        nanosleep(&slice, nullptr);
+    }
+    result = ms;
+    return AsyncStatus::Done;
+}
+
+AsyncCalls::Job async_builtin_job(AsyncKind kind, jlong arg) {
+    switch (kind) {
+        case AsyncKind::Sum:
+            return [arg](JNIEnv *, const AsyncToken &token, jlong &result) {
+                return sum_job(token, arg, result);
+            };
+        case AsyncKind::Sleep:
+            return [arg](JNIEnv *, const AsyncToken &token, jlong &result) {
+                return sleep_job(token, arg, result);
+            };
+    }
+    return nullptr;
+}
@@ -0,0 +1,117 @@
+#ifndef STUDYJNI_ASYNC_CALLS_H
+#define STUDYJNI_ASYNC_CALLS_H
+
+#include <jni.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 异步native调用：Java提交任务后立即拿到句柄(handle)，任务在WorkerPool中执行，完成后批量回调Java
+ *
+ * 以前：所有native函数都在调用者线程同步执行，耗时的工作会卡住UI线程
+ * 现在：
+ *      1.submit()只登记任务并交给常驻线程池，不为每个请求创建线程
+ *      2.任务完成时只把(handle, status, result)放进完成列表；
+ *        第一个完成的任务再向线程池提交一个flush任务，flush执行之前完成的任务都合并到同一批，
+ *        一批只有一次JNI调用：NativeAsync.onCompleted(long[])
+ *      3.取消是协作式的：cancel()只设置标记，还没开始的任务不再执行，
+ *        正在执行的任务在安全点(AsyncToken::cancelled())看到标记后自己提前返回
+ *
+ * 句柄的生命周期：submit() ---> 完成并放进完成列表(或者release()) 之后native端不再持有
+ * release()之后即使任务完成，也不会再回调Java。MainActivity.onDestroy中releaseAll()
+ *
+ * long[]的格式：每个任务占三个long
+ *      batch[3i] = handle, batch[3i + 1] = AsyncStatus, batch[3i + 2] = result
+ */
+enum class AsyncStatus : jint {
+    Pending = 0,    //还没完成(只在Java端使用)
+    Done = 1,
+    Cancelled = 2,
+    Failed = 3,     //任务返回失败、或者抛出了Java异常
+};
+
+//内置的任务类型，与NativeAsync.java一致
+enum class AsyncKind : jint {
+    Sum = 0,        //0 + 1 + ... + (arg - 1)，每kAsyncSumSlice次检查一次取消
+    Sleep = 1,      //睡眠arg毫秒，每1ms检查一次取消
+};
+
+//任务执行期间的取消标记，只读
+class AsyncToken {
+public:
+    explicit AsyncToken(const std::atomic<bool> &flag) : mFlag(flag) {}
+
+    //安全点：任务在循环中定期调用，返回true时应尽快返回AsyncStatus::Cancelled
+    bool cancelled() const { return mFlag.load(std::memory_order_relaxed); }
+
+private:
+    const std::atomic<bool> &mFlag;
+};
+
+struct AsyncStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;  //Done + Cancelled + Failed
+    uint64_t cancelled = 0;
+    uint64_t batches = 0;    //回调Java的次数
+};
+
+class AsyncCalls {
+public:
+    /**
+     * 在工作线程中执行，env属于工作线程
+     * @result: 任务的结果，随完成通知一起交给Java
+     * @return: Done、Cancelled、Failed之一
+     */
+    using Job = std::function<AsyncStatus(JNIEnv *env, const AsyncToken &token, jlong &result)>;
+
+    static AsyncCalls &instance();
+
+    //@return: 句柄(> 0)；线程池不可用、或者队列已满时返回0
+    jlong submit(Job job);
+
+    //请求取消，任务已经完成或者句柄不存在时返回false
+    bool cancel(jlong handle);
+
+    //取消并放弃句柄，之后不会再有这个句柄的完成通知
+    void release(jlong handle);
+
+    //release()所有句柄，返回释放的个数
+    size_t releaseAll();
+
+    AsyncStats stats() const;
+
+private:
+    struct Call {
+        std::atomic<bool> cancelRequested{false};
+        Job job;
+    };
+
+    AsyncCalls() = default;
+
+    void run(JNIEnv *env, jlong handle, const std::shared_ptr<Call> &call);
+
+    void complete(JNIEnv *env, jlong handle, AsyncStatus status, jlong result);
+
+    void flush(JNIEnv *env);
+
+    std::mutex mMutex; //保护mCalls、mCompleted
+    std::unordered_map<jlong, std::shared_ptr<Call>> mCalls;
+    std::vector<jlong> mCompleted;
+    std::atomic<bool> mFlushPending{false};
+    std::atomic<jlong> mNextHandle{1};
+
+    std::atomic<uint64_t> mSubmitted{0};
+    std::atomic<uint64_t> mFinished{0};
+    std::atomic<uint64_t> mCancelled{0};
+    std::atomic<uint64_t> mBatches{0};
+};
+
+//内置任务，@return: kind不存在时返回空的Job
+AsyncCalls::Job async_builtin_job(AsyncKind kind, jlong arg);
+
+#endif //STUDYJNI_ASYNC_CALLS_H
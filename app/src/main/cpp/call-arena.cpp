@@ -0,0 +1,123 @@
+#include "call-arena.h"
+#include <cstdlib>
+
+static std::atomic<uint64_t> sScopes(0);
+static std::atomic<uint64_t> sHighWater(0);
+static std::atomic<uint64_t> sFallbacks(0);
+static std::atomic<uint64_t> sFallbackBytes(0);
+static std::atomic<uint64_t> sThreads(0);
+static std::atomic<uint64_t> sPoolMisses(0);
+
+namespace {
+
+//malloc退路的链表节点，放在分配的内存前面
+struct alignas(std::max_align_t) FallbackNode {
+    FallbackNode *next;
+};
+
+struct ThreadArena {
+    uint8_t *block = nullptr;
+    size_t used = 0;
+    size_t highWater = 0;
+    FallbackNode *fallbacks = nullptr;
+
+    ~ThreadArena() { free(block); }
+
+    //线程第一次使用时才分配
+    bool ensureBlock() {
+        if (block) {
+            return true;
+        }
+        block = static_cast<uint8_t *>(malloc(kArenaBlockBytes));
+        if (block) {
+            sThreads.fetch_add(1, std::memory_order_relaxed);
+        }
+        return block != nullptr;
+    }
+};
+
+thread_local ThreadArena tArena;
+
+} //namespace
+
+ArenaStats arena_stats() {
+    ArenaStats s;
+    s.scopes = sScopes.load(std::memory_order_relaxed);
+    s.highWater = sHighWater.load(std::memory_order_relaxed);
+    s.fallbacks = sFallbacks.load(std::memory_order_relaxed);
+    s.fallbackBytes = sFallbackBytes.load(std::memory_order_relaxed);
+    s.threads = sThreads.load(std::memory_order_relaxed);
+    s.poolMisses = sPoolMisses.load(std::memory_order_relaxed);
+    return s;
+}
+
+void arena_count_pool_miss() {
+    sPoolMisses.fetch_add(1, std::memory_order_relaxed);
+}
+
+ArenaScope::ArenaScope() : mMark(tArena.used), mFallbacks(tArena.fallbacks) {
+    sScopes.fetch_add(1, std::memory_order_relaxed);
+}
+
+ArenaScope::~ArenaScope() {
+    ThreadArena &arena = tArena;
+    //线程内的最大值先在本地比较，超过时才更新全局的原子变量
+    if (arena.used > arena.highWater) {
+        arena.highWater = arena.used;
+        uint64_t current = sHighWater.load(std::memory_order_relaxed);
+        while (arena.highWater > current
+               && !sHighWater.compare_exchange_weak(current, arena.highWater, std::memory_order_relaxed)) {
+        }
+    }
+    auto *stop = static_cast<FallbackNode *>(mFallbacks);
+    while (arena.fallbacks != stop) {
+        FallbackNode *node = arena.fallbacks;
+        arena.fallbacks = node->next;
+        free(node);
+    }
+    arena.used = mMark;
+}
+
+void *ArenaScope::allocate(size_t bytes, size_t align) {
+    ThreadArena &arena = tArena;
+    if (align <= alignof(std::max_align_t) && arena.ensureBlock()) {
+        size_t offset = (arena.used + align - 1) & ~(align - 1);
+        if (offset <= kArenaBlockBytes && bytes <= kArenaBlockBytes - offset) {
+            arena.used = offset + bytes;
+            //已使用量在scope结束时才计入highWater，这里只移动指针
+            return arena.block + offset;
+        }
+    }
+    if (align > alignof(std::max_align_t) || bytes > SIZE_MAX - sizeof(FallbackNode)) {
+        return nullptr;
+    }
+    //放不下：malloc，挂到链表上，由当前scope结束时free
+    auto *node = static_cast<FallbackNode *>(malloc(sizeof(FallbackNode) + bytes));
+    if (!node) {
+        return nullptr;
+    }
+    node->next = arena.fallbacks;
+    arena.fallbacks = node;
+    sFallbacks.fetch_add(1, std::memory_order_relaxed);
+    sFallbackBytes.fetch_add(bytes, std::memory_order_relaxed);
+    return node + 1;
+}
+
+const char *ArenaScope::utf_chars(JNIEnv *env, jstring str, size_t *length) {
+    if (!str) {
+        return nullptr;
+    }
+    //api: void GetStringUTFRegion(jstring str, jsize start, jsize len, char* buf) 写入调用者的缓冲区，不分配内存
+    const jsize chars = env->GetStringLength(str);
+    const auto bytes = (size_t) env->GetStringUTFLength(str);
+    auto *buffer = static_cast<char *>(allocate(bytes + 1, 1));
+    if (!buffer) {
+        return nullptr;
+    }
+    env->GetStringUTFRegion(str, 0, chars, buffer);
+    buffer[bytes] = '\0';
+    if (length) {
+        *length = bytes;
+    }
+    return buffer;
+}
@@ -0,0 +1,130 @@
+#ifndef STUDYJNI_CALL_ARENA_H
+#define STUDYJNI_CALL_ARENA_H
+
+#include <jni.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * 每个线程一块的bump分配器，给native函数中的临时数据使用
+ *
+ * 以前的写法：GetStringUTFChars每次都分配一块新内存(putStudent中三次、callAddMethod一次...)，
+ *      用完ReleaseStringUTFChars释放；热路径上全是malloc/free
+ * 现在：
+ *      ArenaScope scope;                           //native函数开头
+ *      const char *s = scope.utf_chars(env, str);  //GetStringUTFRegion直接写进线程的arena
+ *      ...                                         //函数返回时scope析构，arena回到进入时的位置
+ *
+ * 1.每个线程第一次使用时分配一块kArenaBlockBytes的内存，之后一直复用，分配只是移动指针
+ * 2.ArenaScope可以嵌套(native上行调用Java，Java又调用native)，每个scope只回退自己分配的部分
+ * 3.arena放不下时退回到malloc(计数)，scope结束时一起free，调用者不需要区分
+ * 4.只能在分配它的线程、分配它的scope内使用，不能跨线程传递(跨线程的对象用ObjectPool)
+ *
+ * 统计：arena_stats()，NativeStats.arenaStats()
+ */
+constexpr size_t kArenaBlockBytes = 16 * 1024;
+
+struct ArenaStats {
+    uint64_t scopes = 0;            //ArenaScope的个数(大约是使用arena的native调用次数)
+    uint64_t highWater = 0;         //所有线程中，一个arena最多同时使用的字节数
+    uint64_t fallbacks = 0;         //arena放不下、退回到malloc的次数
+    uint64_t fallbackBytes = 0;
+    uint64_t threads = 0;           //分配过arena的线程数
+    uint64_t poolMisses = 0;        //ObjectPool为空(或已满)时new/delete的次数
+};
+
+ArenaStats arena_stats();
+
+//ObjectPool的计数，所有池共用
+void arena_count_pool_miss();
+
+class ArenaScope {
+public:
+    ArenaScope();
+
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+    //失败(malloc也失败)返回nullptr
+    void *allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    //只能放平凡析构的类型：scope结束时不会调用析构函数
+    template<typename T, typename... Args>
+    T *make(Args &&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "ArenaScope::make只能用于平凡析构的类型");
+        void *memory = allocate(sizeof(T), alignof(T));
+        return memory ? new(memory) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    /**
+     * jstring ---> '\0'结尾的Modified UTF-8(与GetStringUTFChars相同)，写在arena中
+     * str为null或者分配失败时返回nullptr；@length可为nullptr
+     */
+    const char *utf_chars(JNIEnv *env, jstring str, size_t *length = nullptr);
+
+private:
+    size_t mMark;       //进入时arena的位置
+    void *mFallbacks;   //进入时malloc链表的头
+};
+
+/**
+ * 固定大小的对象池：跨线程使用的小对象(e.g: nativeThread的MyContext在UI线程创建、在工作线程释放)
+ * 空闲对象最多kCapacity个，超过时直接delete；取出时用默认值重新赋值
+ */
+template<typename T, size_t kCapacity>
+class ObjectPool {
+public:
+    ObjectPool() = default;
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    //只释放空闲的对象，借出的对象由调用者负责
+    ~ObjectPool() {
+        for (T *obj : mFree) {
+            delete obj;
+        }
+    }
+
+    T *acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mFree.empty()) {
+                T *obj = mFree.back();
+                mFree.pop_back();
+                *obj = T();
+                return obj;
+            }
+        }
+        arena_count_pool_miss();
+        return new(std::nothrow) T();
+    }
+
+    void release(T *obj) {
+        if (!obj) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mFree.size() < kCapacity) {
+                mFree.push_back(obj);
+                return;
+            }
+        }
+        arena_count_pool_miss();
+        delete obj;
+    }
+
+private:
+    std::mutex mMutex;
+    std::vector<T *> mFree;
+};
+
+#endif //STUDYJNI_CALL_ARENA_H
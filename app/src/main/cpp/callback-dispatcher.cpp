@@ -0,0 +1,243 @@
+#include "callback-dispatcher.h"
+#include "array-bridge.h"
+#include "jni-cache.h"
+#include "jni-log.h"
+#include "jni-thread.h"
+#include "jni-util.h"
+#include <cerrno>
+#include <sched.h>
+
+static constexpr size_t kMinQueueCapacity = 64;
+
+CallbackDispatcher &CallbackDispatcher::instance() {
+    static CallbackDispatcher dispatcher;
+    return dispatcher;
+}
+
+bool CallbackDispatcher::start(JNIEnv *env, jobject listener, jint intervalMs, size_t capacity,
+                               OverflowPolicy policy) {
+    std::lock_guard<std::mutex> lock(mLifecycleMutex);
+    if (mRunning.load(std::memory_order_relaxed)) {
+        LOGE("CallbackDispatcher: 已经启动")
+        return false;
+    }
+    if (!jni_cache_ready() || intervalMs < 0 || (intervalMs > 0 && !listener)) {
+        return false;
+    }
+    //没有生产者在访问队列(stop()已经等它们退出)，可以直接替换
+    mQueue.reset(new MpmcQueue<DispatchEvent>(capacity < kMinQueueCapacity ? kMinQueueCapacity : capacity));
+    mPolicy = policy;
+    mIntervalMs = intervalMs;
+    mListener = listener ? env->NewGlobalRef(listener) : nullptr;
+    mBatch.clear();
+    mIndex.clear();
+    mEnqueued.store(0, std::memory_order_relaxed);
+    mCoalesced.store(0, std::memory_order_relaxed);
+    mDropped.store(0, std::memory_order_relaxed);
+    mBatches.store(0, std::memory_order_relaxed);
+    mDelivered.store(0, std::memory_order_relaxed);
+    mRunning.store(true, std::memory_order_seq_cst);
+
+    if (intervalMs > 0) {
+        sem_init(&mWakeup, 0, 0);
+        if (pthread_create(&mThread, nullptr, dispatch_main, this) != 0) {
+            LOGE("CallbackDispatcher: 创建分发线程失败")
+            mRunning.store(false, std::memory_order_seq_cst);
+            sem_destroy(&mWakeup);
+            env->DeleteGlobalRef(mListener);
+            mListener = nullptr;
+            return false;
+        }
+        mHasThread = true;
+    }
+    LOGD("CallbackDispatcher: 已启动, intervalMs = %d, capacity = %zu, policy = %d",
+         intervalMs, mQueue->capacity(), (int) policy)
+    return true;
+}
+
+void CallbackDispatcher::stop(JNIEnv *env) {
+    std::lock_guard<std::mutex> lock(mLifecycleMutex);
+    if (!mRunning.load(std::memory_order_relaxed)) {
+        return;
+    }
+    mRunning.store(false, std::memory_order_seq_cst);
+    //等正在post()的生产者离开，之后队列中的事件不会再增加
+    while (mProducers.load(std::memory_order_seq_cst) != 0) {
+        sched_yield();
+    }
+    if (mHasThread) {
+        //分发线程醒来后看到mRunning == false，会把剩余的事件最后投递一次再退出
+        sem_post(&mWakeup);
+        pthread_join(mThread, nullptr);
+        sem_destroy(&mWakeup);
+        mHasThread = false;
+    } else {
+        DispatchEvent event{};
+        uint64_t remaining = 0;
+        while (mQueue->tryPop(event)) {
+            ++remaining;
+        }
+        mDropped.fetch_add(remaining, std::memory_order_relaxed);
+    }
+    if (mListener) {
+        env->DeleteGlobalRef(mListener);
+        mListener = nullptr;
+    }
+    DispatcherStats s = stats();
+    LOGD("CallbackDispatcher: 已停止, enqueued = %llu, coalesced = %llu, dropped = %llu, batches = %llu",
+         (unsigned long long) s.enqueued, (unsigned long long) s.coalesced,
+         (unsigned long long) s.dropped, (unsigned long long) s.batches)
+}
+
+bool CallbackDispatcher::post(int32_t type, int32_t key, int64_t value) {
+    //先登记再检查mRunning：stop()先清mRunning再等mProducers归零，两者都是seq_cst，不会漏掉
+    mProducers.fetch_add(1, std::memory_order_seq_cst);
+    if (!mRunning.load(std::memory_order_seq_cst)) {
+        mProducers.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+    DispatchEvent event{type, key, value};
+    bool ok = push(event);
+    mProducers.fetch_sub(1, std::memory_order_release);
+    if (ok) {
+        mEnqueued.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ok;
+}
+
+bool CallbackDispatcher::push(DispatchEvent &event) {
+    MpmcQueue<DispatchEvent> &queue = *mQueue;
+    if (queue.tryPush(event)) {
+        return true;
+    }
+    switch (mPolicy) {
+        case OverflowPolicy::DropOldest: {
+            //挤掉最旧的事件腾出位置。队列是MPMC的，生产者也可以pop
+            DispatchEvent oldest{};
+            for (int attempt = 0; attempt < 8; ++attempt) {
+                if (queue.tryPop(oldest)) {
+                    mDropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (queue.tryPush(event)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        case OverflowPolicy::Block: {
+            const jlong deadline = now_ns() + (jlong) kBlockTimeoutMs * 1000000LL;
+            while (mRunning.load(std::memory_order_relaxed) && now_ns() < deadline) {
+                sched_yield();
+                if (queue.tryPush(event)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        case OverflowPolicy::DropNewest:
+        default:
+            return false;
+    }
+}
+
+size_t CallbackDispatcher::collect() {
+    mBatch.clear();
+    mIndex.clear();
+    DispatchEvent event{};
+    uint64_t coalesced = 0;
+    //每批最多取一个队列容量，生产者一直写的时候消费者也能按时投递
+    const size_t limit = mQueue->capacity();
+    for (size_t popped = 0; popped < limit && mQueue->tryPop(event); ++popped) {
+        uint64_t key = ((uint64_t) (uint32_t) event.type << 32) | (uint32_t) event.key;
+        auto it = mIndex.find(key);
+        if (it != mIndex.end()) {
+            mBatch[it->second].value = event.value; //保留第一次出现的位置，value取最新的
+            ++coalesced;
+        } else {
+            mIndex.emplace(key, mBatch.size());
+            mBatch.push_back(event);
+        }
+    }
+    if (coalesced) {
+        mCoalesced.fetch_add(coalesced, std::memory_order_relaxed);
+    }
+    return mBatch.size();
+}
+
+jlongArray CallbackDispatcher::buildArray(JNIEnv *env) {
+    const size_t n = mBatch.size();
+    mEncoded.resize(n * 2);
+    for (size_t i = 0; i < n; ++i) {
+        const DispatchEvent &event = mBatch[i];
+        mEncoded[i * 2] = (jlong) (((uint64_t) (uint32_t) event.type << 32) | (uint32_t) event.key);
+        mEncoded[i * 2 + 1] = event.value;
+    }
+    jlongArray array = new_java_array(env, mEncoded.data(), (jsize) mEncoded.size());
+    if (!array) {
+        env->ExceptionClear();
+        mDropped.fetch_add(n, std::memory_order_relaxed);
+        return nullptr;
+    }
+    mBatches.fetch_add(1, std::memory_order_relaxed);
+    mDelivered.fetch_add(n, std::memory_order_relaxed);
+    return array;
+}
+
+void CallbackDispatcher::deliver(JNIEnv *env) {
+    if (collect() == 0) {
+        return;
+    }
+    jlongArray array = buildArray(env);
+    if (!array) {
+        return;
+    }
+    //一批事件只有这一次JNI调用
+    jni_cache().eventListenerOnEventsMid(env, mListener, array);
+    if (env->ExceptionCheck()) {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+    env->DeleteLocalRef(array); //分发线程不会返回Java，局部引用要自己释放
+}
+
+jlongArray CallbackDispatcher::poll(JNIEnv *env) {
+    if (!mQueue || mIntervalMs != 0) {
+        return nullptr; //间隔模式下由分发线程独占消费
+    }
+    if (collect() == 0) {
+        return nullptr;
+    }
+    return buildArray(env);
+}
+
+DispatcherStats CallbackDispatcher::stats() const {
+    DispatcherStats s;
+    s.enqueued = mEnqueued.load(std::memory_order_relaxed);
+    s.coalesced = mCoalesced.load(std::memory_order_relaxed);
+    s.dropped = mDropped.load(std::memory_order_relaxed);
+    s.batches = mBatches.load(std::memory_order_relaxed);
+    s.delivered = mDelivered.load(std::memory_order_relaxed);
+    return s;
+}
+
+void *CallbackDispatcher::dispatch_main(void *args) {
+    auto *self = static_cast<CallbackDispatcher *>(args);
+    JNIEnv *env = attach_current_thread("study_jni-dispatch");
+    if (!env) {
+        return nullptr;
+    }
+    while (self->mRunning.load(std::memory_order_acquire)) {
+        timespec deadline{};
+        clock_gettime(CLOCK_REALTIME, &deadline); //sem_timedwait使用的是CLOCK_REALTIME
+        deadline.tv_nsec += (long) self->mIntervalMs * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        while (sem_timedwait(&self->mWakeup, &deadline) == -1 && errno == EINTR) {
+        }
+        self->deliver(env);
+    }
+    self->deliver(env); //停止前最后投递一次
+    return nullptr;
+}
@@ -0,0 +1,124 @@
+#ifndef STUDYJNI_CALLBACK_DISPATCHER_H
+#define STUDYJNI_CALLBACK_DISPATCHER_H
+
+#include <jni.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unordered_map>
+#include <vector>
+#include "mpmc-queue.h"
+
+/**
+ * native ---> Java 的事件分发器(多生产者/单消费者)，取代每个事件一次 CallVoidMethod + runOnUiThread
+ *
+ * 以前：cpp_thread_run()每个事件都调用一次updateActivityUI()，Java层再runOnUiThread()一次，
+ *      native线程产生事件很快时，主线程的消息队列会被淹没
+ * 现在：
+ *      1.任意native线程post()事件，只写无锁队列，不调用任何JNI函数
+ *      2.消费者每隔一段时间取出队列中的所有事件，合并：(type, key)相同的事件只保留最新的value
+ *      3.一批事件编码成一个long[]，一次JNI调用交给Java
+ *
+ * 两种投递模式：
+ *      间隔模式(intervalMs > 0)：native的分发线程每intervalMs回调一次 Listener.onEvents(long[])
+ *      帧模式(intervalMs == 0)：没有分发线程，Java在每一帧(Choreographer)调用poll()拉取，直接在主线程处理
+ *
+ * long[]的格式：每个事件占两个long
+ *      events[2i]     = ((long) type << 32) | (key & 0xFFFFFFFFL)
+ *      events[2i + 1] = value
+ */
+enum class OverflowPolicy : jint {
+    DropNewest = 0,  //队列满时丢弃新事件
+    DropOldest = 1,  //队列满时丢弃队列中最旧的事件
+    Block = 2,       //队列满时生产者等待(背压)，超过kBlockTimeoutMs仍然没有空间才丢弃
+};
+
+//事件类型，与NativeEventDispatcher.java一致
+constexpr int32_t kEventUpdateUI = 1;
+
+struct DispatchEvent {
+    int32_t type;
+    int32_t key;
+    int64_t value;
+};
+
+struct DispatcherStats {
+    uint64_t enqueued = 0;   //成功进入队列的事件数
+    uint64_t coalesced = 0;  //被合并掉的事件数
+    uint64_t dropped = 0;    //因队列满、或停止时丢弃的事件数
+    uint64_t batches = 0;    //交给Java的批次数(即JNI调用次数)
+    uint64_t delivered = 0;  //交给Java的事件数
+};
+
+class CallbackDispatcher {
+public:
+    static constexpr int kBlockTimeoutMs = 100;
+
+    static CallbackDispatcher &instance();
+
+    /**
+     * @listener: 间隔模式下的回调对象(NativeEventDispatcher.Listener)，内部提升为全局引用；帧模式可为null
+     * @intervalMs: 投递间隔，0表示帧模式
+     * @capacity: 队列容量，会向上取整为2的幂
+     * @return: 已经启动、或者启动失败返回false
+     */
+    bool start(JNIEnv *env, jobject listener, jint intervalMs, size_t capacity, OverflowPolicy policy);
+
+    /**
+     * 停止接收事件。间隔模式下会把队列中剩余的事件最后投递一次，再结束分发线程；
+     * 帧模式下剩余的事件计入dropped
+     */
+    void stop(JNIEnv *env);
+
+    //任意线程调用，不涉及JNI。未启动时返回false
+    bool post(int32_t type, int32_t key, int64_t value);
+
+    //帧模式：取出并合并当前所有事件，没有事件返回nullptr。只能由一个线程调用(主线程)
+    jlongArray poll(JNIEnv *env);
+
+    bool isRunning() const { return mRunning.load(std::memory_order_acquire); }
+
+    DispatcherStats stats() const;
+
+private:
+    CallbackDispatcher() = default;
+
+    bool push(DispatchEvent &event);
+
+    //从队列取出所有事件合并到mBatch中，返回合并后的事件数
+    size_t collect();
+
+    jlongArray buildArray(JNIEnv *env);
+
+    void deliver(JNIEnv *env);
+
+    static void *dispatch_main(void *args);
+
+    std::unique_ptr<MpmcQueue<DispatchEvent>> mQueue;
+    OverflowPolicy mPolicy = OverflowPolicy::DropNewest;
+    jint mIntervalMs = 0;
+    jobject mListener = nullptr;  //全局引用
+    pthread_t mThread{};
+    bool mHasThread = false;
+    sem_t mWakeup{};              //stop()时唤醒分发线程
+
+    std::mutex mLifecycleMutex;   //只保护start/stop
+    std::atomic<bool> mRunning{false};
+    std::atomic<int> mProducers{0}; //正在访问队列的生产者数，stop()要等它归零
+
+    //只由消费者访问
+    std::vector<DispatchEvent> mBatch;
+    std::unordered_map<uint64_t, size_t> mIndex; //(type, key) ---> mBatch中的下标
+    std::vector<jlong> mEncoded;
+
+    std::atomic<uint64_t> mEnqueued{0};
+    std::atomic<uint64_t> mCoalesced{0};
+    std::atomic<uint64_t> mDropped{0};
+    std::atomic<uint64_t> mBatches{0};
+    std::atomic<uint64_t> mDelivered{0};
+};
+
+#endif //STUDYJNI_CALLBACK_DISPATCHER_H
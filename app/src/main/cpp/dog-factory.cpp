@@ -0,0 +1,81 @@
+#include "dog-factory.h"
+#include "jni-cache.h"
+#include "jni-stats.h"
+
+int dog_ctor_arity(jint selector) {
+    switch ((DogCtor) selector) {
+        case DogCtor::Default:
+            return 0;
+        case DogCtor::Int:
+            return 1;
+        case DogCtor::IntInt:
+            return 2;
+    }
+    return -1;
+}
+
+/**
+ * 填充array的[begin, end)，调用者已经PushLocalFrame
+ * Arity是模板参数：每种构造函数生成一份循环，循环内没有分支
+ */
+template<int Arity>
+static bool fill_chunk(JNIEnv *env, jobjectArray array, jclass clazz, jmethodID ctor,
+                       const jint *args, jsize begin, jsize end) {
+    for (jsize i = begin; i < end; ++i) {
+        jobject dog;
+        if constexpr (Arity == 0) {
+            dog = env->NewObject(clazz, ctor);
+        } else if constexpr (Arity == 1) {
+            dog = env->NewObject(clazz, ctor, args[i]);
+        } else {
+            dog = env->NewObject(clazz, ctor, args[2 * i], args[2 * i + 1]);
+        }
+        if (!dog) {
+            return false; //构造函数抛出了异常
+        }
+        env->SetObjectArrayElement(array, i, dog);
+        //dog不单独DeleteLocalRef，由PopLocalFrame一起释放
+    }
+    return true;
+}
+
+template<int Arity>
+static jobjectArray fill_dogs(JNIEnv *env, jobjectArray array, jmethodID ctor, const jint *args, jsize count) {
+    jclass clazz = jni_cache().dogClass;
+    for (jsize begin = 0; begin < count; begin += kDogFrameChunk) {
+        jsize end = count - begin > kDogFrameChunk ? begin + kDogFrameChunk : count;
+        //api: jint PushLocalFrame(jint capacity) 确保至少能再创建capacity个局部引用
+        if (env->PushLocalFrame(kDogFrameChunk) != JNI_OK) {
+            env->DeleteLocalRef(array);
+            return nullptr;
+        }
+        bool ok = fill_chunk<Arity>(env, array, clazz, ctor, args, begin, end);
+        //api: jobject PopLocalFrame(jobject result) 释放这一帧中的所有局部引用
+        env->PopLocalFrame(nullptr);
+        jni_stats_add_local_refs((uint32_t) (end - begin));
+        if (!ok) {
+            env->DeleteLocalRef(array);
+            return nullptr;
+        }
+    }
+    return array;
+}
+
+jobjectArray new_dog_array(JNIEnv *env, DogCtor ctor, const jint *args, jsize count) {
+    const JniCache &cache = jni_cache();
+    jobjectArray array = env->NewObjectArray(count, cache.dogClass, nullptr);
+    if (!array) {
+        return nullptr;
+    }
+    jni_stats_add_local_refs(1);
+    switch (ctor) {
+        case DogCtor::Default:
+            return fill_dogs<0>(env, array, cache.dogInitMid, args, count);
+        case DogCtor::Int:
+            return fill_dogs<1>(env, array, cache.dogInitIMid, args, count);
+        case DogCtor::IntInt:
+            return fill_dogs<2>(env, array, cache.dogInitIIMid, args, count);
+    }
+    env->DeleteLocalRef(array);
+    return nullptr;
+}
@@ -0,0 +1,37 @@
+#ifndef STUDYJNI_DOG_FACTORY_H
+#define STUDYJNI_DOG_FACTORY_H
+
+#include <jni.h>
+
+/**
+ * 批量创建Dog对象，一次native调用返回填充好的Dog[]
+ *
+ * 以前的写法(testQuote)：每个对象一次NewObject，每次都GetMethodID，局部引用用完不释放；
+ *      对象一多，局部引用表就会溢出(Android上限512，超出直接崩溃)
+ * 现在：
+ *      1.jclass、构造函数的jmethodID都来自JNI ID缓存
+ *      2.构造函数的选择在循环外完成，循环内只有 NewObject + SetObjectArrayElement
+ *      3.每kDogFrameChunk个对象一个局部帧(PushLocalFrame/PopLocalFrame)，
+ *        一次PopLocalFrame释放整块的局部引用，不需要每个对象再DeleteLocalRef，
+ *        任何批量大小下同时存在的局部引用都不超过kDogFrameChunk个
+ */
+
+//与DogFactory.java的CTOR_*一致
+enum class DogCtor : jint {
+    Default = 0, //Dog()
+    Int = 1,     //Dog(int)
+    IntInt = 2,  //Dog(int, int)
+};
+
+constexpr jsize kDogFrameChunk = 256;
+
+//构造函数的参数个数，selector不合法返回-1
+int dog_ctor_arity(jint selector);
+
+/**
+ * @args: 构造函数的参数，按对象顺序连续存放，每个对象arity个，共count * arity个；Default时可以为nullptr
+ * 失败返回nullptr，此时有Java异常挂起(OutOfMemoryError，或者构造函数抛出的异常)
+ */
+jobjectArray new_dog_array(JNIEnv *env, DogCtor ctor, const jint *args, jsize count);
+
+#endif //STUDYJNI_DOG_FACTORY_H
@@ -0,0 +1,243 @@
+#include "field-mirror.h"
+#include "jni-log.h"
+#include "jni-stats.h"
+#include "string-batch.h"
+#include <cstdlib>
+#include <cstring>
+
+static const char *type_signature(MirrorType type) {
+    switch (type) {
+        case MirrorType::Boolean:
+            return "Z";
+        case MirrorType::Int:
+            return "I";
+        case MirrorType::Long:
+            return "J";
+        case MirrorType::Float:
+            return "F";
+        case MirrorType::Double:
+            return "D";
+        case MirrorType::String:
+            return "Ljava/lang/String;";
+    }
+    return "";
+}
+
+FieldMirror *FieldMirror::create(JNIEnv *env, jclass clazz, const MirrorFieldSpec *specs, size_t count) {
+    if (!clazz || count > kMirrorMaxFields) {
+        LOGE("FieldMirror: 字段表为空或者超过%zu个字段", kMirrorMaxFields)
+        return nullptr;
+    }
+    auto *mirror = new FieldMirror();
+    mirror->mFields.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        Field &f = mirror->mFields[i];
+        f.spec = specs[i];
+        const char *sig = type_signature(f.spec.type);
+        f.id = f.spec.isStatic ? env->GetStaticFieldID(clazz, f.spec.name, sig)
+                               : env->GetFieldID(clazz, f.spec.name, sig);
+        if (!f.id) {
+            LOGE("FieldMirror: 找不到字段 %s %s", f.spec.name, sig)
+            delete mirror;
+            return nullptr;
+        }
+        memset(&f.value, 0, sizeof(f.value));
+        f.isNull = true;
+        mirror->mHasInstanceFields |= !f.spec.isStatic;
+    }
+    mirror->mClass = (jclass) env->NewGlobalRef(clazz);
+    if (!mirror->mClass) {
+        delete mirror;
+        return nullptr;
+    }
+    return mirror;
+}
+
+void FieldMirror::destroy(JNIEnv *env) {
+    env->DeleteGlobalRef(mClass);
+    delete this;
+}
+
+//类型与字段表不一致是调用者的bug，直接abort，而不是悄悄写错字段
+const FieldMirror::Field &FieldMirror::checked(size_t field, MirrorType type) const {
+    if (field >= mFields.size() || mFields[field].spec.type != type) {
+        LOGE("FieldMirror: 字段%zu不存在或者类型不一致", field)
+        abort();
+    }
+    return mFields[field];
+}
+
+FieldMirror::Field &FieldMirror::checked(size_t field, MirrorType type) {
+    return const_cast<Field &>(static_cast<const FieldMirror *>(this)->checked(field, type));
+}
+
+#define STUDYJNI_MIRROR_ACCESSORS(Name, T, member, Type)                  \
+    T FieldMirror::get##Name(size_t field) const {                        \
+        std::lock_guard<std::mutex> lock(mMutex);                         \
+        return checked(field, MirrorType::Type).value.member;             \
+    }                                                                     \
+    void FieldMirror::set##Name(size_t field, T value) {                  \
+        std::lock_guard<std::mutex> lock(mMutex);                         \
+        Field &f = checked(field, MirrorType::Type);                      \
+        /*按位比较：浮点的NaN、-0.0也能正确判断是否变化*/                    \
+        if (memcmp(&f.value.member, &value, sizeof(T)) != 0) {            \
+            f.value.member = value;                                       \
+            markDirty(field);                                             \
+        }                                                                 \
+    }
+
+STUDYJNI_MIRROR_ACCESSORS(Boolean, jboolean, z, Boolean)
+STUDYJNI_MIRROR_ACCESSORS(Int, jint, i, Int)
+STUDYJNI_MIRROR_ACCESSORS(Long, jlong, j, Long)
+STUDYJNI_MIRROR_ACCESSORS(Float, jfloat, f, Float)
+STUDYJNI_MIRROR_ACCESSORS(Double, jdouble, d, Double)
+
+#undef STUDYJNI_MIRROR_ACCESSORS
+
+void FieldMirror::addInt(size_t field, jint delta) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    Field &f = checked(field, MirrorType::Int);
+    if (delta != 0) {
+        //与Java的int加法一样溢出回绕
+        f.value.i = (jint) ((uint32_t) f.value.i + (uint32_t) delta);
+        markDirty(field);
+    }
+}
+
+std::string FieldMirror::getString(size_t field, bool *isNull) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const Field &f = checked(field, MirrorType::String);
+    if (isNull) {
+        *isNull = f.isNull;
+    }
+    return f.utf8;
+}
+
+void FieldMirror::setString(size_t field, const char *utf8, size_t len) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    Field &f = checked(field, MirrorType::String);
+    if (!utf8) {
+        if (!f.isNull) {
+            f.isNull = true;
+            f.utf8.clear();
+            markDirty(field);
+        }
+        return;
+    }
+    if (f.isNull || f.utf8.size() != len || memcmp(f.utf8.data(), utf8, len) != 0) {
+        f.isNull = false;
+        f.utf8.assign(utf8, len);
+        markDirty(field);
+    }
+}
+
+uint64_t FieldMirror::dirtyMask() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDirty;
+}
+
+//只在持有mMutex时调用
+bool FieldMirror::write(JNIEnv *env, jobject obj, const Field &f) {
+    const bool isStatic = f.spec.isStatic;
+    switch (f.spec.type) {
+        case MirrorType::Boolean:
+            isStatic ? env->SetStaticBooleanField(mClass, f.id, f.value.z) : env->SetBooleanField(obj, f.id, f.value.z);
+            break;
+        case MirrorType::Int:
+            isStatic ? env->SetStaticIntField(mClass, f.id, f.value.i) : env->SetIntField(obj, f.id, f.value.i);
+            break;
+        case MirrorType::Long:
+            isStatic ? env->SetStaticLongField(mClass, f.id, f.value.j) : env->SetLongField(obj, f.id, f.value.j);
+            break;
+        case MirrorType::Float:
+            isStatic ? env->SetStaticFloatField(mClass, f.id, f.value.f) : env->SetFloatField(obj, f.id, f.value.f);
+            break;
+        case MirrorType::Double:
+            isStatic ? env->SetStaticDoubleField(mClass, f.id, f.value.d) : env->SetDoubleField(obj, f.id, f.value.d);
+            break;
+        case MirrorType::String: {
+            jstring value = nullptr;
+            if (!f.isNull) {
+                //标准UTF-8 ---> UTF-16 ---> NewString，NewStringUTF要求Modified UTF-8，见jni-intern.h
+                mUtf16.resize(f.utf8.size());
+                size_t chars = utf8_to_utf16(f.utf8.data(), f.utf8.size(), mUtf16.data());
+                value = env->NewString(mUtf16.data(), (jsize) chars);
+                if (!value) {
+                    return false;
+                }
+                jni_stats_add_bytes(chars * sizeof(jchar));
+            }
+            isStatic ? env->SetStaticObjectField(mClass, f.id, value) : env->SetObjectField(obj, f.id, value);
+            if (value) {
+                env->DeleteLocalRef(value);
+            }
+            break;
+        }
+    }
+    return !env->ExceptionCheck();
+}
+
+//只在持有mMutex时调用
+bool FieldMirror::read(JNIEnv *env, jobject obj, Field &f) {
+    const bool isStatic = f.spec.isStatic;
+    switch (f.spec.type) {
+        case MirrorType::Boolean:
+            f.value.z = isStatic ? env->GetStaticBooleanField(mClass, f.id) : env->GetBooleanField(obj, f.id);
+            break;
+        case MirrorType::Int:
+            f.value.i = isStatic ? env->GetStaticIntField(mClass, f.id) : env->GetIntField(obj, f.id);
+            break;
+        case MirrorType::Long:
+            f.value.j = isStatic ? env->GetStaticLongField(mClass, f.id) : env->GetLongField(obj, f.id);
+            break;
+        case MirrorType::Float:
+            f.value.f = isStatic ? env->GetStaticFloatField(mClass, f.id) : env->GetFloatField(obj, f.id);
+            break;
+        case MirrorType::Double:
+            f.value.d = isStatic ? env->GetStaticDoubleField(mClass, f.id) : env->GetDoubleField(obj, f.id);
+            break;
+        case MirrorType::String: {
+            auto value = (jstring) (isStatic ? env->GetStaticObjectField(mClass, f.id)
+                                             : env->GetObjectField(obj, f.id));
+            f.isNull = value == nullptr;
+            f.utf8.clear();
+            if (value) {
+                //GetStringRegion拷贝到复用的缓冲区，再一次性转为UTF-8，不分配GetStringUTFChars的副本
+                const jsize len = env->GetStringLength(value);
+                mUtf16.resize((size_t) len);
+                env->GetStringRegion(value, 0, len, mUtf16.data());
+                f.utf8.resize((size_t) len * 3);
+                f.utf8.resize(utf16_to_utf8(mUtf16.data(), (size_t) len, &f.utf8[0]));
+                env->DeleteLocalRef(value);
+                jni_stats_add_bytes((size_t) len * sizeof(jchar));
+            }
+            break;
+        }
+    }
+    return !env->ExceptionCheck();
+}
+
+jint FieldMirror::sync(JNIEnv *env, jobject obj) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    jint written = 0;
+    for (uint64_t dirty = mDirty; dirty != 0; dirty &= dirty - 1) {
+        const auto field = (size_t) __builtin_ctzll(dirty);
+        if (!write(env, obj, mFields[field])) {
+            return -1;
+        }
+        mDirty &= ~(1ULL << field);
+        ++written;
+    }
+    return written;
+}
+
+bool FieldMirror::refresh(JNIEnv *env, jobject obj) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (Field &f : mFields) {
+        if (!read(env, obj, f)) {
+            return false;
+        }
+    }
+    mDirty = 0;
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef STUDYJNI_FIELD_MIRROR_H
+#define STUDYJNI_FIELD_MIRROR_H
+
+#include <jni.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Java对象字段的native镜像，带脏标记
+ *
+ * 以前的写法(changeName/changeAge/changeNum)：每修改一个字段就是一次完整的native调用，
+ *      并且每次都要GetObjectClass + GetFieldID/GetStaticFieldID
+ * 现在：
+ *      1.字段表(MirrorFieldSpec[])在C++中声明，create()时一次性查找好所有jfieldID
+ *      2.native代码只修改镜像中的值，值真正变化时才标记为脏，不调用JNI
+ *      3.sync()只写回脏字段，refresh()一遍读取所有字段；每帧一次JNI调用就能同步任意多次修改
+ *
+ * 线程安全：所有函数都可以在任意线程调用，内部一个mutex；sync/refresh期间持有锁
+ * refresh()会覆盖还没有sync()的修改，并清除所有脏标记
+ */
+enum class MirrorType : uint8_t {
+    Boolean,
+    Int,
+    Long,
+    Float,
+    Double,
+    String,     //镜像中存UTF-8
+};
+
+struct MirrorFieldSpec {
+    const char *name;
+    MirrorType type;
+    bool isStatic;
+};
+
+constexpr size_t kMirrorMaxFields = 64; //脏标记是一个uint64_t
+
+class FieldMirror {
+public:
+    /**
+     * @clazz: 字段所属的类，内部持有它的全局引用
+     * @return: 字段超过kMirrorMaxFields、找不到字段时返回nullptr(NoSuchFieldError挂起)
+     */
+    static FieldMirror *create(JNIEnv *env, jclass clazz, const MirrorFieldSpec *specs, size_t count);
+
+    //释放类的全局引用并delete
+    void destroy(JNIEnv *env);
+
+    FieldMirror(const FieldMirror &) = delete;
+    FieldMirror &operator=(const FieldMirror &) = delete;
+
+    size_t size() const { return mFields.size(); }
+
+    jclass clazz() const { return mClass; }
+
+    //是否有实例字段(sync/refresh需要对象)
+    bool hasInstanceFields() const { return mHasInstanceFields; }
+
+    //===================读写镜像，类型必须与字段表一致，不调用JNI===================
+    jboolean getBoolean(size_t field) const;
+    jint getInt(size_t field) const;
+    jlong getLong(size_t field) const;
+    jfloat getFloat(size_t field) const;
+    jdouble getDouble(size_t field) const;
+    //@isNull可为nullptr
+    std::string getString(size_t field, bool *isNull) const;
+
+    void setBoolean(size_t field, jboolean value);
+    void setInt(size_t field, jint value);
+    void setLong(size_t field, jlong value);
+    void setFloat(size_t field, jfloat value);
+    void setDouble(size_t field, jdouble value);
+    //@utf8为nullptr表示null
+    void setString(size_t field, const char *utf8, size_t len);
+
+    //原子地读-改-写：age += delta 之类的修改不会丢失
+    void addInt(size_t field, jint delta);
+
+    //第i位为1表示第i个字段需要写回
+    uint64_t dirtyMask() const;
+
+    /**
+     * 把脏字段写回Java，静态字段写到类上
+     * @obj: 只有静态字段时可以为null
+     * @return: 写回的字段数，失败(有Java异常挂起)返回-1，没写成功的字段仍然是脏的
+     */
+    jint sync(JNIEnv *env, jobject obj);
+
+    //读取所有字段并清除脏标记，失败返回false
+    bool refresh(JNIEnv *env, jobject obj);
+
+private:
+    struct Field {
+        MirrorFieldSpec spec;
+        jfieldID id;
+        jvalue value;       //String以外的类型
+        std::string utf8;   //String
+        bool isNull;        //String是否为null
+    };
+
+    FieldMirror() = default;
+
+    ~FieldMirror() = default;
+
+    const Field &checked(size_t field, MirrorType type) const;
+
+    Field &checked(size_t field, MirrorType type);
+
+    void markDirty(size_t field) { mDirty |= 1ULL << field; }
+
+    bool write(JNIEnv *env, jobject obj, const Field &f);
+
+    bool read(JNIEnv *env, jobject obj, Field &f);
+
+    jclass mClass = nullptr;
+    bool mHasInstanceFields = false;
+    std::vector<Field> mFields;
+    uint64_t mDirty = 0;
+    mutable std::mutex mMutex;
+    std::vector<jchar> mUtf16;  //字符串转换的缓冲区，复用
+};
+
+#endif //STUDYJNI_FIELD_MIRROR_H
@@ -0,0 +1,145 @@
+#include "graph-codec.h"
+#include <cstring>
+
+//Android的ABI都是小端，直接memcpy；大端平台需要在这里加字节交换
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "graph-codec只支持小端");
+
+static inline void put_u32(uint8_t *p, uint32_t v) { memcpy(p, &v, 4); }
+
+static inline void put_u16(uint8_t *p, uint16_t v) { memcpy(p, &v, 2); }
+
+static inline uint32_t get_u32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return v;
+}
+
+size_t ObjectGraph::poolBytes() const {
+    size_t bytes = 0;
+    for (const GraphStudent &s : students) {
+        bytes += s.hasName ? s.name.size() : 0;
+    }
+    return bytes;
+}
+
+size_t graph_encoded_size(const ObjectGraph &graph) {
+    return kGraphHeaderBytes + graph.students.size() * kGraphStudentBytes
+           + graph.persons.size() * kGraphPersonBytes + 4 + graph.poolBytes();
+}
+
+size_t graph_encode(const ObjectGraph &graph, uint8_t *out, size_t capacity) {
+    const size_t total = graph_encoded_size(graph);
+    const size_t poolBytes = graph.poolBytes();
+    if (total > capacity || poolBytes > UINT32_MAX || graph.students.size() > INT32_MAX
+        || graph.persons.size() > INT32_MAX) {
+        return 0;
+    }
+    put_u32(out, kGraphMagic);
+    put_u16(out + 4, kGraphVersion);
+    put_u16(out + 6, (uint16_t) kGraphHeaderBytes);
+    put_u32(out + 8, (uint32_t) graph.students.size());
+    put_u32(out + 12, (uint32_t) graph.persons.size());
+
+    uint8_t *record = out + kGraphHeaderBytes;
+    uint8_t *poolSize = record + graph.students.size() * kGraphStudentBytes
+                        + graph.persons.size() * kGraphPersonBytes;
+    uint8_t *pool = poolSize + 4;
+    uint32_t poolOffset = 0;
+    for (const GraphStudent &s : graph.students) {
+        put_u32(record, (uint32_t) s.age);
+        if (s.hasName) {
+            put_u32(record + 4, (uint32_t) s.name.size());
+            put_u32(record + 8, poolOffset);
+            memcpy(pool + poolOffset, s.name.data(), s.name.size());
+            poolOffset += (uint32_t) s.name.size();
+        } else {
+            put_u32(record + 4, (uint32_t) kGraphNull);
+            put_u32(record + 8, 0);
+        }
+        record += kGraphStudentBytes;
+    }
+    for (jint student : graph.persons) {
+        put_u32(record, (uint32_t) student);
+        record += kGraphPersonBytes;
+    }
+    put_u32(poolSize, poolOffset);
+    return total;
+}
+
+GraphError graph_decode(const uint8_t *data, size_t length, ObjectGraph &graph, size_t *consumed) {
+    if (length < kGraphHeaderBytes) {
+        return GraphError::Truncated;
+    }
+    if (get_u32(data) != kGraphMagic) {
+        return GraphError::BadMagic;
+    }
+    if (get_u16(data + 4) != kGraphVersion) {
+        return GraphError::BadVersion;
+    }
+    const size_t headerBytes = get_u16(data + 6);
+    const uint64_t studentCount = get_u32(data + 8);
+    const uint64_t personCount = get_u32(data + 12);
+    if (headerBytes < kGraphHeaderBytes) {
+        return GraphError::BadRecord;
+    }
+    //全部用64位计算，count来自外部数据，不能溢出
+    const uint64_t poolSizeAt = headerBytes + studentCount * kGraphStudentBytes + personCount * kGraphPersonBytes;
+    if (poolSizeAt + 4 > length) {
+        return GraphError::Truncated;
+    }
+    const uint64_t poolBytes = get_u32(data + poolSizeAt);
+    if (poolSizeAt + 4 + poolBytes > length) {
+        return GraphError::Truncated;
+    }
+    const uint8_t *pool = data + poolSizeAt + 4;
+
+    graph.students.resize((size_t) studentCount);
+    graph.persons.resize((size_t) personCount);
+    const uint8_t *record = data + headerBytes;
+    for (GraphStudent &s : graph.students) {
+        s.age = (jint) get_u32(record);
+        auto nameLength = (jint) get_u32(record + 4);
+        uint32_t nameOffset = get_u32(record + 8);
+        if (nameLength == kGraphNull) {
+            s.hasName = false;
+            s.name.clear();
+        } else if (nameLength < 0 || (uint64_t) nameOffset + (uint64_t) nameLength > poolBytes) {
+            return GraphError::BadRecord;
+        } else {
+            s.hasName = true;
+            s.name.assign(reinterpret_cast<const char *>(pool + nameOffset), (size_t) nameLength);
+        }
+        record += kGraphStudentBytes;
+    }
+    for (jint &student : graph.persons) {
+        student = (jint) get_u32(record);
+        if (student != kGraphNull && (student < 0 || (uint64_t) student >= studentCount)) {
+            return GraphError::BadRecord;
+        }
+        record += kGraphPersonBytes;
+    }
+    *consumed = (size_t) (poolSizeAt + 4 + poolBytes);
+    return GraphError::Ok;
+}
+
+const char *graph_error_message(GraphError error) {
+    switch (error) {
+        case GraphError::Ok:
+            return "ok";
+        case GraphError::Truncated:
+            return "数据不完整";
+        case GraphError::BadMagic:
+            return "magic不对，不是对象图";
+        case GraphError::BadVersion:
+            return "不支持的版本";
+        case GraphError::BadRecord:
+            return "记录越界";
+    }
+    return "未知错误";
+}
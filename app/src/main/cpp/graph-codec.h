@@ -0,0 +1,74 @@
+#ifndef STUDYJNI_GRAPH_CODEC_H
+#define STUDYJNI_GRAPH_CODEC_H
+
+#include <jni.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Person ---> Student 对象图的扁平二进制编码，native与Java之间通过DirectByteBuffer一次性传递整个对象图
+ *
+ * 以前的写法(insertObject)：AllocObject之后逐个字段调用Java的setter，
+ *      setName、setAge、setStudent、putStudent 每个字段一次JNI上行调用(每个setter还要打一次日志)
+ * 现在：native把整个对象图编码到DirectByteBuffer中，只有一次JNI调用；
+ *      Java(GraphCodec.decode)一遍扫描直接写public字段，没有任何逐字段的JNI调用。反方向同理
+ *
+ * 格式(小端，所有偏移相对于对象图的起始位置)：
+ *      header   16字节：u32 magic | u16 version | u16 headerSize | u32 studentCount | u32 personCount
+ *      students studentCount * 12字节：i32 age | i32 nameLength(-1表示null) | u32 nameOffset(相对于字符串池)
+ *      persons  personCount * 4字节：i32 student(students的下标，-1表示null)
+ *      pool     u32 poolSize | poolSize字节的UTF-8
+ *
+ * 1.Student是定长记录，可以随机访问；多个Person可以指向同一个Student，解码后仍然是同一个对象
+ * 2.version是格式的主版本，不兼容的修改才加1，解码时不认识的版本直接拒绝；
+ *   headerSize之后可以追加字段，旧的解码器按headerSize跳过
+ * 3.字符串是标准UTF-8；单独出现的代理项(不成对的UTF-16)在Java端会被替换为U+FFFD
+ */
+constexpr uint32_t kGraphMagic = 0x47524A53; //"SJRG"
+constexpr uint16_t kGraphVersion = 1;
+constexpr size_t kGraphHeaderBytes = 16;
+constexpr size_t kGraphStudentBytes = 12;
+constexpr size_t kGraphPersonBytes = 4;
+constexpr jint kGraphNull = -1;
+
+struct GraphStudent {
+    jint age = 0;
+    bool hasName = false;
+    std::string name;   //UTF-8
+};
+
+struct ObjectGraph {
+    std::vector<GraphStudent> students;
+    std::vector<jint> persons;  //每个Person的student下标，kGraphNull表示null
+
+    size_t poolBytes() const;
+};
+
+//与GraphCodec.java一致
+enum class GraphError : jint {
+    Ok = 0,
+    Truncated = 1,      //数据不完整
+    BadMagic = 2,
+    BadVersion = 3,
+    BadRecord = 4,      //名字越界、student下标越界
+};
+
+//编码后的字节数
+size_t graph_encoded_size(const ObjectGraph &graph);
+
+/**
+ * @capacity: out的大小，小于graph_encoded_size()时不写入任何数据
+ * @return: 写入的字节数，空间不足返回0
+ */
+size_t graph_encode(const ObjectGraph &graph, uint8_t *out, size_t capacity);
+
+/**
+ * @consumed: 成功时写入对象图占用的字节数(可以紧跟着下一个对象图)
+ */
+GraphError graph_decode(const uint8_t *data, size_t length, ObjectGraph &graph, size_t *consumed);
+
+const char *graph_error_message(GraphError error);
+
+#endif //STUDYJNI_GRAPH_CODEC_H
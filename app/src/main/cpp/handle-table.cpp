@@ -0,0 +1,185 @@
+#include "handle-table.h"
+#include "jni-log.h"
+
+static inline jlong make_handle(uint32_t generation, size_t index) {
+    return (jlong) (((uint64_t) generation << 32) | (uint64_t) (index + 1));
+}
+
+//句柄中的下标，0(非法句柄)返回kHandleCapacity
+static inline size_t index_of(jlong handle) {
+    auto low = (uint32_t) (uint64_t) handle;
+    return low == 0 || low > kHandleCapacity ? kHandleCapacity : low - 1;
+}
+
+HandleTable &HandleTable::instance() {
+    //不释放：工作线程可能在静态对象析构之后还在查找
+    static auto *table = new HandleTable();
+    return *table;
+}
+
+HandleTable::Slot *HandleTable::slot_at(size_t index) const {
+    Page *page = mPages[index / kHandlePageSlots].load(std::memory_order_acquire);
+    return page ? &page->slots[index % kHandlePageSlots] : nullptr;
+}
+
+jlong HandleTable::put(JNIEnv *env, jobject obj, HandleKind kind) {
+    if (!obj) {
+        return 0;
+    }
+    const bool weak = kind == HandleKind::Weak;
+    jobject ref = weak ? env->NewWeakGlobalRef(obj) : env->NewGlobalRef(obj);
+    if (!ref) {
+        return 0;
+    }
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mFreeList.empty()) {
+            index = mFreeList.back();
+            mFreeList.pop_back();
+        } else if (mSlots < kHandleCapacity) {
+            index = mSlots;
+            const size_t pageIndex = index / kHandlePageSlots;
+            if (!mPages[pageIndex].load(std::memory_order_relaxed)) {
+                //页只在这里创建，release保证查找的线程看到的是构造完成的页
+                mPages[pageIndex].store(new Page(), std::memory_order_release);
+            }
+            ++mSlots;
+        } else {
+            index = kHandleCapacity;
+        }
+    }
+    if (index == kHandleCapacity) {
+        LOGE("HandleTable: 句柄已满(%zu)", kHandleCapacity)
+        weak ? env->DeleteWeakGlobalRef(ref) : env->DeleteGlobalRef(ref);
+        return 0;
+    }
+    Slot *slot = slot_at(index);
+    //槽位无效且没有pin，别的线程不会读写ref
+    slot->ref = ref;
+    const uint64_t generation = slot->state.load(std::memory_order_relaxed) >> 32;
+    slot->state.store((generation << 32) | kLiveBit | (weak ? kWeakBit : 0), std::memory_order_release);
+    (weak ? mLiveWeak : mLiveStrong).fetch_add(1, std::memory_order_relaxed);
+    mCreated.fetch_add(1, std::memory_order_relaxed);
+    return make_handle((uint32_t) generation, index);
+}
+
+HandleTable::Slot *HandleTable::pin(jlong handle) {
+    const size_t index = index_of(handle);
+    Slot *slot = index < kHandleCapacity ? slot_at(index) : nullptr;
+    if (slot) {
+        const auto generation = (uint32_t) ((uint64_t) handle >> 32);
+        uint64_t state = slot->state.load(std::memory_order_acquire);
+        //generation对不上、已经remove()，都不能再pin
+        while (generation_of(state) == generation && (state & kLiveBit)) {
+            if ((state & kPinMask) == kPinMask) {
+                LOGE("HandleTable: pin计数溢出")
+                break;
+            }
+            if (slot->state.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+                return slot;
+            }
+        }
+    }
+    mStaleLookups.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void HandleTable::unpin(JNIEnv *env, jlong handle, Slot *slot) {
+    uint64_t state = slot->state.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    //最后一个pin，并且期间已经remove()：由这个线程回收
+    if ((state & (kLiveBit | kPinMask)) == 0) {
+        recycle(env, slot, index_of(handle), state);
+    }
+}
+
+jobject HandleTable::newLocal(JNIEnv *env, jlong handle) {
+    Slot *slot = pin(handle);
+    if (!slot) {
+        return nullptr;
+    }
+    //弱引用的对象已被回收时，NewLocalRef返回nullptr；强引用返回nullptr只可能是内存不足，不计数
+    jobject local = env->NewLocalRef(slot->ref);
+    if (!local && is_weak(slot->state.load(std::memory_order_relaxed))) {
+        mClearedWeak.fetch_add(1, std::memory_order_relaxed);
+    }
+    unpin(env, handle, slot);
+    return local;
+}
+
+bool HandleTable::remove(JNIEnv *env, jlong handle) {
+    const size_t index = index_of(handle);
+    Slot *slot = index < kHandleCapacity ? slot_at(index) : nullptr;
+    if (!slot) {
+        return false;
+    }
+    const auto generation = (uint32_t) ((uint64_t) handle >> 32);
+    uint64_t state = slot->state.load(std::memory_order_acquire);
+    for (;;) {
+        if (generation_of(state) != generation || !(state & kLiveBit)) {
+            return false; //重复释放
+        }
+        if (slot->state.compare_exchange_weak(state, state & ~kLiveBit, std::memory_order_acq_rel)) {
+            break;
+        }
+    }
+    mRemoved.fetch_add(1, std::memory_order_relaxed);
+    //还有pin时，由最后一个unpin的线程回收
+    if ((state & kPinMask) == 0) {
+        recycle(env, slot, index, state & ~kLiveBit);
+    }
+    return true;
+}
+
+void HandleTable::recycle(JNIEnv *env, Slot *slot, size_t index, uint64_t state) {
+    const bool weak = is_weak(state);
+    weak ? env->DeleteWeakGlobalRef(slot->ref) : env->DeleteGlobalRef(slot->ref);
+    slot->ref = nullptr;
+    //generation加1，旧句柄从此对不上(32位回绕需要同一个槽位复用2^32次)
+    const uint32_t next = generation_of(state) + 1;
+    slot->state.store((uint64_t) next << 32, std::memory_order_release);
+    (weak ? mLiveWeak : mLiveStrong).fetch_sub(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFreeList.push_back((uint32_t) index);
+}
+
+bool HandleTable::valid(jlong handle) const {
+    const size_t index = index_of(handle);
+    Slot *slot = index < kHandleCapacity ? slot_at(index) : nullptr;
+    if (!slot) {
+        return false;
+    }
+    uint64_t state = slot->state.load(std::memory_order_acquire);
+    return generation_of(state) == (uint32_t) ((uint64_t) handle >> 32) && (state & kLiveBit);
+}
+
+size_t HandleTable::removeAll(JNIEnv *env) {
+    size_t slots;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        slots = mSlots;
+    }
+    size_t count = 0;
+    for (size_t index = 0; index < slots; ++index) {
+        uint64_t state = slot_at(index)->state.load(std::memory_order_acquire);
+        if ((state & kLiveBit) && remove(env, make_handle(generation_of(state), index))) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+HandleStats HandleTable::stats() const {
+    HandleStats s;
+    s.liveStrong = mLiveStrong.load(std::memory_order_relaxed);
+    s.liveWeak = mLiveWeak.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        s.slots = mSlots;
+    }
+    s.created = mCreated.load(std::memory_order_relaxed);
+    s.removed = mRemoved.load(std::memory_order_relaxed);
+    s.staleLookups = mStaleLookups.load(std::memory_order_relaxed);
+    s.clearedWeak = mClearedWeak.load(std::memory_order_relaxed);
+    return s;
+}
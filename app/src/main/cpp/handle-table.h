@@ -0,0 +1,150 @@
+#ifndef STUDYJNI_HANDLE_TABLE_H
+#define STUDYJNI_HANDLE_TABLE_H
+
+#include <jni.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * native持有的Java对象的句柄表
+ *
+ * 以前：native直接保存NewGlobalRef返回的jobject(e.g: MyContext::instance，每次nativeThread都新建一个)，
+ *      数量没有上限、也没有统计；释放之后再使用(testQuote/deleteQuote中的崩溃)无法检测，直接崩溃
+ * 现在：
+ *      1.对象以强/弱全局引用保存在连续的槽位数组中，native和Java只拿到64位的句柄：
+ *          handle = (generation << 32) | (index + 1)，0永远不是合法句柄
+ *      2.槽位每次回收generation加1，旧句柄的generation对不上，查找时返回失败(并计数)，而不是崩溃
+ *      3.查找是O(1)且无锁的：槽位的状态(generation、是否有效、是否弱引用、pin计数)在一个64位原子变量中，
+ *        查找时CAS把pin计数加1，使用完再减1；只有创建、回收槽位时才加锁
+ *      4.remove()只清除有效标记，最后一个pin释放时才DeleteGlobalRef，正在使用的引用不会被别的线程删掉
+ *      5.槽位按页(kHandlePageSlots)分配，页只增不减，内存上限是同时存在的句柄数的最大值；
+ *        回收的槽位优先复用，长时间运行全局引用表也不会增长
+ *
+ * 弱引用：对象被GC回收后查找返回nullptr(句柄本身仍然有效，要remove()才回收槽位)
+ */
+constexpr size_t kHandlePageSlots = 1024;
+constexpr size_t kHandleMaxPages = 256;     //最多262144个句柄，远小于ART全局引用表的上限
+constexpr size_t kHandleCapacity = kHandlePageSlots * kHandleMaxPages;
+
+//与NativeHandles.java一致
+enum class HandleKind : jint {
+    Strong = 0,
+    Weak = 1,
+};
+
+struct HandleStats {
+    uint64_t liveStrong = 0;    //当前有效的强引用句柄数
+    uint64_t liveWeak = 0;      //当前有效的弱引用句柄数
+    uint64_t slots = 0;         //已分配的槽位数(最大同时存在的句柄数)
+    uint64_t created = 0;
+    uint64_t removed = 0;
+    uint64_t staleLookups = 0;  //用已经回收(或者根本不存在)的句柄查找的次数
+    uint64_t clearedWeak = 0;   //查找时弱引用的对象已被GC回收的次数
+};
+
+class HandleTable {
+public:
+    static HandleTable &instance();
+
+    /**
+     * @obj: 任意引用(局部、全局)，内部自己创建全局引用
+     * @return: 句柄；obj为null、表满、创建全局引用失败时返回0
+     */
+    jlong put(JNIEnv *env, jobject obj, HandleKind kind);
+
+    /**
+     * 返回新的局部引用，调用者负责DeleteLocalRef(或者交给jni::LocalRef)
+     * 句柄无效、弱引用的对象已被回收时返回nullptr
+     */
+    jobject newLocal(JNIEnv *env, jlong handle);
+
+    /**
+     * 不创建局部引用，在pin住槽位期间调用fn(jobject)，fn返回后才可能DeleteGlobalRef
+     * 弱引用会临时转为局部引用；句柄无效、对象已回收时不调用fn，返回false
+     */
+    template<typename Fn>
+    bool with(JNIEnv *env, jlong handle, Fn &&fn) {
+        Slot *slot = pin(handle);
+        if (!slot) {
+            return false;
+        }
+        bool called = false;
+        if (is_weak(slot->state.load(std::memory_order_relaxed))) {
+            jobject local = env->NewLocalRef(slot->ref);
+            if (local) {
+                fn(local);
+                env->DeleteLocalRef(local);
+                called = true;
+            } else {
+                mClearedWeak.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            fn(slot->ref);
+            called = true;
+        }
+        unpin(env, handle, slot);
+        return called;
+    }
+
+    //释放句柄，返回false表示句柄已经无效(重复释放)
+    bool remove(JNIEnv *env, jlong handle);
+
+    //句柄是否有效(不检查弱引用的对象是否已被回收)
+    bool valid(jlong handle) const;
+
+    //释放所有句柄，返回释放的个数(JNI_OnUnload)
+    size_t removeAll(JNIEnv *env);
+
+    HandleStats stats() const;
+
+private:
+    /**
+     * state: [63..32] generation | [31] 有效 | [30] 弱引用 | [29..0] pin计数
+     * ref只在槽位无效且pin计数为0时写入，有效期间只读
+     */
+    struct Slot {
+        std::atomic<uint64_t> state{0};
+        jobject ref = nullptr;
+    };
+
+    struct Page {
+        Slot slots[kHandlePageSlots];
+    };
+
+    static constexpr uint64_t kLiveBit = 1ULL << 31;
+    static constexpr uint64_t kWeakBit = 1ULL << 30;
+    static constexpr uint64_t kPinMask = kWeakBit - 1;
+
+    static bool is_weak(uint64_t state) { return (state & kWeakBit) != 0; }
+
+    static uint32_t generation_of(uint64_t state) { return (uint32_t) (state >> 32); }
+
+    HandleTable() = default;
+
+    Slot *slot_at(size_t index) const;
+
+    //句柄有效时pin计数加1并返回槽位
+    Slot *pin(jlong handle);
+
+    void unpin(JNIEnv *env, jlong handle, Slot *slot);
+
+    //有效标记、pin计数都清零之后，由做最后一次修改的线程调用
+    void recycle(JNIEnv *env, Slot *slot, size_t index, uint64_t state);
+
+    std::atomic<Page *> mPages[kHandleMaxPages]{};
+    mutable std::mutex mMutex;          //只保护下面两个成员
+    std::vector<uint32_t> mFreeList;    //回收的槽位，后进先出(刚释放的槽位更可能还在缓存中)
+    size_t mSlots = 0;
+
+    std::atomic<uint64_t> mLiveStrong{0};
+    std::atomic<uint64_t> mLiveWeak{0};
+    std::atomic<uint64_t> mCreated{0};
+    std::atomic<uint64_t> mRemoved{0};
+    std::atomic<uint64_t> mStaleLookups{0};
+    std::atomic<uint64_t> mClearedWeak{0};
+};
+
+#endif //STUDYJNI_HANDLE_TABLE_H
@@ -0,0 +1,109 @@
+#include "jni-cache.h"
+#include "jni-log.h"
+#include <atomic>
+
+static JniCache sCache;
+static std::atomic<bool> sReady(false);
+
+//FindClass得到的是局部引用，必须提升为全局引用才能跨函数、跨线程使用
+template<typename Tag>
+static jclass find_global_class(JNIEnv *env) {
+    jclass localClass = env->FindClass(Tag::kName);
+    if (!localClass) {
+        env->ExceptionClear();
+        LOGE("JniCache: FindClass失败 %s", Tag::kName)
+        return nullptr;
+    }
+    auto globalClass = (jclass) env->NewGlobalRef(localClass);
+    env->DeleteLocalRef(localClass);
+    return globalClass;
+}
+
+//签名由Id的类型在编译期生成，不再手写
+template<typename Id>
+static bool find_id(JNIEnv *env, jclass clazz, const char *name, Id &out) {
+    out = Id::lookup(env, clazz, name);
+    if (!out) {
+        env->ExceptionClear();
+        LOGE("JniCache: 找不到 %s %s", name, Id::kSignature.c_str())
+        return false;
+    }
+    return true;
+}
+
+bool jni_cache_init(JNIEnv *env) {
+    JniCache &c = sCache;
+
+    c.mainActivityClass = find_global_class<MainActivityClass>(env);
+    c.studentClass = find_global_class<StudentClass>(env);
+    c.personClass = find_global_class<PersonClass>(env);
+    c.dogClass = find_global_class<DogClass>(env);
+    c.stringClass = find_global_class<StringClass>(env);
+    c.eventListenerClass = find_global_class<EventListenerClass>(env);
+    c.nativeAsyncClass = find_global_class<NativeAsyncClass>(env);
+    if (!c.mainActivityClass || !c.studentClass || !c.personClass || !c.dogClass || !c.stringClass
+        || !c.eventListenerClass || !c.nativeAsyncClass) {
+        jni_cache_release(env);
+        return false;
+    }
+
+    bool ok = true;
+    ok &= find_id(env, c.mainActivityClass, "name", c.mainNameFid);
+    ok &= find_id(env, c.mainActivityClass, "age", c.mainAgeFid);
+    ok &= find_id(env, c.mainActivityClass, "num", c.mainNumFid);
+    ok &= find_id(env, c.mainActivityClass, "add", c.mainAddMid);
+    ok &= find_id(env, c.mainActivityClass, "showString", c.mainShowStringMid);
+    ok &= find_id(env, c.mainActivityClass, "updateActivityUI", c.mainUpdateUIMid);
+
+    ok &= find_id(env, c.studentClass, "name", c.studentNameFid);
+    ok &= find_id(env, c.studentClass, "age", c.studentAgeFid);
+    ok &= find_id(env, c.studentClass, "toString", c.studentToStringMid);
+    ok &= find_id(env, c.studentClass, "setName", c.studentSetNameMid);
+    ok &= find_id(env, c.studentClass, "getName", c.studentGetNameMid);
+    ok &= find_id(env, c.studentClass, "setAge", c.studentSetAgeMid);
+    ok &= find_id(env, c.studentClass, "getAge", c.studentGetAgeMid);
+    ok &= find_id(env, c.studentClass, "showInfo", c.studentShowInfoMid);
+
+    ok &= find_id(env, c.personClass, "student", c.personStudentFid);
+    ok &= find_id(env, c.personClass, "setStudent", c.personSetStudentMid);
+    ok &= find_id(env, c.personClass, "putStudent", c.personPutStudentMid);
+
+    //<init> == 构造函数名
+    ok &= find_id(env, c.dogClass, "<init>", c.dogInitMid);
+    ok &= find_id(env, c.dogClass, "<init>", c.dogInitIMid);
+    ok &= find_id(env, c.dogClass, "<init>", c.dogInitIIMid);
+
+    ok &= find_id(env, c.eventListenerClass, "onEvents", c.eventListenerOnEventsMid);
+
+    ok &= find_id(env, c.nativeAsyncClass, "onCompleted", c.nativeAsyncOnCompletedMid);
+
+    if (!ok) {
+        jni_cache_release(env);
+        return false;
+    }
+
+    //release语义：保证其它线程看到sReady == true时，也能看到上面写入的所有ID
+    sReady.store(true, std::memory_order_release);
+    return true;
+}
+
+void jni_cache_release(JNIEnv *env) {
+    sReady.store(false, std::memory_order_release);
+    JniCache &c = sCache;
+    jclass classes[] = {c.mainActivityClass, c.studentClass, c.personClass, c.dogClass, c.stringClass,
+                         c.eventListenerClass, c.nativeAsyncClass};
+    for (jclass clazz : classes) {
+        if (clazz) {
+            env->DeleteGlobalRef(clazz);
+        }
+    }
+    c = JniCache(); //全部重置为nullptr，防止悬空
+}
+
+bool jni_cache_ready() {
+    return sReady.load(std::memory_order_acquire);
+}
+
+const JniCache &jni_cache() {
+    return sCache;
+}
@@ -0,0 +1,106 @@
+#ifndef STUDYJNI_JNI_CACHE_H
+#define STUDYJNI_JNI_CACHE_H
+
+#include <jni.h>
+#include "jni-typed.h"
+
+/**
+ * JNI ID缓存：
+ *      FindClass、GetMethodID、GetFieldID 都是按字符串去查找的，每次调用都要付出查找的开销。
+ *      而jclass(提升为全局引用后)、jmethodID、jfieldID 在类不被卸载的前提下是一直有效的，
+ *      所以在 JNI_OnLoad 中一次性查找好，所有JNI函数直接复用即可。
+ *
+ * 线程安全：
+ *      所有成员只在 JNI_OnLoad 中写入一次，之后只读，任何线程都可以直接读取；
+ *      JNI_OnUnload 时先标记失效，再释放全局引用。
+ */
+//Java类的标签类型，用于jni-typed.h在编译期生成签名
+struct MainActivityClass {
+    static constexpr char kName[] = "com/sawyer/studyjni/MainActivity";
+};
+struct StudentClass {
+    static constexpr char kName[] = "com/sawyer/studyjni/Student";
+};
+struct PersonClass {
+    static constexpr char kName[] = "com/sawyer/studyjni/Person";
+};
+struct DogClass {
+    static constexpr char kName[] = "com/sawyer/studyjni/Dog";
+};
+struct StringClass {
+    static constexpr char kName[] = "java/lang/String";
+};
+struct EventListenerClass {
+    static constexpr char kName[] = "com/sawyer/studyjni/NativeEventDispatcher$Listener";
+};
+struct NativeAsyncClass {
+    static constexpr char kName[] = "com/sawyer/studyjni/NativeAsync";
+};
+struct ByteBufferClass {
+    static constexpr char kName[] = "java/nio/ByteBuffer";
+};
+
+using StudentObject = jni::Object<StudentClass>;
+
+/**
+ * 方法、属性都用jni-typed.h的类型包装：签名由C++类型在编译期生成，调用时自动选择Call<Type>Method
+ * 它们可以隐式转换为jmethodID/jfieldID，也可以直接传给原始的JNI函数
+ */
+struct JniCache {
+    //com.sawyer.studyjni.MainActivity
+    jclass mainActivityClass = nullptr;
+    jni::Field<jstring> mainNameFid;                              //String name
+    jni::StaticField<jint> mainAgeFid;                            //static int age
+    jni::Field<jdouble> mainNumFid;                               //final double num
+    jni::Method<jint(jint, jint)> mainAddMid;                     //int add(int, int)
+    jni::Method<jstring(jstring, jint)> mainShowStringMid;        //String showString(String, int)
+    jni::Method<void()> mainUpdateUIMid;                          //void updateActivityUI()
+
+    //com.sawyer.studyjni.Student
+    jclass studentClass = nullptr;
+    jni::Field<jstring> studentNameFid;                           //String name
+    jni::Field<jint> studentAgeFid;                               //int age
+    jni::Method<jstring()> studentToStringMid;
+    jni::Method<void(jstring)> studentSetNameMid;
+    jni::Method<jstring()> studentGetNameMid;
+    jni::Method<void(jint)> studentSetAgeMid;
+    jni::Method<jint()> studentGetAgeMid;
+    jni::StaticMethod<void(jstring)> studentShowInfoMid;          //static void showInfo(String)
+
+    //com.sawyer.studyjni.Person
+    jclass personClass = nullptr;
+    jni::Field<StudentObject> personStudentFid;                   //Student student
+    jni::Method<void(StudentObject)> personSetStudentMid;
+    jni::StaticMethod<void(StudentObject)> personPutStudentMid;   //static void putStudent(Student)
+
+    //com.sawyer.studyjni.Dog
+    jclass dogClass = nullptr;
+    jni::Constructor<> dogInitMid;                                //Dog()
+    jni::Constructor<jint> dogInitIMid;                           //Dog(int)
+    jni::Constructor<jint, jint> dogInitIIMid;                    //Dog(int, int)
+
+    //java.lang.String
+    jclass stringClass = nullptr;
+
+    //com.sawyer.studyjni.NativeEventDispatcher.Listener
+    jclass eventListenerClass = nullptr;
+    jni::Method<void(jlongArray)> eventListenerOnEventsMid;      //void onEvents(long[])
+
+    //com.sawyer.studyjni.NativeAsync
+    jclass nativeAsyncClass = nullptr;
+    jni::StaticMethod<void(jlongArray)> nativeAsyncOnCompletedMid; //static void onCompleted(long[])
+};
+
+//在JNI_OnLoad中调用，查找失败返回false
+bool jni_cache_init(JNIEnv *env);
+
+//在JNI_OnUnload中调用，释放所有全局引用
+void jni_cache_release(JNIEnv *env);
+
+//缓存是否可用
+bool jni_cache_ready();
+
+//获取缓存，必须在jni_cache_init()成功之后调用
+const JniCache &jni_cache();
+
+#endif //STUDYJNI_JNI_CACHE_H
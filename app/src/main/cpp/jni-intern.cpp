@@ -0,0 +1,82 @@
+#include "jni-intern.h"
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "string-batch.h"
+
+namespace {
+
+//只有创建、释放时才会加锁
+struct InternPool {
+    std::mutex mutex;
+    std::unordered_map<std::string, jstring> strings; //内容 ---> 全局引用
+    InternSlot *slots = nullptr;
+};
+
+//不释放：InternSlot是局部静态变量，不能依赖全局对象的析构顺序
+InternPool &pool() {
+    static auto *instance = new InternPool();
+    return *instance;
+}
+
+//标准UTF-8 ---> UTF-16 ---> jstring(局部引用)
+jstring new_string_from_utf8(JNIEnv *env, const char *utf8, size_t len) {
+    std::vector<jchar> utf16(len); //UTF-16的字符数不会超过UTF-8的字节数
+    size_t chars = utf8_to_utf16(utf8, len, utf16.data());
+    return env->NewString(utf16.data(), (jsize) chars);
+}
+
+} //namespace
+
+jstring InternSlot::create(JNIEnv *env) {
+    InternPool &p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    jstring value = mValue.load(std::memory_order_relaxed);
+    if (value) {
+        return value; //其它线程已经创建
+    }
+    std::string key(mUtf8, mLen);
+    auto it = p.strings.find(key);
+    if (it != p.strings.end()) {
+        value = it->second;
+    } else {
+        jstring local = new_string_from_utf8(env, key.data(), key.size());
+        if (!local) {
+            return nullptr;
+        }
+        value = (jstring) env->NewGlobalRef(local);
+        env->DeleteLocalRef(local);
+        if (!value) {
+            return nullptr;
+        }
+        p.strings.emplace(std::move(key), value);
+    }
+    mNext = p.slots;
+    p.slots = this;
+    mValue.store(value, std::memory_order_release);
+    return value;
+}
+
+void jni_intern_release(JNIEnv *env) {
+    InternPool &p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    for (InternSlot *slot = p.slots; slot;) {
+        InternSlot *next = slot->mNext;
+        slot->mValue.store(nullptr, std::memory_order_relaxed);
+        slot->mNext = nullptr;
+        slot = next;
+    }
+    p.slots = nullptr;
+    for (auto &entry : p.strings) {
+        env->DeleteGlobalRef(entry.second);
+    }
+    p.strings.clear();
+}
+
+size_t jni_intern_count() {
+    InternPool &p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    return p.strings.size();
+}
@@ -0,0 +1,67 @@
+#ifndef STUDYJNI_JNI_INTERN_H
+#define STUDYJNI_JNI_INTERN_H
+
+#include <jni.h>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * C++字符串常量 ---> jstring 的常量池
+ *
+ * 以前的写法：每次调用都 NewStringUTF("kobe")，每次都要解码UTF-8、在Java堆上分配一个新String，
+ *      用完再DeleteLocalRef，产生的垃圾要GC回收
+ * 现在：
+ *      jstring name = JNI_INTERN(env, "kobe");
+ *      1.每个调用点一个静态的InternSlot，第一次调用时创建jstring并提升为全局引用，之后只是一次原子读
+ *      2.内容相同的字面量(不同调用点)共用同一个全局引用
+ *      3.JNI_OnUnload时调用jni_intern_release()统一释放
+ *
+ * 编码：C++源文件中的字面量是标准UTF-8，而NewStringUTF要求Modified UTF-8
+ *      (补充平面字符要编码为两个3字节的代理项，'\0'要编码为C0 80)，直接传入可能得到乱码甚至崩溃(CheckJNI)，
+ *      所以先转换为UTF-16再NewString，见string-batch.h的utf8_to_utf16
+ *
+ * 注意：返回的是全局引用，不能DeleteLocalRef；作为native函数的返回值时，用NewLocalRef转为局部引用
+ */
+class InternSlot {
+public:
+    //@len: 字节数，字面量中间可以有'\0'
+    constexpr InternSlot(const char *utf8, size_t len) : mUtf8(utf8), mLen(len) {}
+
+    InternSlot(const InternSlot &) = delete;
+
+    InternSlot &operator=(const InternSlot &) = delete;
+
+    //失败(OutOfMemoryError挂起)返回nullptr
+    jstring get(JNIEnv *env) {
+        jstring value = mValue.load(std::memory_order_acquire);
+        return value ? value : create(env);
+    }
+
+private:
+    friend void jni_intern_release(JNIEnv *env);
+
+    jstring create(JNIEnv *env);
+
+    const char *mUtf8;
+    size_t mLen;
+    std::atomic<jstring> mValue{nullptr};
+    InternSlot *mNext = nullptr; //已创建的InternSlot组成的链表，释放时用
+};
+
+//释放所有全局引用，并把所有InternSlot重置为未创建。只能在没有其它JNI调用时执行(JNI_OnUnload)
+void jni_intern_release(JNIEnv *env);
+
+//常量池中jstring的个数(内容相同的只算一个)
+size_t jni_intern_count();
+
+/**
+ * 只接受字符串字面量("" literal "" 对变量会编译失败)
+ * InternSlot的构造函数是constexpr的，slot在编译期完成初始化，没有局部静态变量的线程安全检查
+ */
+#define JNI_INTERN(env, literal)                                          \
+    ([](JNIEnv *internEnv) -> jstring {                                   \
+        static InternSlot internSlot("" literal "", sizeof(literal) - 1); \
+        return internSlot.get(internEnv);                                 \
+    }(env))
+
+#endif //STUDYJNI_JNI_INTERN_H
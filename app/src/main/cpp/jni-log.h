@@ -0,0 +1,19 @@
+#ifndef STUDYJNI_JNI_LOG_H
+#define STUDYJNI_JNI_LOG_H
+
+/**
+ * 日志输出，所有cpp文件共用
+ *
+ * 以前：直接 __android_log_print，在调用线程上同步格式化、写logcat，Release版本也无法去掉
+ * 现在：转发到trace-log.h：
+ *      低于STUDYJNI_LOG_LEVEL的级别在编译期被去掉(Release默认只保留LOGE)；
+ *      其余的只在调用线程写一条二进制记录，由后台线程格式化后输出到logcat(或文件)
+ */
+#include <android/log.h>
+#include "trace-log.h"
+#define TAG "lee"
+#define LOGD(...) TRACE_D(__VA_ARGS__);
+#define LOGI(...) TRACE_I(__VA_ARGS__);
+#define LOGE(...) TRACE_E(__VA_ARGS__);
+
+#endif //STUDYJNI_JNI_LOG_H
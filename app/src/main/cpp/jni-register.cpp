@@ -0,0 +1,75 @@
+#include "jni-register.h"
+#include "jni-log.h"
+
+static const NativeTable *const kAllTables[] = {
+        &kMainActivityNatives,
+        &kSecondActivityNatives,
+        &kNativeArraysNatives,
+        &kSharedRingNatives,
+        &kNativeStringsNatives,
+        &kStudentStoreNatives,
+        &kNativeEventDispatcherNatives,
+        &kDogFactoryNatives,
+        &kNativeStatsNatives,
+        &kNativeAsyncNatives,
+        &kParallelArraysNatives,
+        &kMappedFileNatives,
+        &kNativeHandlesNatives,
+        &kGraphCodecNatives,
+        &kFieldMirrorNatives,
+};
+
+//整张表注册失败时逐个重试，输出所有出错的函数(而不只是第一个)
+static void report_failed_methods(JNIEnv *env, jclass clazz, const NativeTable &table) {
+    for (jint i = 0; i < table.count; ++i) {
+        const JNINativeMethod &method = table.methods[i];
+        if (env->RegisterNatives(clazz, &method, 1) != JNI_OK) {
+            env->ExceptionClear();
+            LOGE("RegisterNatives失败：%s.%s%s", table.className, method.name, method.signature)
+        }
+    }
+}
+
+static bool register_table(JNIEnv *env, const NativeTable &table) {
+    jclass clazz = env->FindClass(table.className);
+    if (!clazz) {
+        env->ExceptionClear();
+        LOGE("RegisterNatives失败：找不到类 %s", table.className)
+        return false;
+    }
+    /**
+     * api:jint RegisterNatives(jclass clazz, const JNINativeMethod* methods,jint nMethods)
+     * 作用：一次性可动态注册多个JNI函数，有一个函数找不到(函数名、签名不对)就返回JNI_ERR并抛出NoSuchMethodError
+     */
+    bool ok = env->RegisterNatives(clazz, table.methods, table.count) == JNI_OK;
+    if (!ok) {
+        env->ExceptionClear();
+        report_failed_methods(env, clazz, table);
+    }
+    env->DeleteLocalRef(clazz);
+    //统计中显示为"类名.函数名"
+    for (jint i = 0; i < table.count; ++i) {
+        jni_stats_set_class(table.methods[i].fnPtr, table.className);
+    }
+    return ok;
+}
+
+bool register_all_natives(JNIEnv *env, jint *methodCount) {
+    bool ok = true;
+    jint count = 0;
+    //不在第一个失败时返回，一次输出所有错误
+    for (const NativeTable *table : kAllTables) {
+        if (register_table(env, *table)) {
+            count += table->count;
+        } else {
+            ok = false;
+        }
+    }
+    if (ok && methodCount) {
+        *methodCount = count;
+    }
+    if (int dropped = jni_stats_dropped()) {
+        LOGE("jni-stats: 入口超过kStatsMaxEntries(%d)，%d个native函数没有统计", kStatsMaxEntries, dropped)
+    }
+    return ok;
+}
@@ -0,0 +1,123 @@
+#ifndef STUDYJNI_JNI_REGISTER_H
+#define STUDYJNI_JNI_REGISTER_H
+
+#include <jni.h>
+#include <cstddef>
+#include "jni-stats.h"
+#include "jni-typed.h"
+
+/**
+ * native函数的动态注册表
+ *
+ * 以前：除了dynamicJavaMethod01/02，其余native函数都是静态注册(Java_包名_类名_函数名)，
+ *      第一次调用时虚拟机才去so的符号表中按名字查找；这些符号全部导出，so更大，加载时的重定位也更多
+ * 现在：
+ *      1.每个Java类一张注册表，定义在实现它的cpp文件中，JNI_OnLoad一次性全部注册
+ *      2.签名用Method<Sig>相同的写法在编译期生成，并且检查C++函数的参数、返回值类型，写错直接编译失败：
+ *          jni::native_method<void(StudentObject, jstring), put_student>("putStudent")
+ *          ---> {"putStudent", "(Lcom/sawyer/studyjni/Student;Ljava/lang/String;)V", put_student}
+ *          put_student必须是 void(JNIEnv *, jobject, jobject, jstring)
+ *      3.native函数都是static函数，so中只导出JNI_OnLoad、JNI_OnUnload(CMakeLists.txt中默认隐藏符号)
+ *
+ * 注册失败是致命错误：JNI_OnLoad返回JNI_ERR，System.loadLibrary抛出UnsatisfiedLinkError
+ */
+namespace jni {
+
+//Sig为Java端的函数类型，Instance/Static为对应的C++函数指针类型
+template<typename Signature>
+struct Native;
+
+template<typename R, typename... Args>
+struct Native<R(Args...)> {
+    static constexpr auto kSignature = method_signature<R, Args...>();
+    using Instance = RawType<R> (*)(JNIEnv *, jobject, RawType<Args>...);
+    using Static = RawType<R> (*)(JNIEnv *, jclass, RawType<Args>...);
+};
+
+/**
+ * 打开STUDYJNI_JNI_STATS时，虚拟机调用的是这个包装函数，见jni-stats.h
+ * 每个native函数实例化一份，sIndex是它在统计中的下标
+ */
+template<auto Fn>
+struct StatsEntry;
+
+template<typename R, typename Self, typename... Params, R (*Fn)(JNIEnv *, Self, Params...)>
+struct StatsEntry<Fn> {
+    static inline int sIndex = -1;
+
+    static R call(JNIEnv *env, Self self, Params... params) {
+        StatsEntryScope scope(sIndex);
+        return Fn(env, self, params...);
+    }
+};
+
+/**
+ * NDK的JNINativeMethod是const char*，OpenJDK的是char*，所以要const_cast
+ * 虚拟机只读取，不会修改这两个字符串
+ */
+template<typename Signature, auto Fn>
+inline JNINativeMethod make_native_method(const char *name) {
+    const char *signature = Native<Signature>::kSignature.c_str();
+#if STUDYJNI_JNI_STATS
+    void *fn = reinterpret_cast<void *>(&StatsEntry<Fn>::call);
+    StatsEntry<Fn>::sIndex = jni_stats_register(name, signature, fn);
+#else
+    void *fn = reinterpret_cast<void *>(Fn);
+#endif
+    return {const_cast<char *>(name), const_cast<char *>(signature), fn};
+}
+
+template<typename Signature, auto Fn>
+inline JNINativeMethod native_method(const char *name) {
+    static_assert(std::is_same<decltype(Fn), typename Native<Signature>::Instance>::value,
+                  "native函数的参数、返回值类型与Java签名不一致");
+    return make_native_method<Signature, Fn>(name);
+}
+
+//Java中的static native函数，C++函数的第二个参数是jclass
+template<typename Signature, auto Fn>
+inline JNINativeMethod static_native_method(const char *name) {
+    static_assert(std::is_same<decltype(Fn), typename Native<Signature>::Static>::value,
+                  "native函数的参数、返回值类型与Java签名不一致");
+    return make_native_method<Signature, Fn>(name);
+}
+
+} //namespace jni
+
+//一个Java类的所有native函数
+struct NativeTable {
+    const char *className;
+    const JNINativeMethod *methods;
+    jint count;
+};
+
+template<size_t N>
+constexpr NativeTable native_table(const char *className, const JNINativeMethod (&methods)[N]) {
+    return {className, methods, (jint) N};
+}
+
+//各个Java类的注册表，定义在对应的cpp文件中
+extern const NativeTable kMainActivityNatives;          //native-lib.cpp
+extern const NativeTable kSecondActivityNatives;        //native-lib.cpp
+extern const NativeTable kNativeArraysNatives;          //native-arrays.cpp
+extern const NativeTable kSharedRingNatives;            //native-ring.cpp
+extern const NativeTable kNativeStringsNatives;         //native-strings.cpp
+extern const NativeTable kStudentStoreNatives;          //native-student-store.cpp
+extern const NativeTable kNativeEventDispatcherNatives; //native-dispatcher.cpp
+extern const NativeTable kDogFactoryNatives;            //native-dog-factory.cpp
+extern const NativeTable kNativeStatsNatives;           //native-stats.cpp
+extern const NativeTable kNativeAsyncNatives;           //native-async.cpp
+extern const NativeTable kParallelArraysNatives;        //native-parallel.cpp
+extern const NativeTable kMappedFileNatives;            //native-mapped-file.cpp
+extern const NativeTable kNativeHandlesNatives;         //native-handles.cpp
+extern const NativeTable kGraphCodecNatives;            //native-graph.cpp
+extern const NativeTable kFieldMirrorNatives;           //native-mirror.cpp
+
+/**
+ * 注册所有注册表，在JNI_OnLoad中调用
+ * 失败时输出找不到的类、或者逐个重试找出注册失败的函数，清除异常后返回false
+ * @methodCount: 成功时写入注册的函数总数，可以为nullptr
+ */
+bool register_all_natives(JNIEnv *env, jint *methodCount);
+
+#endif //STUDYJNI_JNI_REGISTER_H
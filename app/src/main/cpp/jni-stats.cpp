@@ -0,0 +1,325 @@
+#include "jni-stats.h"
+
+#if STUDYJNI_JNI_STATS
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <pthread.h>
+
+/**
+ * 直方图的桶：[0, 4)每个值一个桶，之后每个2的幂分为4个桶
+ *      e.g: [1024, 1280) [1280, 1536) [1536, 1792) [1792, 2048)
+ * 相对误差不超过25%，最大约 2^40ns(18分钟)，再大的都放进最后一个桶
+ */
+static constexpr int kSubBucketBits = 2;
+static constexpr int kSubBuckets = 1 << kSubBucketBits;
+static constexpr int kBuckets = 40 * kSubBuckets;
+
+static int bucket_of(uint64_t ns) {
+    if (ns < kSubBuckets) {
+        return (int) ns;
+    }
+    int msb = 63 - __builtin_clzll(ns);
+    auto sub = (int) ((ns >> (msb - kSubBucketBits)) & (kSubBuckets - 1));
+    int index = (msb - kSubBucketBits + 1) * kSubBuckets + sub;
+    return std::min(index, kBuckets - 1);
+}
+
+//桶的上界(不包含)
+static uint64_t bucket_limit(int index) {
+    if (index < kSubBuckets) {
+        return (uint64_t) index + 1;
+    }
+    int msb = index / kSubBuckets - 1 + kSubBucketBits;
+    auto sub = (uint64_t) (index % kSubBuckets);
+    return (kSubBuckets + sub + 1) << (msb - kSubBucketBits);
+}
+
+namespace {
+
+//一个线程中一个入口的计数器。只有所属线程写，读取线程用relaxed读，不会读到撕裂的值
+struct Counters {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> totalNs{0};
+    std::atomic<uint64_t> maxNs{0};
+    std::atomic<uint64_t> upcalls{0};
+    std::atomic<uint64_t> upcallNs{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> localRefs{0};
+    std::atomic<uint64_t> buckets[kBuckets] = {};
+};
+
+//单写者：load + store，不需要lock前缀的原子加
+inline void bump(std::atomic<uint64_t> &counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+//合并时使用，只在持有sMutex时访问
+struct Totals {
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    uint64_t upcalls = 0;
+    uint64_t upcallNs = 0;
+    uint64_t bytes = 0;
+    uint64_t localRefs = 0;
+    uint64_t buckets[kBuckets] = {};
+
+    void add(const Counters &c) {
+        count += c.count.load(std::memory_order_relaxed);
+        totalNs += c.totalNs.load(std::memory_order_relaxed);
+        maxNs = std::max(maxNs, c.maxNs.load(std::memory_order_relaxed));
+        upcalls += c.upcalls.load(std::memory_order_relaxed);
+        upcallNs += c.upcallNs.load(std::memory_order_relaxed);
+        bytes += c.bytes.load(std::memory_order_relaxed);
+        localRefs += c.localRefs.load(std::memory_order_relaxed);
+        for (int i = 0; i < kBuckets; ++i) {
+            buckets[i] += c.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    void add(const Totals &t) {
+        count += t.count;
+        totalNs += t.totalNs;
+        maxNs = std::max(maxNs, t.maxNs);
+        upcalls += t.upcalls;
+        upcallNs += t.upcallNs;
+        bytes += t.bytes;
+        localRefs += t.localRefs;
+        for (int i = 0; i < kBuckets; ++i) {
+            buckets[i] += t.buckets[i];
+        }
+    }
+
+    //rank从1开始，返回所在桶的上界，不超过maxNs
+    uint64_t percentile(double p) const {
+        if (count == 0) {
+            return 0;
+        }
+        auto rank = (uint64_t) (p * (double) count);
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return std::min(bucket_limit(i), maxNs);
+            }
+        }
+        return maxNs;
+    }
+};
+
+/**
+ * 每个线程一份，Counters在该线程第一次用到某个入口时才分配
+ * (大部分线程只会调用少数几个native函数)
+ */
+struct ThreadStats {
+    std::atomic<Counters *> entries[kStatsMaxEntries] = {};
+    int current = kStatsEntryBackground; //所属线程私有：正在执行的入口
+    ThreadStats *next = nullptr;         //sThreads链表
+};
+
+struct EntryInfo {
+    const char *name = nullptr;
+    const char *signature = nullptr;
+    const char *className = nullptr;
+    const void *fn = nullptr;
+};
+
+}//namespace
+
+//入口只在加载so(静态初始化)时注册，之后只读
+static EntryInfo sEntries[kStatsMaxEntries] = {
+        {"(attach)", "", nullptr, nullptr},
+        {"(background)", "", nullptr, nullptr},
+};
+static int sEntryCount = kStatsEntryBackground + 1;
+static int sDroppedEntries = 0;
+
+//保护sThreads、sRetired：只在线程第一次统计、线程退出、读取时加锁
+static std::mutex sMutex;
+static ThreadStats *sThreads = nullptr;
+static Totals *sRetired = nullptr; //已退出线程的计数器之和，下标同sEntries
+
+static pthread_once_t sKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t sThreadKey;
+static thread_local ThreadStats *tStats = nullptr;
+
+//线程退出：计数器合并到sRetired，然后释放
+static void retire_thread(void *value) {
+    auto *stats = static_cast<ThreadStats *>(value);
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        for (ThreadStats **p = &sThreads; *p; p = &(*p)->next) {
+            if (*p == stats) {
+                *p = stats->next;
+                break;
+            }
+        }
+        for (int i = 0; i < kStatsMaxEntries; ++i) {
+            Counters *counters = stats->entries[i].load(std::memory_order_relaxed);
+            if (counters) {
+                sRetired[i].add(*counters);
+                delete counters;
+            }
+        }
+    }
+    delete stats;
+    tStats = nullptr;
+}
+
+static void create_thread_key() {
+    pthread_key_create(&sThreadKey, retire_thread);
+    sRetired = new Totals[kStatsMaxEntries]; //不释放，线程可能在静态对象析构之后退出
+}
+
+static ThreadStats *thread_stats() {
+    if (tStats) {
+        return tStats;
+    }
+    pthread_once(&sKeyOnce, create_thread_key);
+    auto *stats = new ThreadStats();
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        stats->next = sThreads;
+        sThreads = stats;
+    }
+    pthread_setspecific(sThreadKey, stats);
+    tStats = stats;
+    return stats;
+}
+
+static Counters &counters_of(ThreadStats *stats, int index) {
+    Counters *counters = stats->entries[index].load(std::memory_order_relaxed);
+    if (!counters) {
+        counters = new Counters();
+        //release：读取线程看到指针时，也能看到初始化为0的计数器
+        stats->entries[index].store(counters, std::memory_order_release);
+    }
+    return *counters;
+}
+
+int jni_stats_register(const char *name, const char *signature, const void *fn) {
+    if (sEntryCount >= kStatsMaxEntries) {
+        ++sDroppedEntries;
+        return -1;
+    }
+    sEntries[sEntryCount] = {name, signature, nullptr, fn};
+    return sEntryCount++;
+}
+
+int jni_stats_dropped() {
+    return sDroppedEntries;
+}
+
+void jni_stats_set_class(const void *fn, const char *className) {
+    for (int i = 0; i < sEntryCount; ++i) {
+        if (sEntries[i].fn == fn) {
+            sEntries[i].className = className;
+        }
+    }
+}
+
+int64_t jni_stats_now_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int jni_stats_enter(int index) {
+    ThreadStats *stats = thread_stats();
+    int previous = stats->current;
+    stats->current = index;
+    return previous;
+}
+
+void jni_stats_leave(int index, int previous, int64_t startNs) {
+    auto elapsed = (uint64_t) std::max<int64_t>(jni_stats_now_ns() - startNs, 0);
+    ThreadStats *stats = thread_stats();
+    Counters &c = counters_of(stats, index);
+    bump(c.count, 1);
+    bump(c.totalNs, elapsed);
+    if (elapsed > c.maxNs.load(std::memory_order_relaxed)) {
+        c.maxNs.store(elapsed, std::memory_order_relaxed);
+    }
+    bump(c.buckets[bucket_of(elapsed)], 1);
+    stats->current = previous;
+}
+
+void jni_stats_upcall(int64_t elapsedNs) {
+    ThreadStats *stats = thread_stats();
+    Counters &c = counters_of(stats, stats->current);
+    bump(c.upcalls, 1);
+    bump(c.upcallNs, (uint64_t) std::max<int64_t>(elapsedNs, 0));
+}
+
+void jni_stats_add_bytes(size_t bytes) {
+    ThreadStats *stats = thread_stats();
+    bump(counters_of(stats, stats->current).bytes, bytes);
+}
+
+void jni_stats_add_local_refs(uint32_t count) {
+    ThreadStats *stats = thread_stats();
+    bump(counters_of(stats, stats->current).localRefs, count);
+}
+
+std::vector<int64_t> jni_stats_snapshot() {
+    pthread_once(&sKeyOnce, create_thread_key);
+    const int count = sEntryCount;
+    std::vector<Totals> totals((size_t) count);
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        for (int i = 0; i < count; ++i) {
+            totals[i].add(sRetired[i]);
+        }
+        for (ThreadStats *stats = sThreads; stats; stats = stats->next) {
+            for (int i = 0; i < count; ++i) {
+                Counters *counters = stats->entries[i].load(std::memory_order_acquire);
+                if (counters) {
+                    totals[i].add(*counters);
+                }
+            }
+        }
+    }
+    std::vector<int64_t> result;
+    result.reserve(3 + (size_t) count * kStatsFieldCount);
+    result.push_back(kStatsVersion);
+    result.push_back(count);
+    result.push_back(kStatsFieldCount);
+    for (const Totals &t : totals) {
+        int64_t fields[kStatsFieldCount];
+        fields[kStatsCount] = (int64_t) t.count;
+        fields[kStatsTotalNs] = (int64_t) t.totalNs;
+        fields[kStatsP50Ns] = (int64_t) t.percentile(0.50);
+        fields[kStatsP99Ns] = (int64_t) t.percentile(0.99);
+        fields[kStatsMaxNs] = (int64_t) t.maxNs;
+        fields[kStatsUpcalls] = (int64_t) t.upcalls;
+        fields[kStatsUpcallNs] = (int64_t) t.upcallNs;
+        fields[kStatsBytes] = (int64_t) t.bytes;
+        fields[kStatsLocalRefs] = (int64_t) t.localRefs;
+        result.insert(result.end(), fields, fields + kStatsFieldCount);
+    }
+    return result;
+}
+
+std::vector<std::string> jni_stats_names() {
+    std::vector<std::string> names;
+    names.reserve((size_t) sEntryCount);
+    for (int i = 0; i < sEntryCount; ++i) {
+        const EntryInfo &info = sEntries[i];
+        std::string name;
+        if (info.className) {
+            //"com/sawyer/studyjni/MainActivity" ---> "MainActivity."
+            const char *slash = strrchr(info.className, '/');
+            name.append(slash ? slash + 1 : info.className).append(".");
+        }
+        name.append(info.name).append(info.signature);
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+#endif //STUDYJNI_JNI_STATS
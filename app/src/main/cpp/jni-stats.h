@@ -0,0 +1,150 @@
+#ifndef STUDYJNI_JNI_STATS_H
+#define STUDYJNI_JNI_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 每个JNI入口的耗时统计
+ *
+ * 统计内容(每个native函数一份)：
+ *      调用次数、总耗时、耗时直方图(p50/p99)、最大耗时
+ *      上行调用(native ---> Java，即jni-typed.h的Method/StaticMethod/Constructor)的次数和耗时
+ *      跨越JNI边界拷贝的字节数(array-bridge.h、string-batch.h...)
+ *      创建的局部引用数(jni::LocalRef)
+ * 上行调用、字节数、局部引用都记到当前线程正在执行的native函数上；不在native函数中时(工作线程)记到"(background)"
+ * AttachCurrentThread的耗时记到"(attach)"
+ *
+ * 实现：
+ *      1.jni-register.h注册native函数时，注册的是包装函数：进入时记下时间，返回时写入统计
+ *      2.每个线程一份计数器，只有该线程写(单写者，不需要原子的读-改-写，也不加锁)
+ *      3.直方图的桶是固定的(按2的幂分段，每段4个桶)，读取时把所有线程的计数器相加
+ *      4.线程退出时把计数器合并到全局的计数器中，然后释放
+ *
+ * 编译期开关：STUDYJNI_JNI_STATS=0 时所有统计代码展开为空，native函数直接注册，没有任何开销
+ */
+#ifndef STUDYJNI_JNI_STATS
+#define STUDYJNI_JNI_STATS 1
+#endif
+
+//最多统计的入口个数，超出的native函数不统计(register_all_natives()中输出LOGE，见jni_stats_dropped)
+constexpr int kStatsMaxEntries = 256;
+
+//伪入口
+constexpr int kStatsEntryAttach = 0;     //AttachCurrentThread
+constexpr int kStatsEntryBackground = 1; //不在任何native函数中(e.g: 工作线程)
+
+/**
+ * jni_stats_snapshot()的格式：[版本, 入口个数, 每个入口的字段数, 入口0的字段..., 入口1的字段...]
+ * 与NativeStats.java一致
+ */
+constexpr int64_t kStatsVersion = 1;
+enum StatsField {
+    kStatsCount = 0,
+    kStatsTotalNs,
+    kStatsP50Ns,
+    kStatsP99Ns,
+    kStatsMaxNs,
+    kStatsUpcalls,
+    kStatsUpcallNs,
+    kStatsBytes,
+    kStatsLocalRefs,
+    kStatsFieldCount
+};
+
+#if STUDYJNI_JNI_STATS
+
+//注册一个入口，返回下标，超出kStatsMaxEntries返回-1。只在加载so时调用
+int jni_stats_register(const char *name, const char *signature, const void *fn);
+
+//入口所属的Java类，注册到虚拟机时调用
+void jni_stats_set_class(const void *fn, const char *className);
+
+//因为超过kStatsMaxEntries而没有统计的入口数。注册发生在静态初始化时，不能输出日志，由调用者在JNI_OnLoad中检查
+int jni_stats_dropped();
+
+int64_t jni_stats_now_ns();
+
+//进入native函数，返回之前的入口
+int jni_stats_enter(int index);
+
+void jni_stats_leave(int index, int previous, int64_t startNs);
+
+void jni_stats_upcall(int64_t elapsedNs);
+
+void jni_stats_add_bytes(size_t bytes);
+
+void jni_stats_add_local_refs(uint32_t count);
+
+//合并所有线程的计数器，格式见kStatsVersion
+std::vector<int64_t> jni_stats_snapshot();
+
+//入口名，e.g: "MainActivity.putStudent(Lcom/sawyer/studyjni/Student;Ljava/lang/String;)V"，下标与snapshot一致
+std::vector<std::string> jni_stats_names();
+
+class StatsEntryScope {
+public:
+    explicit StatsEntryScope(int index) : mIndex(index) {
+        if (mIndex >= 0) {
+            mPrevious = jni_stats_enter(mIndex);
+            mStartNs = jni_stats_now_ns();
+        }
+    }
+
+    ~StatsEntryScope() {
+        if (mIndex >= 0) {
+            jni_stats_leave(mIndex, mPrevious, mStartNs);
+        }
+    }
+
+    StatsEntryScope(const StatsEntryScope &) = delete;
+
+    StatsEntryScope &operator=(const StatsEntryScope &) = delete;
+
+private:
+    int mIndex;
+    int mPrevious = kStatsEntryBackground;
+    int64_t mStartNs = 0;
+};
+
+class StatsUpcallScope {
+public:
+    StatsUpcallScope() : mStartNs(jni_stats_now_ns()) {}
+
+    ~StatsUpcallScope() {
+        jni_stats_upcall(jni_stats_now_ns() - mStartNs);
+    }
+
+    StatsUpcallScope(const StatsUpcallScope &) = delete;
+
+    StatsUpcallScope &operator=(const StatsUpcallScope &) = delete;
+
+private:
+    int64_t mStartNs;
+};
+
+#else //STUDYJNI_JNI_STATS
+
+class StatsEntryScope {
+public:
+    explicit StatsEntryScope(int) {}
+};
+
+class StatsUpcallScope {
+public:
+    StatsUpcallScope() {}
+};
+
+inline void jni_stats_set_class(const void *, const char *) {}
+
+inline int jni_stats_dropped() { return 0; }
+
+inline void jni_stats_add_bytes(size_t) {}
+
+inline void jni_stats_add_local_refs(uint32_t) {}
+
+#endif //STUDYJNI_JNI_STATS
+
+#endif //STUDYJNI_JNI_STATS_H
@@ -0,0 +1,44 @@
+#include "jni-thread.h"
+#include "jni-log.h"
+#include "jni-stats.h"
+#include <pthread.h>
+
+static pthread_key_t sEnvKey;
+static pthread_once_t sEnvKeyOnce = PTHREAD_ONCE_INIT;
+
+//线程退出时，pthread会以pthread_setspecific保存的值(非空)调用此函数
+static void detach_current_thread(void *env) {
+    if (env && ::jvm) {
+        ::jvm->DetachCurrentThread();
+    }
+}
+
+static void create_env_key() {
+    pthread_key_create(&sEnvKey, detach_current_thread);
+}
+
+JNIEnv *attach_current_thread(const char *threadName) {
+    if (!::jvm) {
+        return nullptr;
+    }
+    JNIEnv *env = nullptr;
+    //Java线程、或者已经附加过的C++线程，GetEnv直接成功
+    if (::jvm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) == JNI_OK) {
+        return env;
+    }
+
+    pthread_once(&sEnvKeyOnce, create_env_key);
+    JavaVMAttachArgs args{JNI_VERSION_1_6, threadName, nullptr};
+    jint result;
+    {
+        StatsEntryScope scope(kStatsEntryAttach);
+        result = ::jvm->AttachCurrentThread(&env, &args);
+    }
+    if (result != JNI_OK) {
+        LOGE("attach_current_thread: AttachCurrentThread失败")
+        return nullptr;
+    }
+    //只有我们自己附加的线程才登记，线程退出时自动Detach
+    pthread_setspecific(sEnvKey, env);
+    return env;
+}
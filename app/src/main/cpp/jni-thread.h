@@ -0,0 +1,20 @@
+#ifndef STUDYJNI_JNI_THREAD_H
+#define STUDYJNI_JNI_THREAD_H
+
+#include <jni.h>
+
+//JNI_OnLoad中保存的JavaVM，定义在native-lib.cpp中
+extern JavaVM *jvm;
+
+/**
+ * 获取当前线程的JNIEnv：
+ *      已经附加过(包括Java创建的线程)直接返回；
+ *      否则AttachCurrentThread，并通过pthread_key的析构函数在线程退出时自动DetachCurrentThread
+ * 所以每个C++线程一生只需要附加一次，不用每次任务都 Attach/Detach
+ *
+ * @threadName: 附加时在Java层显示的线程名，可为nullptr
+ * @return: 失败返回nullptr
+ */
+JNIEnv *attach_current_thread(const char *threadName = nullptr);
+
+#endif //STUDYJNI_JNI_THREAD_H
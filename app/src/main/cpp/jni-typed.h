@@ -0,0 +1,572 @@
+#ifndef STUDYJNI_JNI_TYPED_H
+#define STUDYJNI_JNI_TYPED_H
+
+#include <jni.h>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "jni-stats.h"
+#include "jni-thread.h"
+
+/**
+ * 编译期类型化的JNI调用层(只有头文件)
+ *
+ * 以前的写法：每个调用点手写签名字符串，并且要自己挑选 CallIntMethod / CallObjectMethod ...
+ *      jmethodID mid = env->GetMethodID(clazz, "showString", "(Ljava/lang/String;I)Ljava/lang/String;");
+ *      auto str = (jstring) env->CallObjectMethod(obj, mid, value, 9527);
+ *      ...
+ *      env->DeleteLocalRef(str);
+ * 现在：
+ *      jni::Method<jstring(jstring, jint)> showString = jni::Method<jstring(jstring, jint)>::lookup(env, clazz, "showString");
+ *      jni::LocalRef<jstring> str = showString(env, obj, value, 9527);   //出了作用域自动DeleteLocalRef
+ *
+ * 1.签名在编译期由C++类型拼接出来(kSignature是constexpr的静态数据)，运行时不拼接字符串
+ * 2.根据返回值类型在编译期选择 Call<Type>Method / Get<Type>Field / Set<Type>Field
+ * 3.返回的对象用只能移动、不能拷贝的 LocalRef 包装，GlobalRef / WeakRef 同理
+ * 全部是内联函数，编译后就是直接的JNI调用
+ *
+ * Java自定义类用标签类型表示：
+ *      struct StudentClass { static constexpr char kName[] = "com/sawyer/studyjni/Student"; };
+ *      jni::Object<StudentClass>  --->  签名 Lcom/sawyer/studyjni/Student;  C++类型 jobject
+ */
+namespace jni {
+
+//==================================编译期字符串==================================
+template<size_t N>
+struct ConstString {
+    char chars[N + 1]{};
+
+    constexpr ConstString() = default;
+
+    constexpr ConstString(const char (&str)[N + 1]) {
+        for (size_t i = 0; i < N; ++i) {
+            chars[i] = str[i];
+        }
+    }
+
+    constexpr const char *c_str() const { return chars; }
+
+    static constexpr size_t size() { return N; }
+};
+
+template<size_t N>
+ConstString(const char (&)[N]) -> ConstString<N - 1>;
+
+template<size_t A, size_t B>
+constexpr ConstString<A + B> operator+(const ConstString<A> &a, const ConstString<B> &b) {
+    ConstString<A + B> result;
+    for (size_t i = 0; i < A; ++i) {
+        result.chars[i] = a.chars[i];
+    }
+    for (size_t i = 0; i < B; ++i) {
+        result.chars[A + i] = b.chars[i];
+    }
+    return result;
+}
+
+//==================================C++类型 -> Java签名==================================
+//Java自定义类，Tag::kName为全类名
+template<typename Tag>
+struct Object {
+};
+
+//对象数组，e.g: ObjectArray<jstring> ---> [Ljava/lang/String;
+template<typename Element>
+struct ObjectArray {
+};
+
+/**
+ * JniType<T>::sig: 签名
+ * JniType<T>::Raw: 传给/返回自JNI函数的C++类型
+ */
+template<typename T>
+struct JniType;
+
+#define STUDYJNI_JNI_TYPE(T, RawT, Sig)              \
+template<>                                          \
+struct JniType<T> {                                 \
+    using Raw = RawT;                               \
+    static constexpr auto sig = ConstString(Sig);   \
+};
+
+STUDYJNI_JNI_TYPE(void, void, "V")
+STUDYJNI_JNI_TYPE(jboolean, jboolean, "Z")
+STUDYJNI_JNI_TYPE(jbyte, jbyte, "B")
+STUDYJNI_JNI_TYPE(jchar, jchar, "C")
+STUDYJNI_JNI_TYPE(jshort, jshort, "S")
+STUDYJNI_JNI_TYPE(jint, jint, "I")
+STUDYJNI_JNI_TYPE(jlong, jlong, "J")
+STUDYJNI_JNI_TYPE(jfloat, jfloat, "F")
+STUDYJNI_JNI_TYPE(jdouble, jdouble, "D")
+STUDYJNI_JNI_TYPE(jobject, jobject, "Ljava/lang/Object;")
+STUDYJNI_JNI_TYPE(jstring, jstring, "Ljava/lang/String;")
+STUDYJNI_JNI_TYPE(jclass, jclass, "Ljava/lang/Class;")
+STUDYJNI_JNI_TYPE(jthrowable, jthrowable, "Ljava/lang/Throwable;")
+STUDYJNI_JNI_TYPE(jbooleanArray, jbooleanArray, "[Z")
+STUDYJNI_JNI_TYPE(jbyteArray, jbyteArray, "[B")
+STUDYJNI_JNI_TYPE(jcharArray, jcharArray, "[C")
+STUDYJNI_JNI_TYPE(jshortArray, jshortArray, "[S")
+STUDYJNI_JNI_TYPE(jintArray, jintArray, "[I")
+STUDYJNI_JNI_TYPE(jlongArray, jlongArray, "[J")
+STUDYJNI_JNI_TYPE(jfloatArray, jfloatArray, "[F")
+STUDYJNI_JNI_TYPE(jdoubleArray, jdoubleArray, "[D")
+
+#undef STUDYJNI_JNI_TYPE
+
+template<typename Tag>
+struct JniType<Object<Tag>> {
+    using Raw = jobject;
+    static constexpr auto sig = ConstString("L") + ConstString<sizeof(Tag::kName) - 1>(Tag::kName)
+                                + ConstString(";");
+};
+
+template<typename Element>
+struct JniType<ObjectArray<Element>> {
+    using Raw = jobjectArray;
+    static constexpr auto sig = ConstString("[") + JniType<Element>::sig;
+};
+
+template<typename T>
+using RawType = typename JniType<T>::Raw;
+
+template<typename T>
+constexpr bool kIsObject = std::is_pointer<RawType<T>>::value;
+
+//(参数...)返回值，e.g: method_signature<jstring, jstring, jint>() ---> (Ljava/lang/String;I)Ljava/lang/String;
+template<typename R, typename... Args>
+constexpr auto method_signature() {
+    return (ConstString("(") + ... + JniType<Args>::sig) + ConstString(")") + JniType<R>::sig;
+}
+
+//==================================引用的RAII包装==================================
+/**
+ * 局部引用：析构时DeleteLocalRef。只能移动，不能拷贝(拷贝后两次Delete同一个引用会出错)
+ * 注意：只能在创建它的线程、本次JNI调用内使用
+ */
+template<typename T = jobject>
+class LocalRef {
+public:
+    LocalRef() = default;
+
+    LocalRef(JNIEnv *env, T obj) : mEnv(env), mObj(obj) {
+        if (obj) {
+            jni_stats_add_local_refs(1);
+        }
+    }
+
+    LocalRef(LocalRef &&other) noexcept : mEnv(other.mEnv), mObj(other.release()) {}
+
+    LocalRef &operator=(LocalRef &&other) noexcept {
+        if (this != &other) {
+            reset();
+            mEnv = other.mEnv;
+            mObj = other.release();
+        }
+        return *this;
+    }
+
+    LocalRef(const LocalRef &) = delete;
+    LocalRef &operator=(const LocalRef &) = delete;
+
+    ~LocalRef() { reset(); }
+
+    T get() const { return mObj; }
+
+    operator T() const { return mObj; }
+
+    explicit operator bool() const { return mObj != nullptr; }
+
+    //交出所有权，不再负责释放
+    T release() {
+        T obj = mObj;
+        mObj = nullptr;
+        return obj;
+    }
+
+    void reset() {
+        if (mObj) {
+            mEnv->DeleteLocalRef(mObj);
+            mObj = nullptr;
+        }
+    }
+
+private:
+    JNIEnv *mEnv = nullptr;
+    T mObj = nullptr;
+};
+
+/**
+ * 全局引用：可以跨线程、跨JNI调用使用，析构时DeleteGlobalRef
+ * 析构时如果不知道JNIEnv，会通过attach_current_thread()获取当前线程的
+ */
+template<typename T = jobject>
+class GlobalRef {
+public:
+    GlobalRef() = default;
+
+    GlobalRef(JNIEnv *env, T obj) : mObj(obj ? static_cast<T>(env->NewGlobalRef(obj)) : nullptr) {}
+
+    GlobalRef(GlobalRef &&other) noexcept : mObj(other.release()) {}
+
+    GlobalRef &operator=(GlobalRef &&other) noexcept {
+        if (this != &other) {
+            reset();
+            mObj = other.release();
+        }
+        return *this;
+    }
+
+    GlobalRef(const GlobalRef &) = delete;
+    GlobalRef &operator=(const GlobalRef &) = delete;
+
+    ~GlobalRef() { reset(); }
+
+    T get() const { return mObj; }
+
+    operator T() const { return mObj; }
+
+    explicit operator bool() const { return mObj != nullptr; }
+
+    T release() {
+        T obj = mObj;
+        mObj = nullptr;
+        return obj;
+    }
+
+    void reset(JNIEnv *env = nullptr) {
+        if (!mObj) {
+            return;
+        }
+        if (!env) {
+            env = attach_current_thread();
+        }
+        if (env) {
+            env->DeleteGlobalRef(mObj);
+        }
+        mObj = nullptr;
+    }
+
+private:
+    T mObj = nullptr;
+};
+
+/**
+ * 弱全局引用：不阻止对象被GC回收。使用前必须lock()成局部引用，回收后lock()得到空的LocalRef
+ */
+template<typename T = jobject>
+class WeakRef {
+public:
+    WeakRef() = default;
+
+    WeakRef(JNIEnv *env, T obj) : mWeak(obj ? env->NewWeakGlobalRef(obj) : nullptr) {}
+
+    WeakRef(WeakRef &&other) noexcept : mWeak(other.mWeak) { other.mWeak = nullptr; }
+
+    WeakRef &operator=(WeakRef &&other) noexcept {
+        if (this != &other) {
+            reset();
+            mWeak = other.mWeak;
+            other.mWeak = nullptr;
+        }
+        return *this;
+    }
+
+    WeakRef(const WeakRef &) = delete;
+    WeakRef &operator=(const WeakRef &) = delete;
+
+    ~WeakRef() { reset(); }
+
+    LocalRef<T> lock(JNIEnv *env) const {
+        return LocalRef<T>(env, mWeak ? static_cast<T>(env->NewLocalRef(mWeak)) : nullptr);
+    }
+
+    explicit operator bool() const { return mWeak != nullptr; }
+
+    void reset(JNIEnv *env = nullptr) {
+        if (!mWeak) {
+            return;
+        }
+        if (!env) {
+            env = attach_current_thread();
+        }
+        if (env) {
+            env->DeleteWeakGlobalRef(mWeak);
+        }
+        mWeak = nullptr;
+    }
+
+private:
+    jweak mWeak = nullptr;
+};
+
+//对象类型返回LocalRef，基本类型原样返回
+template<typename T>
+using Result = std::conditional_t<kIsObject<T>, LocalRef<RawType<T>>, RawType<T>>;
+
+//==================================按类型分派JNI函数==================================
+template<typename Raw, typename Enable = void>
+struct Invoker;
+
+#define STUDYJNI_JNI_INVOKER(RawT, Name)                                                   \
+template<>                                                                                 \
+struct Invoker<RawT> {                                                                     \
+    template<typename... A>                                                                \
+    static RawT call(JNIEnv *env, jobject obj, jmethodID mid, A... args) {                 \
+        return env->Call##Name##Method(obj, mid, args...);                                 \
+    }                                                                                      \
+    template<typename... A>                                                                \
+    static RawT callStatic(JNIEnv *env, jclass clazz, jmethodID mid, A... args) {          \
+        return env->CallStatic##Name##Method(clazz, mid, args...);                         \
+    }                                                                                      \
+    static RawT get(JNIEnv *env, jobject obj, jfieldID fid) {                              \
+        return env->Get##Name##Field(obj, fid);                                            \
+    }                                                                                      \
+    static void set(JNIEnv *env, jobject obj, jfieldID fid, RawT value) {                  \
+        env->Set##Name##Field(obj, fid, value);                                            \
+    }                                                                                      \
+    static RawT getStatic(JNIEnv *env, jclass clazz, jfieldID fid) {                       \
+        return env->GetStatic##Name##Field(clazz, fid);                                    \
+    }                                                                                      \
+    static void setStatic(JNIEnv *env, jclass clazz, jfieldID fid, RawT value) {           \
+        env->SetStatic##Name##Field(clazz, fid, value);                                    \
+    }                                                                                      \
+};
+
+STUDYJNI_JNI_INVOKER(jboolean, Boolean)
+STUDYJNI_JNI_INVOKER(jbyte, Byte)
+STUDYJNI_JNI_INVOKER(jchar, Char)
+STUDYJNI_JNI_INVOKER(jshort, Short)
+STUDYJNI_JNI_INVOKER(jint, Int)
+STUDYJNI_JNI_INVOKER(jlong, Long)
+STUDYJNI_JNI_INVOKER(jfloat, Float)
+STUDYJNI_JNI_INVOKER(jdouble, Double)
+
+#undef STUDYJNI_JNI_INVOKER
+
+//所有引用类型(jobject、jstring、jintArray ...)都走 Call/Get/SetObject，再转换为具体类型
+template<typename RawT>
+struct Invoker<RawT, std::enable_if_t<std::is_pointer<RawT>::value>> {
+    template<typename... A>
+    static RawT call(JNIEnv *env, jobject obj, jmethodID mid, A... args) {
+        return static_cast<RawT>(env->CallObjectMethod(obj, mid, args...));
+    }
+
+    template<typename... A>
+    static RawT callStatic(JNIEnv *env, jclass clazz, jmethodID mid, A... args) {
+        return static_cast<RawT>(env->CallStaticObjectMethod(clazz, mid, args...));
+    }
+
+    static RawT get(JNIEnv *env, jobject obj, jfieldID fid) {
+        return static_cast<RawT>(env->GetObjectField(obj, fid));
+    }
+
+    static void set(JNIEnv *env, jobject obj, jfieldID fid, RawT value) {
+        env->SetObjectField(obj, fid, value);
+    }
+
+    static RawT getStatic(JNIEnv *env, jclass clazz, jfieldID fid) {
+        return static_cast<RawT>(env->GetStaticObjectField(clazz, fid));
+    }
+
+    static void setStatic(JNIEnv *env, jclass clazz, jfieldID fid, RawT value) {
+        env->SetStaticObjectField(clazz, fid, value);
+    }
+};
+
+template<>
+struct Invoker<void> {
+    template<typename... A>
+    static void call(JNIEnv *env, jobject obj, jmethodID mid, A... args) {
+        env->CallVoidMethod(obj, mid, args...);
+    }
+
+    template<typename... A>
+    static void callStatic(JNIEnv *env, jclass clazz, jmethodID mid, A... args) {
+        env->CallStaticVoidMethod(clazz, mid, args...);
+    }
+};
+
+template<typename R, typename RawR>
+inline Result<R> wrap_result(JNIEnv *env, RawR value) {
+    if constexpr (kIsObject<R>) {
+        return LocalRef<RawType<R>>(env, value);
+    } else {
+        return value;
+    }
+}
+
+//==================================方法、构造函数、属性==================================
+template<typename Signature>
+class Method;
+
+//实例方法，e.g: Method<jint(jint, jint)> ---> int add(int, int)
+template<typename R, typename... Args>
+class Method<R(Args...)> {
+public:
+    static constexpr auto kSignature = method_signature<R, Args...>();
+
+    Method() = default;
+
+    explicit Method(jmethodID id) : mId(id) {}
+
+    static Method lookup(JNIEnv *env, jclass clazz, const char *name) {
+        return Method(env->GetMethodID(clazz, name, kSignature.c_str()));
+    }
+
+    Result<R> operator()(JNIEnv *env, jobject obj, RawType<Args>... args) const {
+        StatsUpcallScope upcall;
+        if constexpr (std::is_void<R>::value) {
+            Invoker<void>::call(env, obj, mId, args...);
+        } else {
+            return wrap_result<R>(env, Invoker<RawType<R>>::call(env, obj, mId, args...));
+        }
+    }
+
+    jmethodID id() const { return mId; }
+
+    operator jmethodID() const { return mId; }
+
+    explicit operator bool() const { return mId != nullptr; }
+
+private:
+    jmethodID mId = nullptr;
+};
+
+template<typename Signature>
+class StaticMethod;
+
+//静态方法，e.g: StaticMethod<void(jstring)> ---> static void showInfo(String)
+template<typename R, typename... Args>
+class StaticMethod<R(Args...)> {
+public:
+    static constexpr auto kSignature = method_signature<R, Args...>();
+
+    StaticMethod() = default;
+
+    explicit StaticMethod(jmethodID id) : mId(id) {}
+
+    static StaticMethod lookup(JNIEnv *env, jclass clazz, const char *name) {
+        return StaticMethod(env->GetStaticMethodID(clazz, name, kSignature.c_str()));
+    }
+
+    Result<R> operator()(JNIEnv *env, jclass clazz, RawType<Args>... args) const {
+        StatsUpcallScope upcall;
+        if constexpr (std::is_void<R>::value) {
+            Invoker<void>::callStatic(env, clazz, mId, args...);
+        } else {
+            return wrap_result<R>(env, Invoker<RawType<R>>::callStatic(env, clazz, mId, args...));
+        }
+    }
+
+    jmethodID id() const { return mId; }
+
+    operator jmethodID() const { return mId; }
+
+    explicit operator bool() const { return mId != nullptr; }
+
+private:
+    jmethodID mId = nullptr;
+};
+
+//构造函数，e.g: Constructor<jint, jint> ---> Dog(int, int)
+template<typename... Args>
+class Constructor {
+public:
+    static constexpr auto kSignature = method_signature<void, Args...>();
+
+    Constructor() = default;
+
+    explicit Constructor(jmethodID id) : mId(id) {}
+
+    //<init> == 构造函数名
+    static Constructor lookup(JNIEnv *env, jclass clazz, const char *name = "<init>") {
+        return Constructor(env->GetMethodID(clazz, name, kSignature.c_str()));
+    }
+
+    LocalRef<jobject> operator()(JNIEnv *env, jclass clazz, RawType<Args>... args) const {
+        StatsUpcallScope upcall;
+        return LocalRef<jobject>(env, env->NewObject(clazz, mId, args...));
+    }
+
+    jmethodID id() const { return mId; }
+
+    operator jmethodID() const { return mId; }
+
+    explicit operator bool() const { return mId != nullptr; }
+
+private:
+    jmethodID mId = nullptr;
+};
+
+//实例属性，e.g: Field<jint> ---> int age
+template<typename T>
+class Field {
+public:
+    static constexpr auto kSignature = JniType<T>::sig;
+
+    Field() = default;
+
+    explicit Field(jfieldID id) : mId(id) {}
+
+    static Field lookup(JNIEnv *env, jclass clazz, const char *name) {
+        return Field(env->GetFieldID(clazz, name, kSignature.c_str()));
+    }
+
+    Result<T> get(JNIEnv *env, jobject obj) const {
+        return wrap_result<T>(env, Invoker<RawType<T>>::get(env, obj, mId));
+    }
+
+    void set(JNIEnv *env, jobject obj, RawType<T> value) const {
+        Invoker<RawType<T>>::set(env, obj, mId, value);
+    }
+
+    jfieldID id() const { return mId; }
+
+    operator jfieldID() const { return mId; }
+
+    explicit operator bool() const { return mId != nullptr; }
+
+private:
+    jfieldID mId = nullptr;
+};
+
+//静态属性，e.g: StaticField<jint> ---> static int age
+template<typename T>
+class StaticField {
+public:
+    static constexpr auto kSignature = JniType<T>::sig;
+
+    StaticField() = default;
+
+    explicit StaticField(jfieldID id) : mId(id) {}
+
+    static StaticField lookup(JNIEnv *env, jclass clazz, const char *name) {
+        return StaticField(env->GetStaticFieldID(clazz, name, kSignature.c_str()));
+    }
+
+    Result<T> get(JNIEnv *env, jclass clazz) const {
+        return wrap_result<T>(env, Invoker<RawType<T>>::getStatic(env, clazz, mId));
+    }
+
+    void set(JNIEnv *env, jclass clazz, RawType<T> value) const {
+        Invoker<RawType<T>>::setStatic(env, clazz, mId, value);
+    }
+
+    jfieldID id() const { return mId; }
+
+    operator jfieldID() const { return mId; }
+
+    explicit operator bool() const { return mId != nullptr; }
+
+private:
+    jfieldID mId = nullptr;
+};
+
+//创建Java字符串并用LocalRef包装
+inline LocalRef<jstring> new_string_utf(JNIEnv *env, const char *utf) {
+    return LocalRef<jstring>(env, env->NewStringUTF(utf));
+}
+
+} //namespace jni
+
+#endif //STUDYJNI_JNI_TYPED_H
@@ -0,0 +1,29 @@
+#ifndef STUDYJNI_JNI_UTIL_H
+#define STUDYJNI_JNI_UTIL_H
+
+#include <jni.h>
+#include <ctime>
+
+//单调时钟，单位ns，用于耗时统计
+static inline jlong now_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (jlong) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * 向Java层抛出异常。注意：C++代码并不会因此中断，调用后要自己return
+ * @className: 异常的全类名，e.g："java/lang/IllegalArgumentException"
+ */
+static inline void jni_throw(JNIEnv *env, const char *className, const char *msg) {
+    if (env->ExceptionCheck()) {
+        return; //已经有异常挂起了，保留第一个
+    }
+    jclass exceptionClass = env->FindClass(className);
+    if (exceptionClass) {
+        env->ThrowNew(exceptionClass, msg);
+        env->DeleteLocalRef(exceptionClass);
+    }
+}
+
+#endif //STUDYJNI_JNI_UTIL_H
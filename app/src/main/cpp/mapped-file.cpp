@@ -0,0 +1,141 @@
+#include "mapped-file.h"
+#include "jni-log.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//预读时每隔这么多页检查一次是否要停止
+static constexpr size_t kPrefetchBatchPages = 256;
+
+static size_t page_size() {
+    static const size_t size = (size_t) sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+MappedFile *MappedFile::open(const char *path, bool writable, uint64_t offset, uint64_t length, int *error) {
+    *error = 0;
+    int fd = ::open(path, writable ? (O_RDWR | O_CREAT | O_CLOEXEC) : (O_RDONLY | O_CLOEXEC), 0644);
+    if (fd < 0) {
+        *error = errno;
+        return nullptr;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        *error = errno;
+        close(fd);
+        return nullptr;
+    }
+    auto fileSize = (uint64_t) st.st_size;
+    if (length == 0) {
+        length = fileSize > offset ? fileSize - offset : 0;
+    }
+    if (length == 0 || length > SIZE_MAX) {
+        *error = EINVAL; //mmap不能映射0字节
+        close(fd);
+        return nullptr;
+    }
+    if (offset + length > fileSize) {
+        //只读时不能超出文件末尾(访问时SIGBUS)；读写时扩展文件
+        if (!writable || ftruncate(fd, (off_t) (offset + length)) != 0) {
+            *error = writable ? errno : EINVAL;
+            close(fd);
+            return nullptr;
+        }
+    }
+    //mmap的offset必须按页对齐，多映射的部分对Java不可见
+    const uint64_t mapOffset = offset / page_size() * page_size();
+    const auto mapSize = (size_t) (offset - mapOffset + length);
+    void *base = mmap(nullptr, mapSize, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd,
+                      (off_t) mapOffset);
+    //映射建立后fd可以关闭，映射仍然有效
+    int savedErrno = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        *error = savedErrno;
+        return nullptr;
+    }
+    auto *mapBase = static_cast<uint8_t *>(base);
+    return new MappedFile(mapBase, mapSize, mapBase + (offset - mapOffset), (size_t) length, writable);
+}
+
+MappedFile::MappedFile(uint8_t *mapBase, size_t mapSize, uint8_t *data, size_t size, bool writable)
+        : mMapBase(mapBase), mMapSize(mapSize), mData(data), mSize(size), mWritable(writable) {}
+
+MappedFile::~MappedFile() {
+    if (munmap(mMapBase, mMapSize) != 0) {
+        LOGE("MappedFile: munmap失败, errno = %d", errno)
+    }
+}
+
+void MappedFile::acquire() {
+    mRefs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MappedFile::release() {
+    //acq_rel：最后一个释放者munmap之前，能看到其它线程对映射的所有访问都已结束
+    if (mRefs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
+
+uint8_t *MappedFile::page_range(size_t offset, size_t length, size_t *pageLength) const {
+    uint8_t *begin = mData + offset;
+    auto aligned = reinterpret_cast<uintptr_t>(begin) / page_size() * page_size();
+    *pageLength = (size_t) (reinterpret_cast<uintptr_t>(begin) + length - aligned);
+    return reinterpret_cast<uint8_t *>(aligned);
+}
+
+int MappedFile::advise(size_t offset, size_t length, MapAdvice advice) {
+    int flag;
+    switch (advice) {
+        case MapAdvice::Sequential:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case MapAdvice::Random:
+            flag = MADV_RANDOM;
+            break;
+        case MapAdvice::WillNeed:
+            flag = MADV_WILLNEED;
+            break;
+        case MapAdvice::DontNeed:
+            flag = MADV_DONTNEED;
+            break;
+        case MapAdvice::Normal:
+        default:
+            flag = MADV_NORMAL;
+            break;
+    }
+    size_t pageLength;
+    uint8_t *begin = page_range(offset, length, &pageLength);
+    return madvise(begin, pageLength, flag) == 0 ? 0 : errno;
+}
+
+size_t MappedFile::prefetch(size_t offset, size_t length, const AsyncToken *token) {
+    if (length == 0) {
+        return 0;
+    }
+    size_t pageLength;
+    const uint8_t *begin = page_range(offset, length, &pageLength);
+    const size_t pages = (pageLength + page_size() - 1) / page_size();
+    uint8_t sum = 0;
+    for (size_t i = 0; i < pages; ++i) {
+        if (token && i % kPrefetchBatchPages == 0 && token->cancelled()) {
+            return i;
+        }
+        //volatile：防止编译器把这次读取优化掉
+        sum += *static_cast<const volatile uint8_t *>(begin + i * page_size());
+    }
+    (void) sum;
+    return pages;
+}
+
+int MappedFile::sync(size_t offset, size_t length, bool async) {
+    if (!mWritable || length == 0) {
+        return 0;
+    }
+    size_t pageLength;
+    uint8_t *begin = page_range(offset, length, &pageLength);
+    return msync(begin, pageLength, async ? MS_ASYNC : MS_SYNC) == 0 ? 0 : errno;
+}
@@ -0,0 +1,96 @@
+#ifndef STUDYJNI_MAPPED_FILE_H
+#define STUDYJNI_MAPPED_FILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "async-calls.h"
+
+/**
+ * 文件的内存映射(mmap)，通过NewDirectByteBuffer零拷贝地交给Java
+ *
+ * 以前：Java用InputStream一块一块地读进byte[]，再作为参数传给native(内核 -> Java堆 -> native，两次拷贝)
+ * 现在：Java直接读写映射的页，缺页时由内核从page cache填充，不经过Java堆，也没有每块一次的JNI调用
+ *
+ * 引用计数：
+ *      1.映射本身持有一个引用，unmap()释放它
+ *      2.每个交给Java的视图(DirectByteBuffer)、每个正在执行的异步预读各持有一个引用
+ *      3.引用归零时才真正munmap。所以unmap()之后，还没释放的视图仍然可以安全访问
+ *      4.DirectByteBuffer无法被native作废，所以由Java保证buffer不比引用活得长：
+ *        视图的引用只在buffer(包括slice、duplicate依赖的原始buffer)不可达后由PhantomReference释放，见MappedFile.java
+ *
+ * offset、length不需要按页对齐：内部按页对齐映射，data()指向offset处
+ */
+enum class MapAdvice : int {
+    Normal = 0,
+    Sequential = 1, //顺序读：内核加大预读，读过的页更早回收
+    Random = 2,     //随机读：关闭预读
+    WillNeed = 3,   //马上要用：异步预读到page cache
+    DontNeed = 4,   //暂时不用：可以回收这些页(私有可写映射的修改会丢失，这里都是MAP_SHARED，不受影响)
+};
+
+class MappedFile {
+public:
+    /**
+     * @writable: true时以读写方式打开(不存在则创建)，文件不够offset + length时扩展文件
+     * @length: 0表示从offset到文件末尾(只读时)
+     * @error: 失败时写入errno，成功时写入0
+     * @return: 失败返回nullptr。返回的对象引用计数为1，用unmap()释放
+     */
+    static MappedFile *open(const char *path, bool writable, uint64_t offset, uint64_t length, int *error);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    uint8_t *data() const { return mData; }
+
+    size_t size() const { return mSize; }
+
+    bool writable() const { return mWritable; }
+
+    //视图、异步任务使用映射前后调用
+    void acquire();
+
+    void release();
+
+    //释放映射本身的引用，只能调用一次
+    void unmap() { release(); }
+
+    //当前的引用数(包括映射本身)
+    int refs() const { return mRefs.load(std::memory_order_acquire); }
+
+    //[offset, offset + length)是否在映射范围内
+    bool contains(uint64_t offset, uint64_t length) const {
+        return offset <= mSize && length <= mSize - offset;
+    }
+
+    //madvise，返回0或者errno
+    int advise(size_t offset, size_t length, MapAdvice advice);
+
+    /**
+     * 预读：每页读一个字节，使这些页马上缺页进入内存(WillNeed只是提示，不保证读完)
+     * @token: 每kPrefetchBatchPages页检查一次取消，取消后提前结束；同步调用时为nullptr
+     * @return: 读过的页数
+     */
+    size_t prefetch(size_t offset, size_t length, const AsyncToken *token);
+
+    //msync，只读映射直接返回0。@async: MS_ASYNC只安排写回，不等待
+    int sync(size_t offset, size_t length, bool async);
+
+private:
+    MappedFile(uint8_t *mapBase, size_t mapSize, uint8_t *data, size_t size, bool writable);
+
+    ~MappedFile();
+
+    //[offset, offset + length)向外扩展到整页，返回页起始地址，长度写入@pageLength
+    uint8_t *page_range(size_t offset, size_t length, size_t *pageLength) const;
+
+    uint8_t *mMapBase;  //mmap返回的地址(页对齐)
+    size_t mMapSize;
+    uint8_t *mData;     //offset处
+    size_t mSize;
+    bool mWritable;
+    std::atomic<int> mRefs{1};
+};
+
+#endif //STUDYJNI_MAPPED_FILE_H
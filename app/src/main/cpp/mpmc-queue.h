@@ -0,0 +1,114 @@
+#ifndef STUDYJNI_MPMC_QUEUE_H
+#define STUDYJNI_MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * 有界、无锁的多生产者/多消费者队列(Dmitry Vyukov的算法)
+ *
+ * 每个槽位有一个序号sequence：
+ *      sequence == pos      表示该槽位空闲，生产者可以写入
+ *      sequence == pos + 1  表示该槽位已写入，消费者可以读取
+ * 生产者、消费者各自用CAS抢占位置，抢到之后独占该槽位，不需要锁
+ *
+ * 容量必须是2的幂
+ */
+template<typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+            : mCapacity(round_up(capacity)), mMask(mCapacity - 1),
+              mCells(new Cell[mCapacity]) {
+        for (size_t i = 0; i < mCapacity; ++i) {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    size_t capacity() const { return mCapacity; }
+
+    //队列满返回false，value不会被移走
+    bool tryPush(T &value) {
+        size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &mCells[pos & mMask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+            if (diff == 0) {
+                if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = mEnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(T &&value) {
+        return tryPush(value);
+    }
+
+    //队列空(或者下一个槽位还没写完)返回false
+    bool tryPop(T &out) {
+        size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &mCells[pos & mMask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+            if (diff == 0) {
+                if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = mDequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->value = T();
+        cell->sequence.store(pos + mCapacity, std::memory_order_release);
+        return true;
+    }
+
+    //近似值，仅用于统计
+    size_t sizeApprox() const {
+        size_t enq = mEnqueuePos.load(std::memory_order_relaxed);
+        size_t deq = mDequeuePos.load(std::memory_order_relaxed);
+        return enq >= deq ? enq - deq : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t round_up(size_t n) {
+        size_t cap = 2;
+        while (cap < n) {
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    const size_t mCapacity;
+    const size_t mMask;
+    std::unique_ptr<Cell[]> mCells;
+    alignas(64) std::atomic<size_t> mEnqueuePos{0};
+    alignas(64) std::atomic<size_t> mDequeuePos{0};
+};
+
+#endif //STUDYJNI_MPMC_QUEUE_H
@@ -0,0 +1,149 @@
+#include <jni.h>
+#include "array-bridge.h"
+#include "array-kernels.h"
+#include "jni-register.h"
+#include "jni-util.h"
+
+/**
+ * NativeArrays.java 的JNI实现：基本类型数组的批量运算
+ *
+ * 每个函数只跨越一次JNI边界：
+ *      先拿到整个数组(PrimitiveArray)，在C++内存上跑完运算内核，再一次性释放
+ * Java中是重载函数，动态注册时用签名区分：
+ *      sum(int[]) ---> {"sum", "([I)J", sum_I}
+ * (以前静态注册时，函数名后面要带上转义后的参数签名：Java_com_sawyer_studyjni_NativeArrays_sum___3I)
+ */
+
+template<typename T>
+static bool check_not_null(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array) {
+    if (!array) {
+        jni_throw(env, "java/lang/NullPointerException", "array == null");
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+static auto array_sum(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array)
+-> decltype(kernel_sum((const T *) nullptr, 0)) {
+    if (!check_not_null<T>(env, array)) {
+        return 0;
+    }
+    PrimitiveArray<T> view(env, array, ArrayAccess::ReadOnly);
+    if (!view.data()) {
+        return 0;
+    }
+    return kernel_sum(view.data(), (size_t) view.size());
+}
+
+//返回[min, max]，空数组返回null
+template<typename T>
+static typename JniArrayTraits<T>::ArrayType
+array_min_max(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array) {
+    if (!check_not_null<T>(env, array)) {
+        return nullptr;
+    }
+    T result[2];
+    {
+        PrimitiveArray<T> view(env, array, ArrayAccess::ReadOnly);
+        if (!view.data() || view.size() == 0) {
+            return nullptr;
+        }
+        kernel_min_max(view.data(), (size_t) view.size(), &result[0], &result[1]);
+    }//先释放(退出Critical区间)，再创建返回给Java的数组
+    return new_java_array(env, result, 2);
+}
+
+template<typename T>
+static void array_scale(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array, T factor) {
+    if (!check_not_null<T>(env, array)) {
+        return;
+    }
+    PrimitiveArray<T> view(env, array, ArrayAccess::ReadWrite);
+    if (view.data()) {
+        kernel_scale(view.data(), (size_t) view.size(), factor);
+    }
+}
+
+template<typename T>
+static void array_prefix_sum(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array) {
+    if (!check_not_null<T>(env, array)) {
+        return;
+    }
+    PrimitiveArray<T> view(env, array, ArrayAccess::ReadWrite);
+    if (view.data()) {
+        kernel_prefix_sum(view.data(), (size_t) view.size());
+    }
+}
+
+template<typename T>
+static auto array_dot(JNIEnv *env, typename JniArrayTraits<T>::ArrayType a,
+                      typename JniArrayTraits<T>::ArrayType b)
+-> decltype(kernel_dot((const T *) nullptr, (const T *) nullptr, 0)) {
+    if (!check_not_null<T>(env, a) || !check_not_null<T>(env, b)) {
+        return 0;
+    }
+    //两个数组的长度要在进入Critical区间之前拿到
+    jsize lenA = env->GetArrayLength(a);
+    jsize lenB = env->GetArrayLength(b);
+    if (lenA != lenB) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "dot: 数组长度不一致");
+        return 0;
+    }
+    PrimitiveArray<T> viewA(env, a, ArrayAccess::ReadOnly, lenA);
+    PrimitiveArray<T> viewB(env, b, ArrayAccess::ReadOnly, lenB);
+    if (!viewA.data() || !viewB.data()) {
+        return 0;
+    }
+    return kernel_dot(viewA.data(), viewB.data(), (size_t) lenA);
+}
+
+/**
+ * 为每一种基本类型生成一组JNI函数，以及它们的注册表项
+ * @T: C++类型 e.g: jint
+ * @Sig: Java签名 e.g: I
+ * @SumT: sum/dot返回给Java的类型
+ */
+#define DEFINE_NATIVE_ARRAYS(T, Sig, SumT)                                                        \
+static SumT sum_##Sig(JNIEnv *env, jclass clazz, T##Array array) {                                \
+    return array_sum<T>(env, array);                                                              \
+}                                                                                                 \
+static T##Array min_max_##Sig(JNIEnv *env, jclass clazz, T##Array array) {                        \
+    return array_min_max<T>(env, array);                                                          \
+}                                                                                                 \
+static void scale_##Sig(JNIEnv *env, jclass clazz, T##Array array, T factor) {                    \
+    array_scale<T>(env, array, factor);                                                           \
+}                                                                                                 \
+static void prefix_sum_##Sig(JNIEnv *env, jclass clazz, T##Array array) {                         \
+    array_prefix_sum<T>(env, array);                                                              \
+}                                                                                                 \
+static SumT dot_##Sig(JNIEnv *env, jclass clazz, T##Array a, T##Array b) {                        \
+    return array_dot<T>(env, a, b);                                                               \
+}
+
+DEFINE_NATIVE_ARRAYS(jbyte, B, jlong)
+DEFINE_NATIVE_ARRAYS(jint, I, jlong)
+DEFINE_NATIVE_ARRAYS(jlong, J, jlong)
+DEFINE_NATIVE_ARRAYS(jfloat, F, jdouble)
+DEFINE_NATIVE_ARRAYS(jdouble, D, jdouble)
+
+#undef DEFINE_NATIVE_ARRAYS
+
+#define NATIVE_ARRAYS_METHODS(T, Sig, SumT)                                                       \
+        jni::static_native_method<SumT(T##Array), sum_##Sig>("sum"),                              \
+        jni::static_native_method<T##Array(T##Array), min_max_##Sig>("minMax"),                   \
+        jni::static_native_method<void(T##Array, T), scale_##Sig>("scale"),                       \
+        jni::static_native_method<void(T##Array), prefix_sum_##Sig>("prefixSum"),                 \
+        jni::static_native_method<SumT(T##Array, T##Array), dot_##Sig>("dot")
+
+static const JNINativeMethod kNativeArraysMethods[] = {
+        NATIVE_ARRAYS_METHODS(jbyte, B, jlong),
+        NATIVE_ARRAYS_METHODS(jint, I, jlong),
+        NATIVE_ARRAYS_METHODS(jlong, J, jlong),
+        NATIVE_ARRAYS_METHODS(jfloat, F, jdouble),
+        NATIVE_ARRAYS_METHODS(jdouble, D, jdouble),
+};
+
+#undef NATIVE_ARRAYS_METHODS
+
+const NativeTable kNativeArraysNatives = native_table("com/sawyer/studyjni/NativeArrays", kNativeArraysMethods);
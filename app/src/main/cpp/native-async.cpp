@@ -0,0 +1,46 @@
+#include <jni.h>
+#include "array-bridge.h"
+#include "async-calls.h"
+#include "jni-register.h"
+#include "jni-util.h"
+
+/**
+ * NativeAsync.java 的JNI实现，见async-calls.h
+ */
+
+static jlong native_submit(JNIEnv *env, jclass clazz, jint kind, jlong arg) {
+    if (kind < 0 || kind > (jint) AsyncKind::Sleep) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "NativeAsync: kind不存在");
+        return 0;
+    }
+    return AsyncCalls::instance().submit(async_builtin_job((AsyncKind) kind, arg));
+}
+
+static jboolean native_cancel(JNIEnv *env, jclass clazz, jlong handle) {
+    return AsyncCalls::instance().cancel(handle) ? JNI_TRUE : JNI_FALSE;
+}
+
+static void native_release(JNIEnv *env, jclass clazz, jlong handle) {
+    AsyncCalls::instance().release(handle);
+}
+
+static jint native_release_all(JNIEnv *env, jclass clazz) {
+    return (jint) AsyncCalls::instance().releaseAll();
+}
+
+//[submitted, completed, cancelled, batches]
+static jlongArray native_stats(JNIEnv *env, jclass clazz) {
+    AsyncStats s = AsyncCalls::instance().stats();
+    jlong result[] = {(jlong) s.submitted, (jlong) s.completed, (jlong) s.cancelled, (jlong) s.batches};
+    return new_java_array(env, result, 4);
+}
+
+static const JNINativeMethod kNativeAsyncMethods[] = {
+        jni::static_native_method<jlong(jint, jlong), native_submit>("nativeSubmit"),
+        jni::static_native_method<jboolean(jlong), native_cancel>("nativeCancel"),
+        jni::static_native_method<void(jlong), native_release>("nativeRelease"),
+        jni::static_native_method<jint(), native_release_all>("nativeReleaseAll"),
+        jni::static_native_method<jlongArray(), native_stats>("nativeStats"),
+};
+
+const NativeTable kNativeAsyncNatives = native_table("com/sawyer/studyjni/NativeAsync", kNativeAsyncMethods);
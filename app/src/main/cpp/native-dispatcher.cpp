@@ -0,0 +1,52 @@
+#include <jni.h>
+#include "array-bridge.h"
+#include "callback-dispatcher.h"
+#include "jni-cache.h"
+#include "jni-register.h"
+
+/**
+ * NativeEventDispatcher.java 的JNI实现，native端只有一个分发器(CallbackDispatcher::instance())
+ */
+
+static jboolean native_start(JNIEnv *env, jclass clazz, jobject listener,
+                             jint intervalMs, jint capacity, jint policy) {
+    if (capacity <= 0 || policy < 0 || policy > (jint) OverflowPolicy::Block) {
+        return JNI_FALSE;
+    }
+    return CallbackDispatcher::instance().start(env, listener, intervalMs, (size_t) capacity,
+                                                (OverflowPolicy) policy) ? JNI_TRUE : JNI_FALSE;
+}
+
+static void native_stop(JNIEnv *env, jclass clazz) {
+    CallbackDispatcher::instance().stop(env);
+}
+
+static jboolean native_post(JNIEnv *env, jclass clazz, jint type, jint key,
+                            jlong value) {
+    return CallbackDispatcher::instance().post(type, key, value) ? JNI_TRUE : JNI_FALSE;
+}
+
+static jlongArray native_poll(JNIEnv *env, jclass clazz) {
+    return CallbackDispatcher::instance().poll(env);
+}
+
+//[enqueued, coalesced, dropped, batches, delivered]
+static jlongArray native_stats(JNIEnv *env, jclass clazz) {
+    DispatcherStats s = CallbackDispatcher::instance().stats();
+    jlong result[] = {(jlong) s.enqueued, (jlong) s.coalesced, (jlong) s.dropped,
+                      (jlong) s.batches, (jlong) s.delivered};
+    return new_java_array(env, result, 5);
+}
+
+using EventListenerObject = jni::Object<EventListenerClass>;
+
+static const JNINativeMethod kNativeEventDispatcherMethods[] = {
+        jni::static_native_method<jboolean(EventListenerObject, jint, jint, jint), native_start>("nativeStart"),
+        jni::static_native_method<void(), native_stop>("nativeStop"),
+        jni::static_native_method<jboolean(jint, jint, jlong), native_post>("nativePost"),
+        jni::static_native_method<jlongArray(), native_poll>("nativePoll"),
+        jni::static_native_method<jlongArray(), native_stats>("nativeStats"),
+};
+
+const NativeTable kNativeEventDispatcherNatives = native_table("com/sawyer/studyjni/NativeEventDispatcher",
+                                                               kNativeEventDispatcherMethods);
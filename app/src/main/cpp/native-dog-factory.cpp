@@ -0,0 +1,91 @@
+#include <jni.h>
+#include <cstdint>
+#include <vector>
+#include "dog-factory.h"
+#include "jni-cache.h"
+#include "jni-register.h"
+#include "jni-stats.h"
+#include "jni-util.h"
+
+/**
+ * DogFactory.java 的JNI实现，见dog-factory.h
+ */
+
+//检查selector、count，返回构造函数的参数个数，不合法时抛出异常并返回-1
+static int check_request(JNIEnv *env, jint selector, jint count) {
+    int arity = dog_ctor_arity(selector);
+    if (arity < 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "DogFactory: 不支持的构造函数");
+        return -1;
+    }
+    if (count < 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "DogFactory: count < 0");
+        return -1;
+    }
+    return arity;
+}
+
+static jobjectArray native_create(JNIEnv *env, jclass clazz, jint selector, jint count, jintArray args) {
+    int arity = check_request(env, selector, count);
+    if (arity < 0) {
+        return nullptr;
+    }
+    const auto needed = (jlong) count * arity;
+    if (needed > 0 && !args) {
+        jni_throw(env, "java/lang/NullPointerException", "args == null");
+        return nullptr;
+    }
+    if (needed > 0 && env->GetArrayLength(args) < needed) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "DogFactory: args长度不足");
+        return nullptr;
+    }
+    //创建对象时要调用JNI，不能停留在Critical区间内，所以先一次性拷贝出来
+    std::vector<jint> copy((size_t) needed);
+    if (needed > 0) {
+        env->GetIntArrayRegion(args, 0, (jsize) needed, copy.data());
+        jni_stats_add_bytes((size_t) needed * sizeof(jint));
+    }
+    return new_dog_array(env, (DogCtor) selector, copy.data(), count);
+}
+
+/**
+ * args为DirectByteBuffer(本机字节序)，读取[offset, offset + length)，直接使用native内存，不拷贝
+ * @length: args.remaining()，不能越过limit()读取
+ */
+static jobjectArray native_create_direct(JNIEnv *env, jclass clazz, jint selector, jint count,
+                                         jobject args, jint offset, jint length) {
+    int arity = check_request(env, selector, count);
+    if (arity < 0) {
+        return nullptr;
+    }
+    const auto neededBytes = (jlong) count * arity * (jlong) sizeof(jint);
+    if (neededBytes == 0) {
+        return new_dog_array(env, (DogCtor) selector, nullptr, count);
+    }
+    if (!args) {
+        jni_throw(env, "java/lang/NullPointerException", "args == null");
+        return nullptr;
+    }
+    //api: void* GetDirectBufferAddress(jobject buf) 不是DirectByteBuffer时返回nullptr
+    auto *base = static_cast<uint8_t *>(env->GetDirectBufferAddress(args));
+    jlong capacity = env->GetDirectBufferCapacity(args);
+    if (!base || offset < 0 || length < 0 || capacity - offset < length || length < neededBytes) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "DogFactory: args不是DirectByteBuffer或者长度不足");
+        return nullptr;
+    }
+    const uint8_t *data = base + offset;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(jint) != 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "DogFactory: args没有按4字节对齐");
+        return nullptr;
+    }
+    return new_dog_array(env, (DogCtor) selector, reinterpret_cast<const jint *>(data), count);
+}
+
+using DogArray = jni::ObjectArray<jni::Object<DogClass>>;
+
+static const JNINativeMethod kDogFactoryMethods[] = {
+        jni::static_native_method<DogArray(jint, jint, jintArray), native_create>("nativeCreate"),
+        jni::static_native_method<DogArray(jint, jint, jni::Object<ByteBufferClass>, jint, jint), native_create_direct>("nativeCreateDirect"),
+};
+
+const NativeTable kDogFactoryNatives = native_table("com/sawyer/studyjni/DogFactory", kDogFactoryMethods);
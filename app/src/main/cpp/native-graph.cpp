@@ -0,0 +1,171 @@
+#include <jni.h>
+#include <cstdio>
+#include <string>
+#include "array-bridge.h"
+#include "graph-codec.h"
+#include "jni-cache.h"
+#include "jni-register.h"
+#include "jni-stats.h"
+#include "jni-util.h"
+
+/**
+ * GraphCodec.java 的JNI实现，见graph-codec.h
+ *
+ * 所有ByteBuffer都必须是DirectByteBuffer，native直接读写这块内存，不拷贝
+ */
+
+/**
+ * buffer[offset, offset + remaining)的地址，不合法时抛出IllegalArgumentException并返回nullptr
+ * @remaining: Java传入的buffer.remaining()，不能越过limit()读写
+ */
+static uint8_t *direct_range(JNIEnv *env, jobject buffer, jint offset, jint remaining, size_t *length) {
+    if (!buffer) {
+        jni_throw(env, "java/lang/NullPointerException", "GraphCodec: buffer == null");
+        return nullptr;
+    }
+    auto *base = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (!base || offset < 0 || remaining < 0 || offset > capacity || capacity - offset < remaining) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "GraphCodec: 不是DirectByteBuffer或者offset越界");
+        return nullptr;
+    }
+    *length = (size_t) remaining;
+    return base + offset;
+}
+
+static void throw_graph_error(JNIEnv *env, GraphError error) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "GraphCodec: %s(%d)", graph_error_message(error), (int) error);
+    jni_throw(env, "java/lang/IllegalArgumentException", msg);
+}
+
+static const char kSampleName[] = "唐三";
+
+/**
+ * 与insertObject相同的对象图：每个Person一个Student("唐三"，age从100开始递增)
+ * 以前要 2次AllocObject + setName + setAge + setStudent 共5次JNI调用，现在整个数组只要一次
+ */
+static ObjectGraph sample_graph(jint persons) {
+    ObjectGraph graph;
+    graph.students.resize((size_t) persons);
+    graph.persons.resize((size_t) persons);
+    for (jint i = 0; i < persons; ++i) {
+        GraphStudent &s = graph.students[(size_t) i];
+        s.age = 100 + i;
+        s.hasName = true;
+        s.name = kSampleName;
+        graph.persons[(size_t) i] = i;
+    }
+    return graph;
+}
+
+/**
+ * sample_graph(persons)编码后的大小，与graph_encoded_size()一致，但不需要先构造对象图
+ * 每个名字在字符串池中各存一份(不去重)
+ */
+static uint64_t sample_encoded_size(jint persons) {
+    const uint64_t n = (uint64_t) persons;
+    return kGraphHeaderBytes + n * kGraphStudentBytes + n * kGraphPersonBytes + 4
+           + n * (sizeof(kSampleName) - 1);
+}
+
+static jint native_sample_size(JNIEnv *env, jclass clazz, jint persons) {
+    if (persons < 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "GraphCodec: persons < 0");
+        return 0;
+    }
+    uint64_t size = sample_encoded_size(persons);
+    return size > INT32_MAX ? -1 : (jint) size;
+}
+
+//返回写入的字节数，空间不足时抛出异常
+static jint native_sample(JNIEnv *env, jclass clazz, jint persons, jobject out, jint offset, jint remaining) {
+    if (persons < 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "GraphCodec: persons < 0");
+        return 0;
+    }
+    size_t capacity;
+    uint8_t *dst = direct_range(env, out, offset, remaining, &capacity);
+    if (!dst) {
+        return 0;
+    }
+    //空间不足时不构造对象图
+    size_t written = sample_encoded_size(persons) > capacity ? 0 : graph_encode(sample_graph(persons), dst, capacity);
+    if (written == 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "GraphCodec: out空间不足");
+        return 0;
+    }
+    jni_stats_add_bytes(written);
+    return (jint) written;
+}
+
+/**
+ * native读取Java编码的对象图
+ * @return: [占用的字节数, Person个数, Student个数, student为null的Person个数, age之和]
+ */
+static jlongArray native_summary(JNIEnv *env, jclass clazz, jobject in, jint offset, jint remaining) {
+    size_t length;
+    const uint8_t *src = direct_range(env, in, offset, remaining, &length);
+    if (!src) {
+        return nullptr;
+    }
+    ObjectGraph graph;
+    size_t consumed = 0;
+    GraphError error = graph_decode(src, length, graph, &consumed);
+    if (error != GraphError::Ok) {
+        throw_graph_error(env, error);
+        return nullptr;
+    }
+    jni_stats_add_bytes(consumed);
+    jlong nullStudents = 0;
+    jlong ageSum = 0;
+    for (jint student : graph.persons) {
+        if (student == kGraphNull) {
+            ++nullStudents;
+        } else {
+            ageSum += graph.students[(size_t) student].age;
+        }
+    }
+    jlong result[] = {(jlong) consumed, (jlong) graph.persons.size(), (jlong) graph.students.size(),
+                      nullStudents, ageSum};
+    return new_java_array(env, result, 5);
+}
+
+//解码in再编码到out：验证Java编码的数据native能够原样读回，返回写入的字节数
+static jint native_echo(JNIEnv *env, jclass clazz, jobject in, jint inOffset, jint inRemaining,
+                        jobject out, jint outOffset, jint outRemaining) {
+    size_t length;
+    const uint8_t *src = direct_range(env, in, inOffset, inRemaining, &length);
+    if (!src) {
+        return 0;
+    }
+    size_t capacity;
+    uint8_t *dst = direct_range(env, out, outOffset, outRemaining, &capacity);
+    if (!dst) {
+        return 0;
+    }
+    ObjectGraph graph;
+    size_t consumed = 0;
+    GraphError error = graph_decode(src, length, graph, &consumed);
+    if (error != GraphError::Ok) {
+        throw_graph_error(env, error);
+        return 0;
+    }
+    size_t written = graph_encode(graph, dst, capacity);
+    if (written == 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "GraphCodec: out空间不足");
+        return 0;
+    }
+    jni_stats_add_bytes(consumed + written);
+    return (jint) written;
+}
+
+static const JNINativeMethod kGraphCodecMethods[] = {
+        jni::static_native_method<jint(jint), native_sample_size>("nativeSampleSize"),
+        jni::static_native_method<jint(jint, jni::Object<ByteBufferClass>, jint, jint), native_sample>("nativeSample"),
+        jni::static_native_method<jlongArray(jni::Object<ByteBufferClass>, jint, jint), native_summary>("nativeSummary"),
+        jni::static_native_method<jint(jni::Object<ByteBufferClass>, jint, jint, jni::Object<ByteBufferClass>, jint, jint),
+                native_echo>("nativeEcho"),
+};
+
+const NativeTable kGraphCodecNatives = native_table("com/sawyer/studyjni/GraphCodec", kGraphCodecMethods);
@@ -0,0 +1,48 @@
+#include <jni.h>
+#include "array-bridge.h"
+#include "handle-table.h"
+#include "jni-register.h"
+#include "jni-util.h"
+
+/**
+ * NativeHandles.java 的JNI实现，见handle-table.h
+ */
+
+static jlong native_put(JNIEnv *env, jclass clazz, jobject obj, jint kind) {
+    if (!obj || kind < 0 || kind > (jint) HandleKind::Weak) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "NativeHandles: obj为null或kind不存在");
+        return 0;
+    }
+    return HandleTable::instance().put(env, obj, (HandleKind) kind);
+}
+
+//句柄无效、弱引用的对象已被回收时返回null
+static jobject native_get(JNIEnv *env, jclass clazz, jlong handle) {
+    return HandleTable::instance().newLocal(env, handle);
+}
+
+static jboolean native_remove(JNIEnv *env, jclass clazz, jlong handle) {
+    return HandleTable::instance().remove(env, handle) ? JNI_TRUE : JNI_FALSE;
+}
+
+static jboolean native_valid(JNIEnv *env, jclass clazz, jlong handle) {
+    return HandleTable::instance().valid(handle) ? JNI_TRUE : JNI_FALSE;
+}
+
+//[liveStrong, liveWeak, slots, created, removed, staleLookups, clearedWeak]
+static jlongArray native_stats(JNIEnv *env, jclass clazz) {
+    HandleStats s = HandleTable::instance().stats();
+    jlong result[] = {(jlong) s.liveStrong, (jlong) s.liveWeak, (jlong) s.slots, (jlong) s.created,
+                      (jlong) s.removed, (jlong) s.staleLookups, (jlong) s.clearedWeak};
+    return new_java_array(env, result, 7);
+}
+
+static const JNINativeMethod kNativeHandlesMethods[] = {
+        jni::static_native_method<jlong(jobject, jint), native_put>("nativePut"),
+        jni::static_native_method<jobject(jlong), native_get>("nativeGet"),
+        jni::static_native_method<jboolean(jlong), native_remove>("nativeRemove"),
+        jni::static_native_method<jboolean(jlong), native_valid>("nativeValid"),
+        jni::static_native_method<jlongArray(), native_stats>("nativeStats"),
+};
+
+const NativeTable kNativeHandlesNatives = native_table("com/sawyer/studyjni/NativeHandles", kNativeHandlesMethods);
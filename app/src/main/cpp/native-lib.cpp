@@ -3,11 +3,22 @@
 //#include <string.h>  C导入头文件的写法
 
 //日志输出
-#include <android/log.h>
-#define TAG "lee"
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__);
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__);
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__);
+#include "jni-log.h"
+//JNI ID缓存，在JNI_OnLoad中一次性查找
+#include "jni-cache.h"
+#include "jni-util.h"
+#include "array-bridge.h"
+#include "string-batch.h"
+#include "worker-pool.h"
+#include "work-stealing.h"
+#include "async-calls.h"
+#include "handle-table.h"
+#include "call-arena.h"
+#include "callback-dispatcher.h"
+//native函数注册表
+#include "jni-register.h"
+//jstring常量池
+#include "jni-intern.h"
 #include <pthread.h> // 在AS上pthread不需要额外配置，默认就有
 
 /**
@@ -21,14 +32,16 @@
  *      即：Java_包名_类名_函数名。若Java里面包含"_"，需在_后面加一个1
  * 示例：包名为com.sawyer.study_jni，则JNI中函数名为Java_com_sawyer_study_1jni_MainActivity_stringFromJNI
  *
+ * 注意：以上是静态注册的写法。现在所有native函数都在JNI_OnLoad中动态注册(见文件末尾的注册表和jni-register.h)，
+ *      函数都是static的，名字不再需要遵守上面的规则，也不会导出到so的符号表中
+ *
  * 参数：
  *      @JNIEnv *: 为Java和C++交互的桥梁。 掌握其内置的function，就可以掌握JNI技术了
  *      @jobject: java层代码传递过来的对象，即本项目中的 MainActivity 对象。对应于java中该函数为非静态
  *      @jclass: java层代码传递过来的Class对象，即本项目中的 MainActivity.class 对象。对应于java中该函数为静态
  */
-extern "C" JNIEXPORT jstring JNICALL
-Java_com_sawyer_studyjni_MainActivity_stringFromJNI(JNIEnv* env,jobject mainActivityThis){
-    std::string hello = "sawyer say hello from C++ ";
+static jstring string_from_jni(JNIEnv* env,jobject mainActivityThis){
+    //std::string hello = "sawyer say hello from C++ ";
     /**
      * 重要：
      * JNIEnv * 的不同：（原因；可点进去查看其实现方式，即jni.h文件里面的实现）
@@ -38,17 +51,22 @@ Java_com_sawyer_studyjni_MainActivity_stringFromJNI(JNIEnv* env,jobject mainActi
      * (2)当前文件格式为C++,即native-lib.cpp
      *      env：它其实是一级指针，所以调用函数时，写法为：
      *      return env->NewStringUTF(hello.c_str());
+     *
+     * 现在：字符串常量只在第一次调用时创建一次，见jni-intern.h
+     *      常量池中的是全局引用，返回给Java时转为局部引用
      */
-    return env->NewStringUTF(hello.c_str());
+    return (jstring) env->NewLocalRef(JNI_INTERN(env, "sawyer say hello from C++ "));
 }
 
 //函数示例：修改MainActivity中的非静态变量name
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_changeName(JNIEnv *env, jobject mainActivityThis) {
-    //api: jclass GetObjectClass(jobject obj)
-    jclass mainActivityClass = env -> GetObjectClass(mainActivityThis);
-
+static void change_name(JNIEnv *env, jobject mainActivityThis) {
     /**
+     * 原写法(每次调用都要按字符串查找一遍)：
+     *      //api: jclass GetObjectClass(jobject obj)
+     *      jclass mainActivityClass = env -> GetObjectClass(mainActivityThis);
+     *      jfieldID nameFid = env -> GetFieldID(mainActivityClass,"name","Ljava/lang/String;");
+     * 现在nameFid在JNI_OnLoad中已查找好，见jni-cache.cpp
+     *
      * api: jfieldID GetFieldID(jclass clazz, const char* name, const char* sig)
      * 参数:
      *      @name: MainActivity中的变量名
@@ -69,19 +87,20 @@ Java_com_sawyer_studyjni_MainActivity_changeName(JNIEnv *env, jobject mainActivi
      *              函数------(参数类型)返回值类型   e.g：void add(int num1,double num2)---(ID)V
      *
      */
-    jfieldID nameFid = env -> GetFieldID(mainActivityClass,"name","Ljava/lang/String;");
+    jfieldID nameFid = jni_cache().mainNameFid;
 
-    jstring value = env -> NewStringUTF("sawyer");
+    //jstring value = env -> NewStringUTF("sawyer"); 每次调用都会创建一个新的String
+    jstring value = JNI_INTERN(env, "sawyer");
 
     //api: void SetObjectField(jobject obj, jfieldID fieldID, jobject value)
     env -> SetObjectField(mainActivityThis, nameFid, value);
 }
 
 //函数示例：修改MainActivity中的静态变量age
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_changeAge(JNIEnv *env, jclass mainActivityClass) {
+static void change_age(JNIEnv *env, jclass mainActivityClass) {
     //api: jfieldID GetStaticFieldID(jclass clazz, const char* name, const char* sig)
-    jfieldID ageFid = env -> GetStaticFieldID(mainActivityClass,"age","I");
+    //jfieldID ageFid = env -> GetStaticFieldID(mainActivityClass,"age","I");
+    jfieldID ageFid = jni_cache().mainAgeFid;
 
     /** 修改方式一 */
     //jint GetStaticIntField(jclass clazz, jfieldID fieldID)
@@ -94,10 +113,8 @@ Java_com_sawyer_studyjni_MainActivity_changeAge(JNIEnv *env, jclass mainActivity
 }
 
 //函数示例：修改MainActivity中的final变量num
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_changeNum(JNIEnv *env, jobject mainActivityThis) {
-    jclass mainActivityClass = env -> GetObjectClass(mainActivityThis);
-    jfieldID numFid = env -> GetFieldID(mainActivityClass,"num","D");
+static void change_num(JNIEnv *env, jobject mainActivityThis) {
+    jfieldID numFid = jni_cache().mainNumFid;
     env -> SetDoubleField(mainActivityThis, numFid,99.999);
 
     /** JNI中打印 */
@@ -106,202 +123,199 @@ Java_com_sawyer_studyjni_MainActivity_changeNum(JNIEnv *env, jobject mainActivit
 }
 
 //函数示例：调用MainActivity中的函数
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_callAddMethod(JNIEnv *env, jobject mainActivityThis) {
-    jclass mainActivityClass = env -> GetObjectClass(mainActivityThis);
-    jmethodID methodId = env -> GetMethodID(mainActivityClass,"add","(II)I");
-    int result = env -> CallIntMethod(mainActivityThis,methodId,2,6);
+static void call_add_method(JNIEnv *env, jobject mainActivityThis) {
+    const JniCache &cache = jni_cache();
+    /**
+     * 以前：jmethodID methodId = env -> GetMethodID(mainActivityClass,"add","(II)I");
+     *      int result = env -> CallIntMethod(mainActivityThis,methodId,2,6);
+     * 现在：mainAddMid的类型是jni::Method<jint(jint, jint)>，签名"(II)I"在编译期生成，
+     *      调用时自动选择CallIntMethod，见jni-typed.h
+     */
+    int result = cache.mainAddMid(env, mainActivityThis, 2, 6);
     LOGD("add_result = %d\n",result)
 
     //todo 调用main中的showString()函数
-    jmethodID showStringMid = env -> GetMethodID(mainActivityClass,"showString", "(Ljava/lang/String;I)Ljava/lang/String;");
-    jstring value = env -> NewStringUTF("逅lee懈");
+    //LocalRef：出了作用域自动DeleteLocalRef
+    jni::LocalRef<jstring> value = jni::new_string_utf(env, "逅lee懈");
     //api: jobject   (*CallObjectMethod)(JNIEnv*, jobject, jmethodID, ...);  //...即多个参数
-    //class _jstring : public _jobject {};  继承关系
-    auto resultStr = (jstring)env -> CallObjectMethod(mainActivityThis, showStringMid, value, 9527);
-    const char * resultCharStr = env -> GetStringUTFChars(resultStr,NULL);
+    //class _jstring : public _jobject {};  继承关系。返回值类型为jstring，不需要再强转
+    jni::LocalRef<jstring> resultStr = cache.mainShowStringMid(env, mainActivityThis, value, 9527);
+    //以前：GetStringUTFChars + ReleaseStringUTFChars，每次malloc/free一个副本
+    //现在：GetStringUTFRegion写进线程的arena，函数返回时arena自动回退，见call-arena.h
+    ArenaScope arena;
+    const char * resultCharStr = arena.utf_chars(env, resultStr);
     LOGD("C++_showString_result = %s", resultCharStr)
-    env->ReleaseStringUTFChars(resultStr,resultCharStr);
 }
 
 //函数示例：JNI数组操作
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_testArrayAction(JNIEnv *env,
-                                                      jobject mainActivityThis,
-                                                      jintArray int_array,
-                                                      jobjectArray str_array) {
+static void test_array_action(JNIEnv *env,
+                              jobject mainActivityThis,
+                              jintArray int_array,
+                              jobjectArray str_array) {
     //遍历Int[]，即基本数据类型数组
     //api：GetArrayLength  获取数组的长度
     int intArrayLen = env->GetArrayLength(int_array);
-    for (int i = 0; i < intArrayLen; ++i) {
-        //参数二：NULL在C中就是0。而在C中，非0即true，即0 == false。此处传入false即不进行copy机制
-        jint * _intItem = env->GetIntArrayElements(int_array,NULL);
-
-        *(_intItem + i) = i + 10001;
-        LOGD("C++_IntArray_Item: %d\n" , *(_intItem + i))
-
-        /**
-         * C语言很重要的一点：释放工作，一定要做
-         *
-         * api：void ReleaseIntArrayElements(jintArray array, jint* elems,jint mode)
-         *   @mode: (操纵杆 == JNIEnv)
-         *      JNI_OK: 先用操纵杆将数据刷新到JVM，再释放C++数组
-         *      JNI_COMMIT: 仅使用操纵杆刷新数据到JVM
-         *      JNI_ABORT: 仅释放C++数组
-         *
-         * 上面这行代码 *(_intItem + i) = i + 10001; 修改了C++中的值，
-         * 并且使用了mode = JNI_OK，故会将修改的值传给Java层
-         */
-        env->ReleaseIntArrayElements(int_array, _intItem, JNI_OK);
+    /**
+     * 错误写法：在循环里面每次都 GetIntArrayElements / ReleaseIntArrayElements，
+     *      n个元素的数组就会被锁定(或拷贝)n次
+     * 正确写法：循环外一次性获取，循环结束后一次性释放，见array-bridge.h
+     *
+     * api：void ReleaseIntArrayElements(jintArray array, jint* elems,jint mode)
+     *   @mode: (操纵杆 == JNIEnv)
+     *      0(JNI_OK): 先用操纵杆将数据刷新到JVM，再释放C++数组
+     *      JNI_COMMIT: 仅使用操纵杆刷新数据到JVM
+     *      JNI_ABORT: 仅释放C++数组(只读数据时使用，避免无用的拷贝)
+     *
+     * 下面的代码 intItems[i] = i + 10001; 修改了C++中的值，
+     * 所以使用ArrayAccess::ReadWrite，释放时mode = 0，会将修改的值传给Java层
+     */
+    {
+        PrimitiveArray<jint> intItems(env, int_array, ArrayAccess::ReadWrite, intArrayLen);
+        jint * _intItem = intItems.data();
+        for (int i = 0; _intItem && i < intArrayLen; ++i) {
+            _intItem[i] = i + 10001;
+        }
+    }//出了作用域就会释放，数据写回Java
+    {
+        //只读：释放时mode = JNI_ABORT，不会再拷贝回Java
+        PrimitiveArray<jint> intItems(env, int_array, ArrayAccess::ReadOnly, intArrayLen);
+        for (int i = 0; intItems.data() && i < intArrayLen; ++i) {
+            LOGD("C++_IntArray_Item: %d\n" , intItems.data()[i])
+        }
     }
 
     //遍历String[]，即引用类型数组
-    int strArrayLen = env->GetArrayLength(str_array);
+    /**
+     * 以前的写法：每个元素 GetObjectArrayElement + GetStringUTFChars + Release + NewStringUTF
+     *      + SetObjectArrayElement，修改后再取一次、解码一次只为了打印，局部引用一直累积
+     * 现在：一次性打包为连续的UTF-8(见string-batch.h)，"hello item"只创建一次
+     *      before每个线程一个，小数组不再每次调用都分配；函数返回时trim()，超过kStringScratchBytes的缓冲区被释放
+     */
+    static thread_local PackedStrings before;
+    struct TrimOnReturn {
+        ~TrimOnReturn() { before.trim(kStringScratchBytes); }
+    } trimOnReturn;
+    if (!pack_string_array(env, str_array, before)) {
+        return;
+    }
+    for (size_t i = 0; i < before.size(); ++i) {
+        LOGD("修改前：C++_strArray_Item = %.*s", (int) before.length(i), before.data(i))
+    }
+
+    /** 对引用数组的元素进行修改 */
+    int strArrayLen = (int) before.size();
+    //常量池中的全局引用，不需要(也不能)DeleteLocalRef
+    jstring _value = JNI_INTERN(env, "hello item");
+    if (!_value) {
+        return;
+    }
     for (int i = 0; i < strArrayLen; ++i) {
-        auto strItem = (jstring)env->GetObjectArrayElement(str_array, i);
-        const char * _str_item = env->GetStringUTFChars(strItem, NULL);
-        LOGD("修改前：C++_strArray_Item = %s",_str_item)
-        //todo JNI函数使用很重要的一点：释放工作，一定要做，这样才专业
-        env->ReleaseStringUTFChars(strItem, _str_item);
-
-        /** 对引用数组的元素进行修改 */
-        jstring _value = env->NewStringUTF("hello item");
         env->SetObjectArrayElement(str_array, i , _value);
-        /** 获取修改后的元素并进行打印 */
-        auto strItem2 = (jstring)env->GetObjectArrayElement(str_array , i);
-        const char * _str_item2 = env->GetStringUTFChars(strItem2, NULL);
-        LOGD("修改后：C++_strArray_Item = %s",_str_item2)
-        //todo JNI函数使用很重要的一点：释放工作，一定要做，这样才专业
-        env->ReleaseStringUTFChars(strItem2, _str_item2);
     }
-
+    //修改后的值都是同一个_value，不需要再从数组里取出来解码
+    LOGD("修改后：C++_strArray_Item = hello item (共%d个)", strArrayLen)
 }
 
 //函数示例：JNI对象操作
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_putStudent(JNIEnv *env, jobject mainActivityThis,
-                                                 jobject student, jstring str) {
+static void put_student(JNIEnv *env, jobject mainActivityThis,
+                        jobject student, jstring str) {
     //先搞定简单的jstring
-    const char * _str = env->GetStringUTFChars(str, nullptr);
+    //以前：三次GetStringUTFChars + ReleaseStringUTFChars，每次都malloc/free一个副本
+    //现在：都写进线程的arena，出了作用域一次性回退，不需要逐个Release，见call-arena.h
+    ArenaScope arena;
+    const char * _str = arena.utf_chars(env, str);
     LOGD("C++_str = %s",_str)
-    //todo JNI函数使用很重要的一点：释放工作，一定要做，这样才专业
-    env->ReleaseStringUTFChars(str, _str);
 
-    //todo 记得要释放
-    jclass stuClass = env->FindClass("com/sawyer/studyjni/Student");
+    //Student的jclass、jmethodID都从缓存中取，不再每次FindClass、GetMethodID
+    const JniCache &cache = jni_cache();
+    jclass stuClass = cache.studentClass;
 
     //调用Java层的toString()
-    jmethodID toStringMid = env -> GetMethodID(stuClass,"toString","()Ljava/lang/String;");
-    auto toStringStr = (jstring)env -> CallObjectMethod(student, toStringMid);
-    const char * _to_string_char = env -> GetStringUTFChars(toStringStr, nullptr);
+    jni::LocalRef<jstring> toStringStr = cache.studentToStringMid(env, student);
+    const char * _to_string_char = arena.utf_chars(env, toStringStr);
     LOGD("C++_toString_str = %s", _to_string_char)
-    env->ReleaseStringUTFChars(toStringStr, _to_string_char);
 
     //调用Java层的setName()
-    jmethodID setNameMid = env->GetMethodID(stuClass,"setName","(Ljava/lang/String;)V");
-    jstring nameStr = env->NewStringUTF("kobe");
-    env->CallVoidMethod(student, setNameMid, nameStr);
+    cache.studentSetNameMid(env, student, JNI_INTERN(env, "kobe"));
 
     //调用Java层的getName()
-    jmethodID getNameMid = env->GetMethodID(stuClass,"getName","()Ljava/lang/String;");
-    auto nameStrResult = (jstring)env->CallObjectMethod(student,getNameMid);
-    const char * _name_str_result = env->GetStringUTFChars(nameStrResult, nullptr);
+    jni::LocalRef<jstring> nameStrResult = cache.studentGetNameMid(env, student);
+    const char * _name_str_result = arena.utf_chars(env, nameStrResult);
     LOGD("C++_getName_str = %s", _name_str_result)
-    env->ReleaseStringUTFChars(nameStrResult, _name_str_result);
 
     //调用Java层的setAge()
-    jmethodID setAgeMid = env->GetMethodID(stuClass,"setAge","(I)V");
-    env->CallVoidMethod(student, setAgeMid, 41);
+    cache.studentSetAgeMid(env, student, 41);
 
     //调用Java层的getAge()
-    jmethodID getAgeMid = env->GetMethodID(stuClass,"getAge","()I");
-    int ageResult = env->CallIntMethod(student,getAgeMid);
+    int ageResult = cache.studentGetAgeMid(env, student);
     LOGD("C++_getAge = %d", ageResult)
 
     //调用Java层的 showInfo()#Student
-    jmethodID showInfoMid = env->GetStaticMethodID(stuClass, "showInfo", "(Ljava/lang/String;)V");
-    jstring showInfoStr = env->NewStringUTF("像我这样优秀的人");
-    env->CallStaticVoidMethod(stuClass, showInfoMid, showInfoStr);
+    //非ASCII的字面量由常量池按UTF-16创建，不经过NewStringUTF的Modified UTF-8
+    cache.studentShowInfoMid(env, stuClass, JNI_INTERN(env, "像我这样优秀的人"));
 
     //todo JNI函数使用很重要的一点：释放工作，一定要做，这样才专业
-    // 由于NewStringUTF没有对应的Releasexxx()
-    env->DeleteLocalRef(nameStr);
-    env->DeleteLocalRef(showInfoStr);
-    env->DeleteLocalRef(stuClass);
+    // 由于NewStringUTF没有对应的Releasexxx()，以前要在这里逐个DeleteLocalRef，
+    // 现在toStringStr等由jni::LocalRef在析构时自动完成，字符串常量来自常量池，不需要释放
+    //stuClass是缓存中的全局引用，由JNI_OnUnload统一释放，这里不能DeleteLocalRef
 }
 //函数示例：JNI凭空创建Java对象
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_insertObject(JNIEnv *env, jobject mainActivityThis) {
+//每个字段一次上行调用；需要传递整个Person/Student对象图时用GraphCodec一次传递，见graph-codec.h
+static void insert_object(JNIEnv *env, jobject mainActivityThis) {
 
-    jclass personClass = env->FindClass("com/sawyer/studyjni/Person");
-    jobject personObj = env->AllocObject(personClass);
+    const JniCache &cache = jni_cache();
+    jclass personClass = cache.personClass;
+    jni::LocalRef<jobject> personObj(env, env->AllocObject(personClass));
     //获取student对象
-    jclass studentClass = env->FindClass("com/sawyer/studyjni/Student");
-    jobject studentObj = env->AllocObject(studentClass);
+    jclass studentClass = cache.studentClass;
+    jni::LocalRef<jobject> studentObj(env, env->AllocObject(studentClass));
     //给student对象赋值
-    jmethodID setNameMid = env->GetMethodID(studentClass,"setName", "(Ljava/lang/String;)V");
-    auto stuName = (jstring) env->NewStringUTF("唐三");
-    env->CallVoidMethod(studentObj, setNameMid, stuName);
-    jmethodID setAgeMid = env->GetMethodID(studentClass,"setAge", "(I)V");
-    env->CallVoidMethod(studentObj, setAgeMid, 100);
+    cache.studentSetNameMid(env, studentObj, JNI_INTERN(env, "唐三"));
+    cache.studentSetAgeMid(env, studentObj, 100);
 
-    //调用Java Person对象的setStudent()
-    jmethodID setStuMid = env->GetMethodID(personClass,"setStudent", "(Lcom/sawyer/studyjni/Student;)V");
-    env->CallVoidMethod(personObj, setStuMid, studentObj);
+    //调用Java Person对象的setStudent()，签名(Lcom/sawyer/studyjni/Student;)V由类型生成
+    cache.personSetStudentMid(env, personObj, studentObj);
 
     //调用Java Person对象的putStudent()
-    jmethodID putStuMid = env->GetStaticMethodID(personClass,"putStudent","(Lcom/sawyer/studyjni/Student;)V");
-    env->CallStaticVoidMethod(personClass, putStuMid,studentObj);
+    cache.personPutStudentMid(env, personClass, studentObj);
 
     //todo JNI函数使用很重要的一点：释放工作，一定要做，这样才专业
-    //DeleteLocalRef: 释放局部变量
+    //DeleteLocalRef: 释放局部变量 ---> jni::LocalRef析构时自动调用
     //DeleteGlobalRef: 释放全局变量
-    env->DeleteLocalRef(personClass);
-    env->DeleteLocalRef(personObj);
-    env->DeleteLocalRef(studentClass);
-    env->DeleteLocalRef(studentObj);
-    env->DeleteLocalRef(stuName);
+    //personClass、studentClass是缓存中的全局引用，不能DeleteLocalRef
 }//此函数弹栈后，也会去释放内存，但为什么在上面要去做释放工作呢？
 //答：若此函数有成千上万行代码，等到函数弹栈后再释放，就有可能导致内存释放不及时，不够用的情况
 
-jclass dogClass = nullptr;  //此处的dogClass仍然是局部引用
-
 /**
  *函数示例：JNI全局引用、局部引用
  * 默认情况下，是局部引用，在JNI函数执行结束后，会自动回收局部引用。但是，还是要养成时时刻刻及时回收内存的好习惯
  * 全局引用：需要我们手动去提升为全局引用。提升为全局引用后，必须我们自己手动释放。
  * 所以通常情况下，会在Activity的onDestroy()中释放全局引用
+ *
+ * dogClass的全局引用现在由jni-cache.cpp在JNI_OnLoad中创建：
+ *      jclass tempDogClass = env->FindClass("com/sawyer/studyjni/Dog"); //局部引用
+ *      dogClass = (jclass) env->NewGlobalRef( (jobject)tempDogClass );//class _jclass : public _jobject {};
+ *      env->DeleteLocalRef(tempDogClass);
  */
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_testQuote(JNIEnv *env, jobject mainActivityThis) {
-    if (!dogClass){ // 等价于 dogClass == NULL
-        //dogClass = env->FindClass("com/sawyer/studyjni/Dog"); 局部引用
-
-        //提升dogClass为全局引用,JNI函数执行完后不会被释放
-        jclass tempDogClass = env->FindClass("com/sawyer/studyjni/Dog");
-        dogClass = (jclass) env->NewGlobalRef( (jobject)tempDogClass );//class _jclass : public _jobject {};
-        env->DeleteLocalRef(tempDogClass);
-    }
+static void test_quote(JNIEnv *env, jobject mainActivityThis) {
+    const JniCache &cache = jni_cache();
+    jclass dogClass = cache.dogClass;
 
-    //<init> == 构造函数名
-    jmethodID dogMid1 = env->GetMethodID(dogClass, "<init>", "()V");
-    //NewObject() == 调用构造函数
-    jobject dog1 = env->NewObject(dogClass, dogMid1); //无参构造
+    //<init> == 构造函数名，三个构造函数的jmethodID也已缓存
+    //NewObject() == 调用构造函数，返回的局部引用由jni::LocalRef自动释放
+    jni::LocalRef<jobject> dog1 = cache.dogInitMid(env, dogClass); //无参构造
 
-    jmethodID dogMid2 = env->GetMethodID(dogClass, "<init>", "(I)V"); //一个参数构造方法
-    jobject dog2 = env->NewObject(dogClass, dogMid2, 666);
+    jni::LocalRef<jobject> dog2 = cache.dogInitIMid(env, dogClass, 666); //一个参数构造方法
 
-    jmethodID dogMid3 = env->GetMethodID(dogClass, "<init>", "(II)V"); //两个参数构造方法
-    jobject dog3 = env->NewObject(dogClass, dogMid3, 33, 99);
+    jni::LocalRef<jobject> dog3 = cache.dogInitIIMid(env, dogClass, 33, 99); //两个参数构造方法
 }//若不提升为全局引用，在JNI函数弹栈后，会自动释放局部引用dogClass，但是dogClass不会指向NULL，会指向一个别的系统值。故第二次调用该函数会发生崩溃
 
 //函数示例：JNI释放全局引用
-extern "C" JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_deleteQuote(JNIEnv *env, jobject mainActivityThis) {
-    if (dogClass) {  // 等价于 dogClass ！= NULL
-        env->DeleteGlobalRef(dogClass);
-        dogClass = nullptr;  //全局引用被释放后，其指向依然不会指向NULL，多次调用依然会崩溃
-        LOGD("成功手动释放全局引用！")
+static void delete_quote(JNIEnv *env, jobject mainActivityThis) {
+    //dogClass归JNI ID缓存所有，若在这里DeleteGlobalRef，其它函数再使用缓存就会崩溃
+    //统一在JNI_OnUnload -> jni_cache_release()中释放
+    if (jni_cache_ready()) {
+        LOGD("dogClass全局引用由JNI_OnUnload统一释放！")
     }else {
         LOGD("全局引用已经被释放了！")
     }
@@ -318,36 +332,34 @@ JavaVM* jvm = nullptr;
  * 方式一：void dynamicJavaMethod01(JNIEnv * env, jobject mainThis)
  * 方式二：void dynamicJavaMethod01()
  * 里面的参数写不写：取决于要不要使用该参数。如果不使用，可以省略
+ * 注意：jni::native_method会在编译期检查函数类型，所以现在只能用方式一
 */
-void dynamic_java_method01(){
+static void dynamic_java_method01(JNIEnv * env, jobject mainThis){
     LOGD("动态注册的函数，method01在C++中的实现完成了！")
 }
 
-jint dynamic_java_method02(JNIEnv * env, jobject mainThis, jstring str){
-    const char * str_ = env->GetStringUTFChars(str, nullptr);
+static jint dynamic_java_method02(JNIEnv * env, jobject mainThis, jstring str){
+    ArenaScope arena;
+    const char * str_ = arena.utf_chars(env, str);
     LOGD("Java传递给C的字符串为：%s",str_)
-    env->ReleaseStringUTFChars(str,str_);
     return 6;
 }
 
-/**
- * jni.h中的定义：
-    typedef struct {
-        const char* name;       //Java中动态注册的函数名
-        const char* signature;  //Java中动态注册的函数的签名
-        void* fnPtr;            //函数指针，即C++的函数名
-    } JNINativeMethod;
-*/
-static const JNINativeMethod methods[] = {
-        {"dynamicJavaMethod01", "()V", (void *)(dynamic_java_method01)},
-        {"dynamicJavaMethod02", "(Ljava/lang/String;)I", (jint *)(dynamic_java_method02)}
+//JNI_OnLoad各阶段的耗时，MainActivity.nativeStartupStats()返回给Java
+struct StartupStats {
+    jlong onLoadNs = 0;     //JNI_OnLoad总耗时
+    jlong cacheNs = 0;      //jni_cache_init
+    jlong registerNs = 0;   //register_all_natives
+    jint methodCount = 0;   //注册的native函数个数
 };
+static StartupStats startupStats;
 
 /**
  *此函数类似Java对象的无参构造函数，不写的话本就存在，写出来会覆盖默认的
  * java层的System.loadLibrary("studyjni");执行时就会调用此函数
  */
-jint JNI_OnLoad(JavaVM* javaVm, void* args){
+JNIEXPORT jint JNI_OnLoad(JavaVM* javaVm, void* args){
+    jlong start = now_ns();
     ::jvm = javaVm;
 
     JNIEnv* env = nullptr;
@@ -360,156 +372,275 @@ jint JNI_OnLoad(JavaVM* javaVm, void* args){
         return -1; //故意让程序崩溃
     }
 
-    jclass mainActClass = env->FindClass("com/sawyer/studyjni/MainActivity");
+    //一次性查找所有jclass、jmethodID、jfieldID，之后所有JNI函数都直接使用缓存
+    if (!jni_cache_init(env)){
+        return -1;
+    }
+    jlong cacheDone = now_ns();
+
     /**
-     * api:jint RegisterNatives(jclass clazz, const JNINativeMethod* methods,jint nMethods)
-     * 作用：一次性可动态注册多个JNI函数
-     * @jclass: native函数存在于哪个类中
-     * @methods: 所有要动态注册的函数，所存放的数组
-     * @nMethods: 数组中函数的个数，可以用这样的计算方式：sizeof(methods)/sizeof(JNINativeMethod)
+     * 一次性注册所有Java类的native函数，见jni-register.h
+     * 任何一个函数注册失败都是致命错误：返回JNI_ERR，System.loadLibrary会抛出UnsatisfiedLinkError，
+     * 而不是等到第一次调用时才抛出
      */
-    env->RegisterNatives(mainActClass, methods, sizeof(methods)/sizeof(JNINativeMethod));
+    jint methodCount = 0;
+    if (!register_all_natives(env, &methodCount)){
+        LOGE("JNI_OnLoad: 注册native函数失败")
+        jni_cache_release(env);
+        trace_flush(); //进程可能马上退出，先输出日志
+        return JNI_ERR;
+    }
+    jlong end = now_ns();
+
+    startupStats.onLoadNs = end - start;
+    startupStats.cacheNs = cacheDone - start;
+    startupStats.registerNs = end - cacheDone;
+    startupStats.methodCount = methodCount;
+    LOGI("JNI_OnLoad: 总耗时 = %lldns, ID缓存 = %lldns, 注册%d个native函数 = %lldns",
+         (long long) startupStats.onLoadNs, (long long) startupStats.cacheNs, methodCount,
+         (long long) startupStats.registerNs)
 
     return JNI_VERSION_1_6; //一般会使用最新的版本标记
 }
 
+/**
+ * 与JNI_OnLoad对应，加载so的ClassLoader被回收时调用
+ * 在这里释放JNI_OnLoad中创建的全局引用
+ */
+JNIEXPORT void JNI_OnUnload(JavaVM* javaVm, void* args){
+    JNIEnv* env = nullptr;
+    if (javaVm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK){
+        return;
+    }
+    CallbackDispatcher::instance().stop(env); //分发线程会使用缓存中的jmethodID，要先停止
+    AsyncCalls::instance().releaseAll();      //还没通知的完成结果不再回调Java
+    WorkerPool::instance().shutdown();        //执行完已提交的任务(会使用缓存)，再回收工作线程
+    WorkStealingPool::instance().shutdown();  //ParallelArrays的计算线程
+    jni_cache_release(env);
+    jni_intern_release(env);
+    HandleTable::instance().removeAll(env);
+    ::jvm = nullptr;
+    trace_shutdown(); //so被卸载前停止后台线程，并输出所有缓冲的日志
+}
+
 //==================================JNI线程操作===============================
 class MyContext {
 public:
     //JNIEnv *jniEnv = nullptr; //不能跨线程传递JNIEnv。否则会奔溃
-    jobject instance = nullptr; //局部成员不能跨线程、跨函数。否则会奔溃
+    //jobject instance = nullptr; //局部成员不能跨线程、跨函数。否则会奔溃
+    jlong instance = 0; //MainActivity的弱引用句柄，见handle-table.h
 };
 
+//MyContext在UI线程创建、在工作线程释放，不能用线程的arena，放进对象池复用
+//不释放：进程退出时工作线程可能还在归还对象
+static ObjectPool<MyContext, 64> &context_pool() {
+    static auto *pool = new ObjectPool<MyContext, 64>();
+    return *pool;
+}
+
 /**
- * pthread_create()的第三个参数,函数指针，相当于Java线程的run函数
- * @args: pthread_create()的第四个参数
- * void * ：相当于Java的object，即可以进行所有的类型转换
+ * 在线程池的工作线程中执行(以前是pthread_create()的第三个参数,函数指针，相当于Java线程的run函数)
+ * @asyncEnv: 工作线程自己的JNIEnv。工作线程创建时已经通过jvm附加了JNIEnv，并且只附加一次，
+ *            不再需要每次都 AttachCurrentThread / DetachCurrentThread，见worker-pool.h
  */
-void * cpp_thread_run(void * args){
-    auto * context = static_cast<MyContext *>(args);
-    //从全局成员jvm中获取JNIEnv，需要通过jvm创建当前线程的JNIEnv，即子线程附加自己的JNIEnv
-    JNIEnv * asyncEnv ;
-    jint result = ::jvm->AttachCurrentThread(reinterpret_cast<JNIEnv **>(&asyncEnv), nullptr);
-    if (result){  //C++返回结果为0表示成功，而C++中非0即true
-        return nullptr;
-    }
-
+void cpp_thread_run(JNIEnv * asyncEnv, MyContext * context){
     /**
      * todo 前面的代码所做的工作:
-     *      1.给子线程附加JNIEnv
+     *      1.给子线程附加JNIEnv(线程池完成)
      *      2.将MainActivity提升为全局成员
      * 所以当前函数cpp_thread_run()所在的子线程，才可以去调用主线程的函数
      */
-    jclass mainClass = asyncEnv->GetObjectClass(context->instance);
-    jmethodID nativeThreadMid = asyncEnv->GetMethodID(mainClass,"updateActivityUI","()V");
-    asyncEnv->CallVoidMethod(context->instance, nativeThreadMid);
-
-    //解除当前线程所附加的JNIEnv
-    ::jvm->DetachCurrentThread();
-
-    return nullptr; //必须要返回0,否则程序会崩溃
+    /**
+     * 分发器已启动：只投递一个事件，不调用JNI。多个事件会被合并，Java每帧最多处理一次
+     * value为序号，Java端可以据此知道合并前一共产生了多少次更新
+     */
+    static std::atomic<int64_t> sUpdateSeq(0);
+    int64_t seq = sUpdateSeq.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (CallbackDispatcher::instance().post(kEventUpdateUI, 0, seq)) {
+        return;
+    }
+    //分发器没有启动，退回到直接调用
+    //jmethodID与线程无关，可以直接使用缓存
+    jmethodID nativeThreadMid = jni_cache().mainUpdateUIMid;
+    //Activity已经被回收(或者句柄已经释放)时什么都不做，而不是用失效的引用崩溃
+    HandleTable::instance().with(asyncEnv, context->instance, [&](jobject instance) {
+        asyncEnv->CallVoidMethod(instance, nativeThreadMid);
+    });
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_nativeThread(JNIEnv *env, jobject mainActivityThis) {
+static void native_thread(JNIEnv *env, jobject mainActivityThis) {
     //此函数nativeThread()默认运行在主线程中，即Android UI线程
     /*jclass mainClass = env->GetObjectClass(mainActivityThis);
     jmethodID nativeThreadMid = env->GetMethodID(mainClass,"nativeThread","()V");
     env->CallVoidMethod(mainActivityThis, nativeThreadMid);*/
 
-    auto * context = new MyContext;
+    //以前：auto * context = new MyContext; 每次调用一次new/delete
+    MyContext * context = context_pool().acquire();
+    if (!context) {
+        LOGE("nativeThread: 分配MyContext失败")
+        return;
+    }
     //context->jniEnv是局部成员。并且线程之间不能直接传递env,即每个线程都附加了自己的env，不能传递给别的线程使用
     //context->jniEnv = env;
     //context->instance = mainActivityThis; //context->instance是局部成员
-    //提升context->instance为全局成员
-    context->instance = env->NewGlobalRef(mainActivityThis);
+    //以前：context->instance = env->NewGlobalRef(mainActivityThis); 每次调用一个新的全局引用，并且强引用着Activity
+    //现在：放进句柄表，弱引用不阻止Activity被回收，槽位释放后复用
+    context->instance = HandleTable::instance().put(env, mainActivityThis, HandleKind::Weak);
 
     /**
-     * C语言创建线程的方式：
-     * int pthread_create(
-     *          pthread_t* __pthread_ptr,        //线程标记ID
-     *          pthread_attr_t const* __attr,    //pthread配置的参数集，一般用不到
-     *          void* (*__start_routine)(void*), //函数指针，相当于Java线程的run()
-     *          void*                            //参数四会传递给参数三，作为函数指针的形参
-     * );
+     * 以前的写法：每次都创建一个线程，并且马上pthread_join等待，实际上还是同步的
+     *      pthread_t pid;
+     *      pthread_create(&pid, nullptr, cpp_thread_run, context);
+     *      pthread_join(pid,nullptr);
+     * 现在：提交给常驻线程池后立即返回，释放工作在任务执行完之后、在工作线程中完成
      */
-    pthread_t pid;
-    pthread_create(&pid, nullptr, cpp_thread_run, context);
-
-    //相当于Java的守护，即等待子线程工作做完
-    //目的：为了下边的释放工作能在子线程工作做完后，再去释放内存。否则，程序会崩溃
-    pthread_join(pid,nullptr);
-
-    //todo 释放内存的工作
-    env->DeleteGlobalRef(context->instance); //释放全局成员
-    delete context; //释放对象
-    context = nullptr;  //防止悬空指针
+    bool submitted = WorkerPool::instance().submit([context](JNIEnv * asyncEnv){
+        cpp_thread_run(asyncEnv, context);
+        //todo 释放内存的工作。全局引用可以在任意线程释放
+        HandleTable::instance().remove(asyncEnv, context->instance); //释放全局成员
+        context_pool().release(context); //释放对象：放回对象池
+    });
+    if (!submitted){
+        HandleTable::instance().remove(env, context->instance);
+        context_pool().release(context);
+        context = nullptr;  //防止悬空指针
+        LOGE("nativeThread: 提交任务失败")
+    }
 }
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_closeThread(JNIEnv *env, jobject mainActivityThis) {
-    //todo 做释放工作,释放全局引用
+static void close_thread(JNIEnv *env, jobject mainActivityThis) {
+    //执行完已提交的任务(任务中会释放全局引用)，再停止线程池，工作线程退出时自动DetachCurrentThread
+    //线程池是进程级的(NativeAsync、MappedFile.prefetchAsync也在用)，只在App退出时调用；JNI_OnUnload也会停止
+    WorkerPool::instance().shutdown();
 }
 
 
 //=======================研究JavaVM、JNIEnv在不同线程的作用域=======================
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_nativeFun1(JNIEnv *env, jobject thiz) {
+static void native_fun1(JNIEnv *env, jobject thiz) {
     JavaVM * javaVm = nullptr;
     env->GetJavaVM(&javaVm);
     LOGD("nativeFun1: JNIEnv地址 = %p, jvm地址 = %p, jobject地址 = %p, JNI_OnLoad的jvm地址 = %p",
          env, javaVm, thiz, ::jvm)
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_nativeFun2(JNIEnv *env, jobject thiz) {
+static void native_fun2(JNIEnv *env, jobject thiz) {
     JavaVM * javaVm = nullptr;
     env->GetJavaVM(&javaVm);
     LOGD("nativeFun2: JNIEnv地址 = %p, jvm地址 = %p, jobject地址 = %p, JNI_OnLoad的jvm地址 = %p",
          env, javaVm, thiz, ::jvm)
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_staticFun3(JNIEnv *env, jclass clazz) {
+static void static_fun3(JNIEnv *env, jclass clazz) {
     JavaVM * javaVm = nullptr;
     env->GetJavaVM(&javaVm);
     LOGD("staticFun3: JNIEnv地址 = %p, jvm地址 = %p, jclass地址 = %p, JNI_OnLoad的jvm地址 = %p",
          env, javaVm, clazz, ::jvm)
 }
 
-void * run(void *){
-    JNIEnv * env = nullptr;
-    ::jvm->AttachCurrentThread(&env, nullptr);
+//在线程池的工作线程中执行，env是工作线程一生只附加一次的JNIEnv
+void run(JNIEnv * env){
     LOGD("C++子线程：JNIEnv地址 = %p, jvm地址 = %p", env, ::jvm)
-    ::jvm->DetachCurrentThread();
-    return nullptr;
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_MainActivity_staticFun4(JNIEnv *env, jclass clazz) {
+static void static_fun4(JNIEnv *env, jclass clazz) {
     JavaVM * javaVm = nullptr;
     env->GetJavaVM(&javaVm);
     LOGD("staticFun4: JNIEnv地址 = %p, jvm地址 = %p, jclass地址 = %p, JNI_OnLoad的jvm地址 = %p",
          env, javaVm, clazz, ::jvm)
 
-    pthread_t pid;
-    pthread_create(&pid, nullptr, run, nullptr);
+    //以前：pthread_create(&pid, nullptr, run, nullptr); 线程从来没有被join，也没有detach
+    if (!WorkerPool::instance().submit(run)) {
+        LOGE("staticFun4: 提交任务失败")
+    }
 }
 
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_sawyer_studyjni_SecondActivity_nativeFun5(JNIEnv *env, jobject thiz) {
+static void native_fun5(JNIEnv *env, jobject thiz) {
     JavaVM * javaVm = nullptr;
     env->GetJavaVM(&javaVm);
     LOGD("nativeFun5: JNIEnv地址 = %p, jvm地址 = %p, jobject地址 = %p, JNI_OnLoad的jvm地址 = %p",
          env, javaVm, thiz, ::jvm)
 }
 
+//===============================JNI ID缓存基准测试===========================
+/**
+ * 对比：每次调用都FindClass + GetMethodID，与直接使用缓存的jmethodID，调用同一个Java函数getAge()的耗时
+ * 返回：[未缓存的单次耗时ns, 缓存后的单次耗时ns]
+ */
+static jlongArray bench_id_cache(JNIEnv *env, jobject thiz, jobject student, jint rounds) {
+    if (rounds <= 0){
+        rounds = 1;
+    }
+    volatile jint sink = 0; //防止调用结果被编译器优化掉
+
+    jlong start = now_ns();
+    for (int i = 0; i < rounds; ++i) {
+        jclass stuClass = env->FindClass("com/sawyer/studyjni/Student");
+        jmethodID getAgeMid = env->GetMethodID(stuClass, "getAge", "()I");
+        sink = sink + env->CallIntMethod(student, getAgeMid);
+        env->DeleteLocalRef(stuClass);
+    }
+    jlong uncachedNs = now_ns() - start;
+
+    jmethodID cachedMid = jni_cache().studentGetAgeMid;
+    start = now_ns();
+    for (int i = 0; i < rounds; ++i) {
+        sink = sink + env->CallIntMethod(student, cachedMid);
+    }
+    jlong cachedNs = now_ns() - start;
+
+    jlong result[] = {uncachedNs / rounds, cachedNs / rounds};
+    LOGD("benchIdCache: rounds = %d, 未缓存 = %lldns/次, 缓存 = %lldns/次",
+         rounds, (long long) result[0], (long long) result[1])
+    jlongArray resultArray = env->NewLongArray(2);
+    env->SetLongArrayRegion(resultArray, 0, 2, result);
+    return resultArray;
+}
+
+/**
+ * 对比：原始JNI调用与jni-typed.h的类型化调用的耗时，两者应该一样(类型化调用编译后就是原始调用)
+ * 返回：[原始CallIntMethod, 类型化getAge(), 原始CallObjectMethod + DeleteLocalRef, 类型化getName()]，单位ns/次
+ */
+static jlongArray bench_typed_call(JNIEnv *env, jobject thiz, jobject student, jint rounds) {
+    if (rounds <= 0){
+        rounds = 1;
+    }
+    const JniCache &cache = jni_cache();
+    volatile jint sink = 0;
+    jlong result[4];
+
+    jmethodID rawGetAge = cache.studentGetAgeMid.id();
+    jlong start = now_ns();
+    for (int i = 0; i < rounds; ++i) {
+        sink = sink + env->CallIntMethod(student, rawGetAge);
+    }
+    result[0] = (now_ns() - start) / rounds;
+
+    start = now_ns();
+    for (int i = 0; i < rounds; ++i) {
+        sink = sink + cache.studentGetAgeMid(env, student);
+    }
+    result[1] = (now_ns() - start) / rounds;
+
+    jmethodID rawGetName = cache.studentGetNameMid.id();
+    start = now_ns();
+    for (int i = 0; i < rounds; ++i) {
+        auto name = (jstring) env->CallObjectMethod(student, rawGetName);
+        sink = sink + (name != nullptr);
+        env->DeleteLocalRef(name);
+    }
+    result[2] = (now_ns() - start) / rounds;
+
+    start = now_ns();
+    for (int i = 0; i < rounds; ++i) {
+        jni::LocalRef<jstring> name = cache.studentGetNameMid(env, student);
+        sink = sink + (name.get() != nullptr);
+    }
+    result[3] = (now_ns() - start) / rounds;
+
+    LOGD("benchTypedCall: rounds = %d, int原始 = %lld, int类型化 = %lld, object原始 = %lld, object类型化 = %lld (ns/次)",
+         rounds, (long long) result[0], (long long) result[1], (long long) result[2], (long long) result[3])
+    return new_java_array(env, result, 4);
+}
+
 /**
  * 研究JavaVM、JNIEnv在不同线程的作用域 -----日志结果
  * nativeFun1: JNIEnv地址 = 0xb400007c6f8df500, jvm地址 = 0xb400007c6f8ad380, jobject地址 = 0x7ff5ea64c8, JNI_OnLoad的jvm地址 = 0xb400007c6f8ad380
@@ -524,4 +655,51 @@ Java_com_sawyer_studyjni_SecondActivity_nativeFun5(JNIEnv *env, jobject thiz) {
  *  2.JNIEnv是绑定Android主线程和子线程的，即Android的不同线程有自己的JNIEnv
  *  3.jobject是绑定当前实例的，即谁调用JNI函数，谁的实例会传给jobject
  *
- */
\ No newline at end of file
+ */
+//返回[JNI_OnLoad总耗时ns, ID缓存ns, 注册ns, 注册的函数个数]
+static jlongArray native_startup_stats(JNIEnv *env, jobject thiz) {
+    jlong result[] = {startupStats.onLoadNs, startupStats.cacheNs, startupStats.registerNs,
+                      startupStats.methodCount};
+    return new_java_array(env, result, 4);
+}
+
+//===============================native函数注册表===========================
+/**
+ * jni.h中的定义：
+    typedef struct {
+        const char* name;       //Java中动态注册的函数名
+        const char* signature;  //Java中动态注册的函数的签名
+        void* fnPtr;            //函数指针，即C++的函数名
+    } JNINativeMethod;
+ * 签名由模板参数在编译期生成，并检查C++函数的类型，见jni-register.h
+ */
+static const JNINativeMethod kMainActivityMethods[] = {
+        jni::native_method<jstring(), string_from_jni>("stringFromJNI"),
+        jni::native_method<void(), change_name>("changeName"),
+        jni::static_native_method<void(), change_age>("changeAge"),
+        jni::native_method<void(), change_num>("changeNum"),
+        jni::native_method<void(), call_add_method>("callAddMethod"),
+        jni::native_method<void(jintArray, jni::ObjectArray<jstring>), test_array_action>("testArrayAction"),
+        jni::native_method<void(StudentObject, jstring), put_student>("putStudent"),
+        jni::native_method<void(), insert_object>("insertObject"),
+        jni::native_method<void(), test_quote>("testQuote"),
+        jni::native_method<void(), delete_quote>("deleteQuote"),
+        jni::native_method<void(), dynamic_java_method01>("dynamicJavaMethod01"),
+        jni::native_method<jint(jstring), dynamic_java_method02>("dynamicJavaMethod02"),
+        jni::native_method<void(), native_thread>("nativeThread"),
+        jni::native_method<void(), close_thread>("closeThread"),
+        jni::native_method<void(), native_fun1>("nativeFun1"),
+        jni::native_method<void(), native_fun2>("nativeFun2"),
+        jni::static_native_method<void(), static_fun3>("staticFun3"),
+        jni::static_native_method<void(), static_fun4>("staticFun4"),
+        jni::native_method<jlongArray(StudentObject, jint), bench_id_cache>("benchIdCache"),
+        jni::native_method<jlongArray(StudentObject, jint), bench_typed_call>("benchTypedCall"),
+        jni::native_method<jlongArray(), native_startup_stats>("nativeStartupStats"),
+};
+
+static const JNINativeMethod kSecondActivityMethods[] = {
+        jni::native_method<void(), native_fun5>("nativeFun5"),
+};
+
+const NativeTable kMainActivityNatives = native_table(MainActivityClass::kName, kMainActivityMethods);
+const NativeTable kSecondActivityNatives = native_table("com/sawyer/studyjni/SecondActivity", kSecondActivityMethods);
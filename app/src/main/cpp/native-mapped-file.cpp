@@ -0,0 +1,170 @@
+#include <jni.h>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "async-calls.h"
+#include "jni-cache.h"
+#include "jni-register.h"
+#include "jni-util.h"
+#include "mapped-file.h"
+#include "string-batch.h"
+
+/**
+ * MappedFile.java 的JNI实现，见mapped-file.h
+ *
+ * Java端持有MappedFile的指针(jlong)，视图通过NewDirectByteBuffer直接指向映射的页
+ */
+
+static inline MappedFile *to_file(jlong handle) {
+    return reinterpret_cast<MappedFile *>(handle);
+}
+
+//检查[offset, offset + length)，不合法时抛出IndexOutOfBoundsException
+static bool check_range(JNIEnv *env, MappedFile *file, jlong offset, jlong length) {
+    if (offset < 0 || length < 0 || !file->contains((uint64_t) offset, (uint64_t) length)) {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "MappedFile: [%lld, +%lld) 超出映射范围 %zu",
+                 (long long) offset, (long long) length, file->size());
+        jni_throw(env, "java/lang/IndexOutOfBoundsException", msg);
+        return false;
+    }
+    return true;
+}
+
+static void throw_io(JNIEnv *env, const char *what, int error) {
+    char msg[160];
+    snprintf(msg, sizeof(msg), "MappedFile: %s失败: %s", what, strerror(error));
+    jni_throw(env, "java/io/IOException", msg);
+}
+
+static jlong native_open(JNIEnv *env, jclass clazz, jstring path, jboolean writable, jlong offset, jlong length) {
+    if (!path || offset < 0 || length < 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "MappedFile: path为null或offset、length为负数");
+        return 0;
+    }
+    //路径用GetStringRegion拷贝出UTF-16再转为标准UTF-8(GetStringUTFChars是Modified UTF-8，补充平面字符不对)
+    const jsize len = env->GetStringLength(path);
+    std::vector<jchar> utf16((size_t) len);
+    env->GetStringRegion(path, 0, len, utf16.data());
+    std::string utf8((size_t) len * 3, '\0');
+    utf8.resize(utf16_to_utf8(utf16.data(), (size_t) len, &utf8[0]));
+
+    int error;
+    MappedFile *file = MappedFile::open(utf8.c_str(), writable == JNI_TRUE, (uint64_t) offset, (uint64_t) length,
+                                        &error);
+    if (!file) {
+        throw_io(env, "mmap", error);
+        return 0;
+    }
+    return reinterpret_cast<jlong>(file);
+}
+
+static jlong native_size(JNIEnv *env, jclass clazz, jlong handle) {
+    return (jlong) to_file(handle)->size();
+}
+
+static jboolean native_writable(JNIEnv *env, jclass clazz, jlong handle) {
+    return to_file(handle)->writable() ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * 一个视图持有一个引用，Java关闭视图时调用nativeReleaseView
+ * DirectByteBuffer的容量是jlong，但ByteBuffer的下标是int，所以一个视图最多2GB
+ */
+static jobject native_view(JNIEnv *env, jclass clazz, jlong handle, jlong offset, jint length) {
+    MappedFile *file = to_file(handle);
+    if (!check_range(env, file, offset, length)) {
+        return nullptr;
+    }
+    file->acquire();
+    jobject buffer = env->NewDirectByteBuffer(file->data() + offset, (jlong) length);
+    if (!buffer) {
+        file->release();
+    }
+    return buffer;
+}
+
+static void native_release_view(JNIEnv *env, jclass clazz, jlong handle) {
+    to_file(handle)->release();
+}
+
+static jint native_refs(JNIEnv *env, jclass clazz, jlong handle) {
+    return (jint) to_file(handle)->refs();
+}
+
+//释放映射本身的引用；还有视图、异步预读没结束时，等它们结束后才munmap
+static void native_unmap(JNIEnv *env, jclass clazz, jlong handle) {
+    to_file(handle)->unmap();
+}
+
+static void native_advise(JNIEnv *env, jclass clazz, jlong handle, jlong offset, jlong length, jint advice) {
+    MappedFile *file = to_file(handle);
+    if (!check_range(env, file, offset, length)) {
+        return;
+    }
+    if (advice < 0 || advice > (jint) MapAdvice::DontNeed) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "MappedFile: advice不存在");
+        return;
+    }
+    int error = file->advise((size_t) offset, (size_t) length, (MapAdvice) advice);
+    if (error != 0) {
+        throw_io(env, "madvise", error);
+    }
+}
+
+//同步预读，返回读过的页数
+static jlong native_prefetch(JNIEnv *env, jclass clazz, jlong handle, jlong offset, jlong length) {
+    MappedFile *file = to_file(handle);
+    if (!check_range(env, file, offset, length)) {
+        return 0;
+    }
+    return (jlong) file->prefetch((size_t) offset, (size_t) length, nullptr);
+}
+
+/**
+ * 异步预读：在AsyncCalls的线程池中执行，完成时result为读过的页数
+ * 任务持有一个引用：即使任务还没执行就被取消、release，Job析构时也会释放
+ * @return: 异步任务的句柄，见NativeAsync.java；提交失败返回0
+ */
+static jlong native_prefetch_async(JNIEnv *env, jclass clazz, jlong handle, jlong offset, jlong length) {
+    MappedFile *file = to_file(handle);
+    if (!check_range(env, file, offset, length)) {
+        return 0;
+    }
+    file->acquire();
+    std::shared_ptr<MappedFile> ref(file, [](MappedFile *f) { f->release(); });
+    return AsyncCalls::instance().submit(
+            [ref, offset, length](JNIEnv *, const AsyncToken &token, jlong &result) {
+                result = (jlong) ref->prefetch((size_t) offset, (size_t) length, &token);
+                return token.cancelled() ? AsyncStatus::Cancelled : AsyncStatus::Done;
+            });
+}
+
+static void native_sync(JNIEnv *env, jclass clazz, jlong handle, jlong offset, jlong length, jboolean async) {
+    MappedFile *file = to_file(handle);
+    if (!check_range(env, file, offset, length)) {
+        return;
+    }
+    int error = file->sync((size_t) offset, (size_t) length, async == JNI_TRUE);
+    if (error != 0) {
+        throw_io(env, "msync", error);
+    }
+}
+
+static const JNINativeMethod kMappedFileMethods[] = {
+        jni::static_native_method<jlong(jstring, jboolean, jlong, jlong), native_open>("nativeOpen"),
+        jni::static_native_method<jlong(jlong), native_size>("nativeSize"),
+        jni::static_native_method<jboolean(jlong), native_writable>("nativeWritable"),
+        jni::static_native_method<jni::Object<ByteBufferClass>(jlong, jlong, jint), native_view>("nativeView"),
+        jni::static_native_method<void(jlong), native_release_view>("nativeReleaseView"),
+        jni::static_native_method<jint(jlong), native_refs>("nativeRefs"),
+        jni::static_native_method<void(jlong), native_unmap>("nativeUnmap"),
+        jni::static_native_method<void(jlong, jlong, jlong, jint), native_advise>("nativeAdvise"),
+        jni::static_native_method<jlong(jlong, jlong, jlong), native_prefetch>("nativePrefetch"),
+        jni::static_native_method<jlong(jlong, jlong, jlong), native_prefetch_async>("nativePrefetchAsync"),
+        jni::static_native_method<void(jlong, jlong, jlong, jboolean), native_sync>("nativeSync"),
+};
+
+const NativeTable kMappedFileNatives = native_table("com/sawyer/studyjni/MappedFile", kMappedFileMethods);
@@ -0,0 +1,105 @@
+#include <jni.h>
+#include "field-mirror.h"
+#include "jni-cache.h"
+#include "jni-register.h"
+#include "jni-util.h"
+
+/**
+ * FieldMirror.java 的JNI实现，见field-mirror.h
+ */
+
+//字段表，与FieldMirror.java的MAP_*一致
+enum class MirrorMap : jint {
+    MainActivity = 0,
+};
+
+//MainActivity的字段表：下标就是MainField的值
+enum MainField : size_t {
+    kMainName = 0,  //String name
+    kMainAge = 1,   //static int age
+    kMainNum = 2,   //final double num (JNI可以修改final字段，见changeNum)
+};
+
+static const MirrorFieldSpec kMainActivityFields[] = {
+        {"name", MirrorType::String, false},
+        {"age", MirrorType::Int, true},
+        {"num", MirrorType::Double, false},
+};
+
+static inline FieldMirror *to_mirror(jlong handle) {
+    return reinterpret_cast<FieldMirror *>(handle);
+}
+
+//有实例字段时obj必须是字段所属类的对象，否则抛出IllegalArgumentException
+static bool check_target(JNIEnv *env, FieldMirror *mirror, jobject obj) {
+    if (mirror->hasInstanceFields() && (!obj || !env->IsInstanceOf(obj, mirror->clazz()))) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "FieldMirror: 对象为null或者类型不对");
+        return false;
+    }
+    return true;
+}
+
+static jlong native_create(JNIEnv *env, jclass clazz, jint map) {
+    if (map != (jint) MirrorMap::MainActivity) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "FieldMirror: 字段表不存在");
+        return 0;
+    }
+    FieldMirror *mirror = FieldMirror::create(env, jni_cache().mainActivityClass, kMainActivityFields,
+                                              sizeof(kMainActivityFields) / sizeof(kMainActivityFields[0]));
+    return reinterpret_cast<jlong>(mirror);
+}
+
+static void native_destroy(JNIEnv *env, jclass clazz, jlong handle) {
+    to_mirror(handle)->destroy(env);
+}
+
+//一次读取所有字段
+static void native_refresh(JNIEnv *env, jclass clazz, jlong handle, jobject obj) {
+    FieldMirror *mirror = to_mirror(handle);
+    if (check_target(env, mirror, obj)) {
+        mirror->refresh(env, obj);
+    }
+}
+
+//只写回修改过的字段，返回写回的字段数
+static jint native_sync(JNIEnv *env, jclass clazz, jlong handle, jobject obj) {
+    FieldMirror *mirror = to_mirror(handle);
+    if (!check_target(env, mirror, obj)) {
+        return -1;
+    }
+    return mirror->sync(env, obj);
+}
+
+static jlong native_dirty_mask(JNIEnv *env, jclass clazz, jlong handle) {
+    return (jlong) to_mirror(handle)->dirtyMask();
+}
+
+/**
+ * 示例：native逻辑只修改镜像，不调用JNI
+ * 每轮相当于一次changeName + changeAge + changeNum，rounds轮之后只需要一次sync()
+ * name、num第一轮之后就不再变化，不会重复写回
+ */
+static void native_step(JNIEnv *env, jclass clazz, jlong handle, jint rounds) {
+    FieldMirror *mirror = to_mirror(handle);
+    if (!env->IsSameObject(mirror->clazz(), jni_cache().mainActivityClass)) {
+        jni_throw(env, "java/lang/IllegalStateException", "FieldMirror: 不是MainActivity的镜像");
+        return;
+    }
+    static const char kName[] = "sawyer";
+    for (jint i = 0; i < rounds; ++i) {
+        mirror->setString(kMainName, kName, sizeof(kName) - 1);
+        mirror->addInt(kMainAge, 1);
+        mirror->setDouble(kMainNum, 99.999);
+    }
+}
+
+static const JNINativeMethod kFieldMirrorMethods[] = {
+        jni::static_native_method<jlong(jint), native_create>("nativeCreate"),
+        jni::static_native_method<void(jlong), native_destroy>("nativeDestroy"),
+        jni::static_native_method<void(jlong, jobject), native_refresh>("nativeRefresh"),
+        jni::static_native_method<jint(jlong, jobject), native_sync>("nativeSync"),
+        jni::static_native_method<jlong(jlong), native_dirty_mask>("nativeDirtyMask"),
+        jni::static_native_method<void(jlong, jint), native_step>("nativeStep"),
+};
+
+const NativeTable kFieldMirrorNatives = native_table("com/sawyer/studyjni/FieldMirror", kFieldMirrorMethods);
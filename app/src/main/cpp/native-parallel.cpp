@@ -0,0 +1,159 @@
+#include <jni.h>
+#include <vector>
+#include "array-bridge.h"
+#include "jni-register.h"
+#include "jni-stats.h"
+#include "jni-util.h"
+#include "parallel-arrays.h"
+#include "work-stealing.h"
+
+/**
+ * ParallelArrays.java 的JNI实现，运算见parallel-arrays.h
+ *
+ * map、reduce、histogram：与NativeArrays一样用PrimitiveArray拿到数组(大数组Critical，不拷贝)，
+ *      工作线程只读写这块内存、不调用JNI，调用者线程等待期间也不调用JNI，满足Critical区间的限制
+ * sort：需要同样大小的临时缓冲区，耗时也长得多，不适合停留在Critical区间内(会推迟GC)，
+ *      所以用Get<Type>ArrayRegion拷贝出来排序，再一次性写回
+ */
+
+static size_t to_threads(jint threads) {
+    return threads > 0 ? (size_t) threads : 0;
+}
+
+template<typename T>
+static bool check_not_null(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array) {
+    if (!array) {
+        jni_throw(env, "java/lang/NullPointerException", "array == null");
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+static void array_map(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array, jint op, T operand,
+                      jint threads) {
+    if (!check_not_null<T>(env, array)) {
+        return;
+    }
+    if (op < (jint) MapOp::Add || op > (jint) MapOp::Mul) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "map: op不存在");
+        return;
+    }
+    PrimitiveArray<T> view(env, array, ArrayAccess::ReadWrite);
+    if (view.data()) {
+        parallel_map(view.data(), (size_t) view.size(), (MapOp) op, operand, to_threads(threads));
+    }
+}
+
+template<typename T>
+static auto array_reduce(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array, jint op, jint threads)
+-> decltype(parallel_reduce((const T *) nullptr, 0, ReduceOp::Sum, 0)) {
+    if (!check_not_null<T>(env, array)) {
+        return 0;
+    }
+    if (op < (jint) ReduceOp::Sum || op > (jint) ReduceOp::Max) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "reduce: op不存在");
+        return 0;
+    }
+    const jsize length = env->GetArrayLength(array);
+    if (length == 0 && op != (jint) ReduceOp::Sum) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "reduce: 空数组没有最小值、最大值");
+        return 0;
+    }
+    PrimitiveArray<T> view(env, array, ArrayAccess::ReadOnly, length);
+    if (!view.data()) {
+        return 0;
+    }
+    return parallel_reduce(view.data(), (size_t) view.size(), (ReduceOp) op, to_threads(threads));
+}
+
+template<typename T>
+static void array_sort(JNIEnv *env, typename JniArrayTraits<T>::ArrayType array, jint threads) {
+    if (!check_not_null<T>(env, array)) {
+        return;
+    }
+    const jsize length = env->GetArrayLength(array);
+    if (length < 2) {
+        return;
+    }
+    std::vector<T> buffer((size_t) length * 2); //前一半是数据，后一半是归并用的临时缓冲区
+    JniArrayTraits<T>::getRegion(env, array, 0, length, buffer.data());
+    parallel_sort(buffer.data(), buffer.data() + length, (size_t) length, to_threads(threads));
+    JniArrayTraits<T>::setRegion(env, array, 0, length, buffer.data());
+    jni_stats_add_bytes((size_t) length * sizeof(T) * 2);
+}
+
+//桶太多时每个线程一份的计数器会占用太多内存
+static constexpr jint kMaxHistogramBins = 1 << 20;
+
+static jlongArray histogram_I(JNIEnv *env, jclass clazz, jintArray array, jint min, jint max, jint bins,
+                              jint threads) {
+    if (!check_not_null<jint>(env, array)) {
+        return nullptr;
+    }
+    if (min > max || bins <= 0 || bins > kMaxHistogramBins) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "histogram: 要求min <= max、0 < bins <= 2^20");
+        return nullptr;
+    }
+    std::vector<jlong> counts((size_t) bins);
+    {
+        PrimitiveArray<jint> view(env, array, ArrayAccess::ReadOnly);
+        if (!view.data()) {
+            return nullptr;
+        }
+        parallel_histogram(view.data(), (size_t) view.size(), min, max, bins, counts.data(), to_threads(threads));
+    }//先退出Critical区间，再创建返回给Java的数组
+    return new_java_array(env, counts.data(), bins);
+}
+
+static jint concurrency(JNIEnv *env, jclass clazz) {
+    return (jint) WorkStealingPool::instance().concurrency();
+}
+
+/**
+ * 为每一种基本类型生成map、reduce
+ * @T: C++类型 e.g: jint
+ * @Sig: Java签名 e.g: I
+ * @ReduceT: reduce返回给Java的类型
+ */
+#define DEFINE_PARALLEL_ARRAYS(T, Sig, ReduceT)                                                   \
+static void map_##Sig(JNIEnv *env, jclass clazz, T##Array array, jint op, T operand, jint threads) { \
+    array_map<T>(env, array, op, operand, threads);                                               \
+}                                                                                                 \
+static ReduceT reduce_##Sig(JNIEnv *env, jclass clazz, T##Array array, jint op, jint threads) {   \
+    return array_reduce<T>(env, array, op, threads);                                              \
+}
+
+DEFINE_PARALLEL_ARRAYS(jint, I, jlong)
+DEFINE_PARALLEL_ARRAYS(jlong, J, jlong)
+DEFINE_PARALLEL_ARRAYS(jfloat, F, jdouble)
+DEFINE_PARALLEL_ARRAYS(jdouble, D, jdouble)
+
+#undef DEFINE_PARALLEL_ARRAYS
+
+static void sort_I(JNIEnv *env, jclass clazz, jintArray array, jint threads) {
+    array_sort<jint>(env, array, threads);
+}
+
+static void sort_J(JNIEnv *env, jclass clazz, jlongArray array, jint threads) {
+    array_sort<jlong>(env, array, threads);
+}
+
+#define PARALLEL_ARRAYS_METHODS(T, Sig, ReduceT)                                                  \
+        jni::static_native_method<void(T##Array, jint, T, jint), map_##Sig>("map"),               \
+        jni::static_native_method<ReduceT(T##Array, jint, jint), reduce_##Sig>("reduce")
+
+static const JNINativeMethod kParallelArraysMethods[] = {
+        PARALLEL_ARRAYS_METHODS(jint, I, jlong),
+        PARALLEL_ARRAYS_METHODS(jlong, J, jlong),
+        PARALLEL_ARRAYS_METHODS(jfloat, F, jdouble),
+        PARALLEL_ARRAYS_METHODS(jdouble, D, jdouble),
+        jni::static_native_method<jlongArray(jintArray, jint, jint, jint, jint), histogram_I>("histogram"),
+        jni::static_native_method<void(jintArray, jint), sort_I>("sort"),
+        jni::static_native_method<void(jlongArray, jint), sort_J>("sort"),
+        jni::static_native_method<jint(), concurrency>("concurrency"),
+};
+
+#undef PARALLEL_ARRAYS_METHODS
+
+const NativeTable kParallelArraysNatives = native_table("com/sawyer/studyjni/ParallelArrays", kParallelArraysMethods);
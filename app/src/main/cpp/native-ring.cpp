@@ -0,0 +1,93 @@
+#include <jni.h>
+#include "jni-cache.h"
+#include "jni-register.h"
+#include "jni-util.h"
+#include "ring-buffer.h"
+
+/**
+ * SharedRing.java 的JNI实现
+ *
+ * Java端持有SpscRing的指针(jlong)，数据区通过NewDirectByteBuffer直接暴露给Java，
+ * 记录本身不经过JNI，JNI只用来同步head/tail(即"门铃")，一批记录只需要一次JNI调用
+ */
+
+//handle为0(已经close())时抛出IllegalStateException，返回nullptr
+static inline SpscRing *to_ring(JNIEnv *env, jlong handle) {
+    if (handle == 0) {
+        jni_throw(env, "java/lang/IllegalStateException", "SharedRing: 已经close()");
+        return nullptr;
+    }
+    return reinterpret_cast<SpscRing *>(handle);
+}
+
+static jlong native_create(JNIEnv *env, jclass clazz, jint capacity) {
+    if (capacity <= 0) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "SharedRing: capacity <= 0");
+        return 0;
+    }
+    return reinterpret_cast<jlong>(SpscRing::create((size_t) capacity));
+}
+
+static jobject native_buffer(JNIEnv *env, jclass clazz, jlong handle) {
+    SpscRing *ring = to_ring(env, handle);
+    if (!ring) {
+        return nullptr;
+    }
+    //api: jobject NewDirectByteBuffer(void* address, jlong capacity)
+    //Java操作这个ByteBuffer，就是直接读写C++的这块内存，没有拷贝
+    return env->NewDirectByteBuffer(ring->data(), (jlong) ring->capacity());
+}
+
+static void native_destroy(JNIEnv *env, jclass clazz, jlong handle) {
+    delete to_ring(env, handle);
+}
+
+//Java作为生产者：发布已写入的记录，返回最新的读位置
+static jlong native_publish(JNIEnv *env, jclass clazz, jlong handle, jlong writePos) {
+    SpscRing *ring = to_ring(env, handle);
+    return ring ? (jlong) ring->publishHead((uint64_t) writePos) : 0;
+}
+
+//Java作为消费者：获取已发布的写位置
+static jlong native_acquire(JNIEnv *env, jclass clazz, jlong handle) {
+    SpscRing *ring = to_ring(env, handle);
+    return ring ? (jlong) ring->acquireHead() : 0;
+}
+
+//Java作为消费者：释放已读完的空间
+static void native_release(JNIEnv *env, jclass clazz, jlong handle, jlong readPos) {
+    SpscRing *ring = to_ring(env, handle);
+    if (ring) {
+        ring->releaseTail((uint64_t) readPos);
+    }
+}
+
+/**
+ * 示例：C++作为from的消费者、to的生产者，把from中的记录原样转发到to
+ * 整批记录只有这一次JNI调用，to只在最后commit一次
+ * 返回转发的记录数
+ */
+static jint native_echo(JNIEnv *env, jclass clazz, jlong fromHandle, jlong toHandle) {
+    SpscRing *from = to_ring(env, fromHandle);
+    SpscRing *to = from ? to_ring(env, toHandle) : nullptr;
+    if (!to) {
+        return 0;
+    }
+    size_t count = from->drain([to](const uint8_t *payload, uint32_t len) {
+        return to->write(payload, len); //to写满了就停下，剩下的记录留在from中
+    });
+    to->commit();
+    return (jint) count;
+}
+
+static const JNINativeMethod kSharedRingMethods[] = {
+        jni::static_native_method<jlong(jint), native_create>("nativeCreate"),
+        jni::static_native_method<jni::Object<ByteBufferClass>(jlong), native_buffer>("nativeBuffer"),
+        jni::static_native_method<void(jlong), native_destroy>("nativeDestroy"),
+        jni::static_native_method<jlong(jlong, jlong), native_publish>("nativePublish"),
+        jni::static_native_method<jlong(jlong), native_acquire>("nativeAcquire"),
+        jni::static_native_method<void(jlong, jlong), native_release>("nativeRelease"),
+        jni::static_native_method<jint(jlong, jlong), native_echo>("nativeEcho"),
+};
+
+const NativeTable kSharedRingNatives = native_table("com/sawyer/studyjni/SharedRing", kSharedRingMethods);
@@ -0,0 +1,64 @@
+#include <jni.h>
+#include "array-bridge.h"
+#include "call-arena.h"
+#include "jni-cache.h"
+#include "jni-register.h"
+#include "jni-stats.h"
+
+/**
+ * NativeStats.java 的JNI实现，数据格式见jni-stats.h
+ * 关闭STUDYJNI_JNI_STATS时，snapshot、names都返回null；arenaStats与开关无关，见call-arena.h
+ */
+
+static jlongArray native_snapshot(JNIEnv *env, jclass clazz) {
+#if STUDYJNI_JNI_STATS
+    std::vector<int64_t> snapshot = jni_stats_snapshot();
+    return new_java_array<jlong>(env, reinterpret_cast<const jlong *>(snapshot.data()), (jsize) snapshot.size());
+#else
+    return nullptr;
+#endif
+}
+
+static jobjectArray native_names(JNIEnv *env, jclass clazz) {
+#if STUDYJNI_JNI_STATS
+    std::vector<std::string> names = jni_stats_names();
+    jobjectArray array = env->NewObjectArray((jsize) names.size(), jni_cache().stringClass, nullptr);
+    if (!array) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+        //名字、签名都是ASCII，可以直接用NewStringUTF
+        jstring name = env->NewStringUTF(names[i].c_str());
+        if (!name) {
+            env->DeleteLocalRef(array);
+            return nullptr;
+        }
+        env->SetObjectArrayElement(array, (jsize) i, name);
+        env->DeleteLocalRef(name);
+    }
+    return array;
+#else
+    return nullptr;
+#endif
+}
+
+static jboolean native_enabled(JNIEnv *env, jclass clazz) {
+    return STUDYJNI_JNI_STATS ? JNI_TRUE : JNI_FALSE;
+}
+
+//顺序与NativeStats.java的ARENA_*一致
+static jlongArray native_arena_stats(JNIEnv *env, jclass clazz) {
+    const ArenaStats s = arena_stats();
+    const jlong values[] = {(jlong) s.scopes, (jlong) s.highWater, (jlong) s.fallbacks,
+                            (jlong) s.fallbackBytes, (jlong) s.threads, (jlong) s.poolMisses};
+    return new_java_array<jlong>(env, values, (jsize) (sizeof(values) / sizeof(values[0])));
+}
+
+static const JNINativeMethod kNativeStatsMethods[] = {
+        jni::static_native_method<jlongArray(), native_snapshot>("nativeSnapshot"),
+        jni::static_native_method<jni::ObjectArray<jstring>(), native_names>("nativeNames"),
+        jni::static_native_method<jboolean(), native_enabled>("nativeEnabled"),
+        jni::static_native_method<jlongArray(), native_arena_stats>("nativeArenaStats"),
+};
+
+const NativeTable kNativeStatsNatives = native_table("com/sawyer/studyjni/NativeStats", kNativeStatsMethods);
@@ -0,0 +1,90 @@
+#include <jni.h>
+#include <cstring>
+#include "array-bridge.h"
+#include "jni-register.h"
+#include "jni-util.h"
+#include "string-batch.h"
+
+/**
+ * NativeStrings.java 的JNI实现
+ *
+ * 打包后的byte[]格式(本机字节序)：
+ *      [int count][int length_0 ... length_count-1][UTF-8 bytes ...]
+ *      length == -1 表示该元素为null
+ */
+
+static jbyteArray pack(JNIEnv *env, jclass clazz, jobjectArray array) {
+    if (!array) {
+        jni_throw(env, "java/lang/NullPointerException", "array == null");
+        return nullptr;
+    }
+    PackedStrings packed;
+    if (!pack_string_array(env, array, packed)) {
+        return nullptr;
+    }
+    const auto count = (jint) packed.size();
+    std::vector<jint> header((size_t) count + 1);
+    header[0] = count;
+    for (jint i = 0; i < count; ++i) {
+        header[i + 1] = packed.isNull(i) ? -1 : (jint) packed.length(i);
+    }
+    const auto headerBytes = (jsize) (header.size() * sizeof(jint));
+    const auto total = headerBytes + (jsize) packed.bytes.size();
+
+    jbyteArray result = env->NewByteArray(total);
+    if (!result) {
+        return nullptr;
+    }
+    env->SetByteArrayRegion(result, 0, headerBytes, reinterpret_cast<const jbyte *>(header.data()));
+    env->SetByteArrayRegion(result, headerBytes, (jsize) packed.bytes.size(),
+                            reinterpret_cast<const jbyte *>(packed.bytes.data()));
+    return result;
+}
+
+static jobjectArray unpack(JNIEnv *env, jclass clazz, jbyteArray packedArray) {
+    if (!packedArray) {
+        jni_throw(env, "java/lang/NullPointerException", "packed == null");
+        return nullptr;
+    }
+    PackedStrings packed;
+    packed.clear();
+    bool valid = true;
+    {
+        //Critical区间内只解析、拷贝，不调用JNI
+        PrimitiveArray<jbyte> view(env, packedArray, ArrayAccess::ReadOnly);
+        const auto *data = reinterpret_cast<const char *>(view.data());
+        const auto size = (size_t) view.size();
+        jint count = 0;
+        if (!data || size < sizeof(jint)) {
+            valid = false;
+        } else {
+            memcpy(&count, data, sizeof(jint));
+            valid = count >= 0 && (size_t) count < size / sizeof(jint);
+        }
+        size_t pos = valid ? sizeof(jint) * ((size_t) count + 1) : 0;
+        for (jint i = 0; valid && i < count; ++i) {
+            jint len;
+            memcpy(&len, data + sizeof(jint) * (i + 1), sizeof(jint));
+            if (len == -1) {
+                packed.append(nullptr, 0);
+            } else if (len < 0 || pos + (size_t) len > size) {
+                valid = false;
+            } else {
+                packed.append(data + pos, (uint32_t) len);
+                pos += (size_t) len;
+            }
+        }
+    }
+    if (!valid) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "unpack: 数据格式错误");
+        return nullptr;
+    }
+    return unpack_string_array(env, packed);
+}
+
+static const JNINativeMethod kNativeStringsMethods[] = {
+        jni::static_native_method<jbyteArray(jni::ObjectArray<jstring>), pack>("pack"),
+        jni::static_native_method<jni::ObjectArray<jstring>(jbyteArray), unpack>("unpack"),
+};
+
+const NativeTable kNativeStringsNatives = native_table("com/sawyer/studyjni/NativeStrings", kNativeStringsMethods);
@@ -0,0 +1,136 @@
+#include <jni.h>
+#include "array-bridge.h"
+#include "jni-cache.h"
+#include "jni-register.h"
+#include "jni-util.h"
+#include "string-batch.h"
+#include "student-store.h"
+
+/**
+ * StudentStore.java 的JNI实现，Java端持有StudentStore的指针(jlong)
+ */
+
+static inline StudentStore *to_store(jlong handle) {
+    return reinterpret_cast<StudentStore *>(handle);
+}
+
+static jintArray to_java_rows(JNIEnv *env, const std::vector<jint> &rows) {
+    return new_java_array(env, rows.data(), (jsize) rows.size());
+}
+
+//rows的数据拷贝出来再使用，避免在Critical区间内做复杂操作
+static bool copy_rows(JNIEnv *env, jintArray rows, std::vector<jint> &out) {
+    if (!rows) {
+        jni_throw(env, "java/lang/NullPointerException", "rows == null");
+        return false;
+    }
+    out.resize((size_t) env->GetArrayLength(rows));
+    env->GetIntArrayRegion(rows, 0, (jsize) out.size(), out.data());
+    return true;
+}
+
+static jlong native_create(JNIEnv *env, jclass clazz) {
+    return reinterpret_cast<jlong>(new StudentStore());
+}
+
+static void native_destroy(JNIEnv *env, jclass clazz, jlong handle) {
+    delete to_store(handle);
+}
+
+static void native_load(JNIEnv *env, jclass clazz, jlong handle, jobjectArray students) {
+    to_store(handle)->load(env, students);
+}
+
+static jint native_size(JNIEnv *env, jclass clazz, jlong handle) {
+    return (jint) to_store(handle)->size();
+}
+
+static jintArray native_filter_by_age(JNIEnv *env, jclass clazz, jlong handle,
+                                      jint minAge, jint maxAge) {
+    return to_java_rows(env, to_store(handle)->filterByAge(minAge, maxAge));
+}
+
+static jintArray native_sort_by_age(JNIEnv *env, jclass clazz, jlong handle, jboolean ascending) {
+    return to_java_rows(env, to_store(handle)->sortByAge(ascending == JNI_TRUE));
+}
+
+static jintArray native_sort_by_name(JNIEnv *env, jclass clazz, jlong handle) {
+    return to_java_rows(env, to_store(handle)->sortByName());
+}
+
+//返回[count, sum, min, max]
+static jlongArray native_age_stats(JNIEnv *env, jclass clazz, jlong handle, jintArray rows) {
+    StudentStore::AgeStats stats;
+    if (rows) {
+        std::vector<jint> rowList;
+        if (!copy_rows(env, rows, rowList)) {
+            return nullptr;
+        }
+        if (!to_store(handle)->ageStats(rowList.data(), rowList.size(), stats)) {
+            jni_throw(env, "java/lang/IndexOutOfBoundsException", "ageStats: 行号越界");
+            return nullptr;
+        }
+    } else {
+        stats = to_store(handle)->ageStats();
+    }
+    jlong result[] = {stats.count, stats.sum, stats.min, stats.max};
+    return new_java_array(env, result, 4);
+}
+
+static void native_add_age(JNIEnv *env, jclass clazz, jlong handle,
+                           jintArray rows, jint delta) {
+    std::vector<jint> rowList;
+    if (!copy_rows(env, rows, rowList)) {
+        return;
+    }
+    if (!to_store(handle)->addAge(rowList.data(), rowList.size(), delta)) {
+        jni_throw(env, "java/lang/IndexOutOfBoundsException", "addAge: 行号越界");
+    }
+}
+
+static void native_set_name(JNIEnv *env, jclass clazz, jlong handle,
+                            jintArray rows, jstring name) {
+    std::vector<jint> rowList;
+    if (!copy_rows(env, rows, rowList)) {
+        return;
+    }
+    std::vector<char> utf8;
+    if (name) {
+        jsize len = env->GetStringLength(name);
+        std::vector<jchar> utf16((size_t) len);
+        env->GetStringRegion(name, 0, len, utf16.data());
+        utf8.resize((size_t) len * 3);
+        utf8.resize(utf16_to_utf8(utf16.data(), (size_t) len, utf8.data()));
+    }
+    bool ok = to_store(handle)->setName(rowList.data(), rowList.size(),
+                                        name ? utf8.data() : nullptr, (uint32_t) utf8.size());
+    if (!ok) {
+        jni_throw(env, "java/lang/IndexOutOfBoundsException", "setName: 行号越界");
+    }
+}
+
+static jint native_write_back(JNIEnv *env, jclass clazz, jlong handle, jobjectArray students) {
+    jint written = to_store(handle)->writeBack(env, students);
+    if (written < 0 && !env->ExceptionCheck()) {
+        jni_throw(env, "java/lang/IllegalArgumentException", "writeBack: 必须传入load()时的同一个数组");
+    }
+    return written;
+}
+
+using StudentArray = jni::ObjectArray<StudentObject>;
+
+static const JNINativeMethod kStudentStoreMethods[] = {
+        jni::static_native_method<jlong(), native_create>("nativeCreate"),
+        jni::static_native_method<void(jlong), native_destroy>("nativeDestroy"),
+        jni::static_native_method<void(jlong, StudentArray), native_load>("nativeLoad"),
+        jni::static_native_method<jint(jlong), native_size>("nativeSize"),
+        jni::static_native_method<jintArray(jlong, jint, jint), native_filter_by_age>("nativeFilterByAge"),
+        jni::static_native_method<jintArray(jlong, jboolean), native_sort_by_age>("nativeSortByAge"),
+        jni::static_native_method<jintArray(jlong), native_sort_by_name>("nativeSortByName"),
+        jni::static_native_method<jlongArray(jlong, jintArray), native_age_stats>("nativeAgeStats"),
+        jni::static_native_method<void(jlong, jintArray, jint), native_add_age>("nativeAddAge"),
+        jni::static_native_method<void(jlong, jintArray, jstring), native_set_name>("nativeSetName"),
+        jni::static_native_method<jint(jlong, StudentArray), native_write_back>("nativeWriteBack"),
+};
+
+const NativeTable kStudentStoreNatives = native_table("com/sawyer/studyjni/StudentStore", kStudentStoreMethods);
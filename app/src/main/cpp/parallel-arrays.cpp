@@ -0,0 +1,226 @@
+#include "parallel-arrays.h"
+#include "array-kernels.h"
+#include "work-stealing.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+static constexpr size_t kCacheLine = 64;
+
+//chunk的划分：第0个chunk长head个元素，之后每个chunk长chunk个元素
+struct ChunkPlan {
+    size_t n;
+    size_t head;
+    size_t chunk;
+
+    size_t count() const {
+        if (n == 0) {
+            return 0;
+        }
+        return n <= head ? 1 : 1 + (n - head + chunk - 1) / chunk;
+    }
+
+    size_t begin(size_t i) const { return i == 0 ? 0 : head + (i - 1) * chunk; }
+
+    size_t end(size_t i) const { return std::min(n, head + i * chunk); }
+};
+
+/**
+ * @alignTo: 非空时按这个地址对齐，使第1个chunk开始的每个chunk都从缓存行边界开始；
+ *           为空时按下标划分，与地址无关
+ */
+template<typename T>
+static ChunkPlan plan_chunks(size_t n, const T *alignTo) {
+    const size_t chunk = kParallelChunkBytes / sizeof(T);
+    size_t head = chunk;
+    if (alignTo) {
+        size_t misaligned = (reinterpret_cast<uintptr_t>(alignTo) % kCacheLine) / sizeof(T);
+        head = chunk - misaligned;
+    }
+    return {n, head, chunk};
+}
+
+//小数组不值得唤醒其它线程
+template<typename T>
+static size_t threads_for(size_t n, size_t threads) {
+    return n * sizeof(T) < kParallelMinBytes ? 1 : threads;
+}
+
+//========================map========================
+
+template<typename T>
+static void map_impl(T *data, size_t n, MapOp op, T operand, size_t threads) {
+    const ChunkPlan plan = plan_chunks(n, data);
+    WorkStealingPool::instance().parallelFor(plan.count(), threads_for<T>(n, threads), [&](size_t i, size_t) {
+        T *begin = data + plan.begin(i);
+        size_t len = plan.end(i) - plan.begin(i);
+        if (op == MapOp::Add) {
+            kernel_add(begin, len, operand);
+        } else {
+            kernel_scale(begin, len, operand);
+        }
+    });
+}
+
+void parallel_map(jint *data, size_t n, MapOp op, jint operand, size_t threads) {
+    map_impl(data, n, op, operand, threads);
+}
+
+void parallel_map(jlong *data, size_t n, MapOp op, jlong operand, size_t threads) {
+    map_impl(data, n, op, operand, threads);
+}
+
+void parallel_map(jfloat *data, size_t n, MapOp op, jfloat operand, size_t threads) {
+    map_impl(data, n, op, operand, threads);
+}
+
+void parallel_map(jdouble *data, size_t n, MapOp op, jdouble operand, size_t threads) {
+    map_impl(data, n, op, operand, threads);
+}
+
+//========================reduce========================
+
+//整数按无符号相加，溢出回绕，与kernel_sum一致
+static inline jlong combine_sum(jlong a, jlong b) { return (jlong) ((uint64_t) a + (uint64_t) b); }
+
+static inline jdouble combine_sum(jdouble a, jdouble b) { return a + b; }
+
+//Acc: 返回值类型(jlong/jdouble)
+template<typename Acc, typename T>
+static Acc reduce_impl(const T *data, size_t n, ReduceOp op, size_t threads) {
+    const ChunkPlan plan = plan_chunks<T>(n, nullptr);
+    const size_t chunks = plan.count();
+    //每个chunk一个结果，按下标合并：加法顺序与线程数无关
+    std::vector<Acc> sums(op == ReduceOp::Sum ? chunks : 0);
+    std::vector<T> mins(op == ReduceOp::Sum ? 0 : chunks);
+    std::vector<T> maxs(op == ReduceOp::Sum ? 0 : chunks);
+    WorkStealingPool::instance().parallelFor(chunks, threads_for<T>(n, threads), [&](size_t i, size_t) {
+        const T *begin = data + plan.begin(i);
+        size_t len = plan.end(i) - plan.begin(i);
+        if (op == ReduceOp::Sum) {
+            sums[i] = kernel_sum(begin, len);
+        } else {
+            kernel_min_max(begin, len, &mins[i], &maxs[i]);
+        }
+    });
+    if (op == ReduceOp::Sum) {
+        Acc result = 0;
+        for (Acc s : sums) {
+            result = combine_sum(result, s);
+        }
+        return result;
+    }
+    //与kernel_min_max相同的比较方式，NaN的处理也与串行一致
+    T lo = mins[0];
+    T hi = maxs[0];
+    for (size_t i = 1; i < chunks; ++i) {
+        lo = mins[i] < lo ? mins[i] : lo;
+        hi = maxs[i] > hi ? maxs[i] : hi;
+    }
+    return (Acc) (op == ReduceOp::Min ? lo : hi);
+}
+
+jlong parallel_reduce(const jint *data, size_t n, ReduceOp op, size_t threads) {
+    return reduce_impl<jlong>(data, n, op, threads);
+}
+
+jlong parallel_reduce(const jlong *data, size_t n, ReduceOp op, size_t threads) {
+    return reduce_impl<jlong>(data, n, op, threads);
+}
+
+jdouble parallel_reduce(const jfloat *data, size_t n, ReduceOp op, size_t threads) {
+    return reduce_impl<jdouble>(data, n, op, threads);
+}
+
+jdouble parallel_reduce(const jdouble *data, size_t n, ReduceOp op, size_t threads) {
+    return reduce_impl<jdouble>(data, n, op, threads);
+}
+
+//========================histogram========================
+
+void parallel_histogram(const jint *data, size_t n, jint min, jint max, jint bins, jlong *counts,
+                        size_t threads) {
+    WorkStealingPool &pool = WorkStealingPool::instance();
+    const ChunkPlan plan = plan_chunks<jint>(n, nullptr);
+    threads = threads_for<jint>(n, threads);
+    if (threads == 0 || threads > pool.concurrency()) {
+        threads = pool.concurrency();
+    }
+    //计数可以任意顺序相加，所以每个线程一份，而不是每个chunk一份
+    const auto binCount = (size_t) bins;
+    std::vector<std::vector<jlong>> local(threads, std::vector<jlong>(binCount, 0));
+    const uint64_t span = (uint64_t) ((int64_t) max - (int64_t) min) + 1;
+    pool.parallelFor(plan.count(), threads, [&](size_t i, size_t slot) {
+        jlong *out = local[slot].data();
+        for (size_t k = plan.begin(i), end = plan.end(i); k < end; ++k) {
+            jint v = data[k];
+            if (v < min || v > max) {
+                continue;
+            }
+            //span <= 2^32、bins < 2^31，乘积不会溢出
+            auto bin = (size_t) ((uint64_t) ((int64_t) v - (int64_t) min) * binCount / span);
+            ++out[bin];
+        }
+    });
+    std::fill(counts, counts + binCount, 0);
+    for (const std::vector<jlong> &h : local) {
+        for (size_t b = 0; b < binCount; ++b) {
+            counts[b] += h[b];
+        }
+    }
+}
+
+//========================sort========================
+
+template<typename T>
+static void sort_impl(T *data, T *scratch, size_t n, size_t threads) {
+    WorkStealingPool &pool = WorkStealingPool::instance();
+    threads = threads_for<T>(n, threads);
+    if (threads == 0 || threads > pool.concurrency()) {
+        threads = pool.concurrency();
+    }
+    if (threads <= 1) {
+        std::sort(data, data + n);
+        return;
+    }
+    //每个线程两段，留出偷取的余地；段数取2的幂，归并的每一轮都是成对的
+    size_t runs = 1;
+    while (runs < threads * 2) {
+        runs <<= 1;
+    }
+    //段的长度取缓存行的整数倍
+    const size_t lineElems = kCacheLine / sizeof(T);
+    size_t runLen = (n + runs - 1) / runs;
+    runLen = (runLen + lineElems - 1) / lineElems * lineElems;
+
+    pool.parallelFor(runs, threads, [&](size_t i, size_t) {
+        size_t begin = std::min(n, i * runLen);
+        size_t end = std::min(n, begin + runLen);
+        std::sort(data + begin, data + end);
+    });
+
+    //每一轮把相邻的两段归并成一段，在data与scratch之间来回
+    T *src = data;
+    T *dst = scratch;
+    for (size_t width = runLen; width < n; width *= 2) {
+        const size_t pairs = (n + 2 * width - 1) / (2 * width);
+        pool.parallelFor(pairs, threads, [&](size_t i, size_t) {
+            size_t begin = i * 2 * width;
+            size_t mid = std::min(n, begin + width);
+            size_t end = std::min(n, begin + 2 * width);
+            std::merge(src + begin, src + mid, src + mid, src + end, dst + begin);
+        });
+        std::swap(src, dst);
+    }
+    if (src != data) {
+        memcpy(data, src, n * sizeof(T));
+    }
+}
+
+void parallel_sort(jint *data, jint *scratch, size_t n, size_t threads) {
+    sort_impl(data, scratch, n, threads);
+}
+
+void parallel_sort(jlong *data, jlong *scratch, size_t n, size_t threads) {
+    sort_impl(data, scratch, n, threads);
+}
@@ -0,0 +1,66 @@
+#ifndef STUDYJNI_PARALLEL_ARRAYS_H
+#define STUDYJNI_PARALLEL_ARRAYS_H
+
+#include <jni.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 大数组的多核运算，在WorkStealingPool上按chunk并行，只操作C++内存，不涉及JNI调用
+ *
+ * chunk的划分：
+ *      1.每个chunk kParallelChunkBytes字节，是缓存行(64字节)的整数倍
+ *      2.原地写的运算(map)按实际地址对齐：第一个chunk截短到下一个缓存行边界，
+ *        之后每个chunk都从缓存行开始，两个线程不会写同一个缓存行(伪共享)
+ *      3.归约(reduce、histogram)按下标划分，与地址无关：同一个数组无论在哪、用几个线程，chunk都一样
+ * 小于kParallelMinBytes时不拆分，直接在调用者线程中串行执行
+ *
+ * 结果与串行(threads == 1)完全一致：
+ *      每个chunk的结果按下标顺序合并，浮点求和的加法顺序不随线程数变化；
+ *      整数运算按Java的规则回绕；排序的结果本来就是唯一的
+ * 注意：浮点求和的分组与NativeArrays.sum()不同，两者的结果可能有舍入误差
+ *
+ * @threads: 最多使用的线程数(包括调用者)，0表示所有核
+ */
+constexpr size_t kParallelChunkBytes = 64 * 1024;
+constexpr size_t kParallelMinBytes = 2 * kParallelChunkBytes;
+
+//map的运算，与ParallelArrays.java一致
+enum class MapOp : jint {
+    Add = 0,    //data[i] += operand
+    Mul = 1,    //data[i] *= operand
+};
+
+//reduce的运算，与ParallelArrays.java一致
+enum class ReduceOp : jint {
+    Sum = 0,
+    Min = 1,
+    Max = 2,
+};
+
+void parallel_map(jint *data, size_t n, MapOp op, jint operand, size_t threads);
+void parallel_map(jlong *data, size_t n, MapOp op, jlong operand, size_t threads);
+void parallel_map(jfloat *data, size_t n, MapOp op, jfloat operand, size_t threads);
+void parallel_map(jdouble *data, size_t n, MapOp op, jdouble operand, size_t threads);
+
+//Min、Max要求n > 0。整数返回jlong，浮点返回jdouble(与NativeArrays.sum一致)
+jlong parallel_reduce(const jint *data, size_t n, ReduceOp op, size_t threads);
+jlong parallel_reduce(const jlong *data, size_t n, ReduceOp op, size_t threads);
+jdouble parallel_reduce(const jfloat *data, size_t n, ReduceOp op, size_t threads);
+jdouble parallel_reduce(const jdouble *data, size_t n, ReduceOp op, size_t threads);
+
+/**
+ * [min, max]等分成bins个桶，counts[bins]由调用者分配；超出范围的值不计数
+ * 要求min <= max、bins > 0
+ */
+void parallel_histogram(const jint *data, size_t n, jint min, jint max, jint bins, jlong *counts,
+                        size_t threads);
+
+/**
+ * 升序排序：chunk内并行std::sort，再两两并行归并
+ * @scratch: 与data一样大的临时缓冲区
+ */
+void parallel_sort(jint *data, jint *scratch, size_t n, size_t threads);
+void parallel_sort(jlong *data, jlong *scratch, size_t n, size_t threads);
+
+#endif //STUDYJNI_PARALLEL_ARRAYS_H
@@ -0,0 +1,74 @@
+#include "ring-buffer.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+SpscRing *SpscRing::create(size_t capacity) {
+    size_t cap = 64;
+    while (cap < capacity) {
+        cap <<= 1;
+        if (cap == 0 || cap > (1u << 30)) {
+            return nullptr; //DirectByteBuffer的容量是int，不能超过2^31
+        }
+    }
+    void *data = nullptr;
+    if (posix_memalign(&data, 64, cap) != 0) {
+        return nullptr;
+    }
+    memset(data, 0, cap);
+    return new(std::nothrow) SpscRing(static_cast<uint8_t *>(data), cap);
+}
+
+SpscRing::SpscRing(uint8_t *data, size_t capacity)
+        : mData(data), mCapacity(capacity), mMask(capacity - 1) {}
+
+SpscRing::~SpscRing() {
+    free(mData);
+    mData = nullptr;
+}
+
+bool SpscRing::write(const void *payload, uint32_t len) {
+    if (len > maxPayload()) {
+        return false;
+    }
+    const uint32_t size = ring_record_size(len);
+    size_t offset = mPendingHead & mMask;
+    size_t contiguous = mCapacity - offset;
+
+    if (contiguous < size) {
+        //尾部放不下：先写一个跳转标记，让消费者回到开头。标记本身也占用空间
+        if (mCapacity - (mPendingHead - mCachedTail) < contiguous) {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (mCapacity - (mPendingHead - mCachedTail) < contiguous) {
+                return false;
+            }
+        }
+        uint32_t marker = kRingWrapMarker;
+        memcpy(mData + offset, &marker, sizeof(marker));
+        mPendingHead += contiguous;
+        offset = 0;
+    }
+
+    if (mCapacity - (mPendingHead - mCachedTail) < size) {
+        mCachedTail = mTail.load(std::memory_order_acquire);
+        if (mCapacity - (mPendingHead - mCachedTail) < size) {
+            return false;
+        }
+    }
+    memcpy(mData + offset, &len, sizeof(len));
+    if (len > 0) {
+        memcpy(mData + offset + kRingHeaderBytes, payload, len);
+    }
+    mPendingHead += size;
+    return true;
+}
+
+void SpscRing::commit() {
+    mHead.store(mPendingHead, std::memory_order_release);
+}
+
+uint64_t SpscRing::publishHead(uint64_t writePos) {
+    mPendingHead = writePos;
+    mHead.store(writePos, std::memory_order_release);
+    return mTail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,116 @@
+#ifndef STUDYJNI_RING_BUFFER_H
+#define STUDYJNI_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 单生产者/单消费者(SPSC)的环形缓冲区，数据区通过NewDirectByteBuffer共享给Java，零拷贝
+ *
+ * 记录格式(变长，按8字节对齐)：
+ *      [uint32 长度][payload ...][padding]
+ *      长度 == kRingWrapMarker 表示：数据区尾部剩余空间不够放下一条记录，消费者直接跳到数据区开头
+ *      字节序为本机字节序，Java端要 buffer.order(ByteOrder.nativeOrder())
+ *
+ * 下标：
+ *      head(写位置)、tail(读位置)都是只增不减的64位位置，对容量取模得到偏移
+ *      head只由生产者写，tail只由消费者写，所以不需要锁，只需要release/acquire：
+ *          生产者写完数据后 release 写 head，消费者 acquire 读 head 后才能读数据
+ *          消费者读完数据后 release 写 tail，生产者 acquire 读 tail 后才能覆盖这段空间
+ *
+ * 批量：
+ *      write()只写数据，不更新head；攒够一批后调用一次commit()(Java端即一次"门铃"JNI调用)，
+ *      消费者才能看到这一批记录
+ */
+constexpr uint32_t kRingWrapMarker = 0xFFFFFFFFu;
+constexpr uint32_t kRingHeaderBytes = 4;
+constexpr uint32_t kRingAlign = 8;
+
+static inline uint32_t ring_record_size(uint32_t payloadLen) {
+    return (kRingHeaderBytes + payloadLen + kRingAlign - 1) & ~(kRingAlign - 1);
+}
+
+class SpscRing {
+public:
+    //capacity会向上取整为2的幂，最小64字节，失败返回nullptr
+    static SpscRing *create(size_t capacity);
+
+    ~SpscRing();
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    uint8_t *data() const { return mData; }
+
+    size_t capacity() const { return mCapacity; }
+
+    //单条payload的最大长度
+    uint32_t maxPayload() const { return (uint32_t) mCapacity - kRingHeaderBytes; }
+
+    //===================生产者(C++端)===================
+    //写入一条记录，空间不足返回false。写入后需要commit()才对消费者可见
+    bool write(const void *payload, uint32_t len);
+
+    //发布所有已写入的记录
+    void commit();
+
+    //===================消费者(C++端)===================
+    /**
+     * 读取最多maxRecords条已发布的记录，每条回调一次 fn(const uint8_t *payload, uint32_t len)
+     * 回调返回false时停止，该条记录不会被消费。返回实际消费的记录数
+     */
+    template<typename Fn>
+    size_t drain(Fn &&fn, size_t maxRecords = SIZE_MAX);
+
+    //===================Java端通过JNI门铃调用===================
+    //Java作为生产者：发布到writePos为止的记录，返回当前的读位置，用于Java端计算剩余空间
+    uint64_t publishHead(uint64_t writePos);
+
+    //Java作为消费者：获取已发布的写位置
+    uint64_t acquireHead() const { return mHead.load(std::memory_order_acquire); }
+
+    //Java作为消费者：读完之后释放到readPos为止的空间
+    void releaseTail(uint64_t readPos) { mTail.store(readPos, std::memory_order_release); }
+
+    uint64_t acquireTail() const { return mTail.load(std::memory_order_acquire); }
+
+private:
+    SpscRing(uint8_t *data, size_t capacity);
+
+    uint8_t *mData;
+    size_t mCapacity;
+    size_t mMask;
+
+    //head和tail分别由两个线程写，放在不同的cache line上，避免伪共享
+    alignas(64) std::atomic<uint64_t> mHead{0};
+    uint64_t mPendingHead = 0;  //生产者私有：已写入但未发布的位置
+    uint64_t mCachedTail = 0;   //生产者私有：上一次看到的tail，减少对mTail的读取
+
+    alignas(64) std::atomic<uint64_t> mTail{0};
+};
+
+template<typename Fn>
+size_t SpscRing::drain(Fn &&fn, size_t maxRecords) {
+    uint64_t tail = mTail.load(std::memory_order_relaxed);
+    const uint64_t head = mHead.load(std::memory_order_acquire);
+    size_t count = 0;
+    while (tail != head && count < maxRecords) {
+        size_t offset = tail & mMask;
+        uint32_t len;
+        __builtin_memcpy(&len, mData + offset, sizeof(len));
+        if (len == kRingWrapMarker) {
+            tail += mCapacity - offset;
+            continue;
+        }
+        if (!fn(static_cast<const uint8_t *>(mData + offset + kRingHeaderBytes), len)) {
+            break;
+        }
+        tail += ring_record_size(len);
+        ++count;
+    }
+    mTail.store(tail, std::memory_order_release);
+    return count;
+}
+
+#endif //STUDYJNI_RING_BUFFER_H
@@ -0,0 +1,221 @@
+#include "string-batch.h"
+#include "call-arena.h"
+#include "jni-cache.h"
+#include "jni-stats.h"
+#include "jni-util.h"
+#include <cstring>
+
+namespace {
+
+/**
+ * UTF-16临时缓冲区，分配在线程的arena中(见call-arena.h)，调用结束时随ArenaScope一起回退，
+ * 不会像thread_local的vector那样一直占着某次最大调用的内存
+ * 遇到更长的字符串时按2倍重新分配(旧的留在arena中，调用结束时一起回退)
+ */
+class Utf16Scratch {
+public:
+    jchar *reserve(size_t len) {
+        if (len > mCapacity) {
+            size_t capacity = len > mCapacity * 2 ? len : mCapacity * 2;
+            mData = static_cast<jchar *>(mScope.allocate(capacity * sizeof(jchar), alignof(jchar)));
+            mCapacity = mData ? capacity : 0;
+        }
+        return mData;
+    }
+
+private:
+    ArenaScope mScope;
+    jchar *mData = nullptr;
+    size_t mCapacity = 0;
+};
+
+} //namespace
+
+void PackedStrings::append(const char *utf8, uint32_t len) {
+    if (offsets.empty()) {
+        offsets.push_back(0);
+    }
+    if (utf8 && len > 0) {
+        bytes.insert(bytes.end(), utf8, utf8 + len);
+    }
+    nulls.push_back(utf8 ? 0 : 1);
+    offsets.push_back((uint32_t) bytes.size());
+}
+
+size_t utf16_to_utf8(const jchar *src, size_t len, char *dst) {
+    char *out = dst;
+    for (size_t i = 0; i < len; ++i) {
+        uint32_t c = src[i];
+        //高代理 + 低代理 -> 一个补充平面字符
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < len && src[i + 1] >= 0xDC00 && src[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (src[i + 1] - 0xDC00);
+            ++i;
+        }
+        if (c < 0x80) {
+            *out++ = (char) c;
+        } else if (c < 0x800) {
+            *out++ = (char) (0xC0 | (c >> 6));
+            *out++ = (char) (0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            *out++ = (char) (0xE0 | (c >> 12));
+            *out++ = (char) (0x80 | ((c >> 6) & 0x3F));
+            *out++ = (char) (0x80 | (c & 0x3F));
+        } else {
+            *out++ = (char) (0xF0 | (c >> 18));
+            *out++ = (char) (0x80 | ((c >> 12) & 0x3F));
+            *out++ = (char) (0x80 | ((c >> 6) & 0x3F));
+            *out++ = (char) (0x80 | (c & 0x3F));
+        }
+    }
+    return out - dst;
+}
+
+size_t utf8_to_utf16(const char *src, size_t len, jchar *dst) {
+    //每种长度能表示的最小码点，小于它就是超长编码(overlong)，e.g: C0 80 -> U+0000
+    static const uint32_t kMinCodePoint[] = {0, 0x80, 0x800, 0x10000};
+    auto *in = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *end = in + len;
+    jchar *out = dst;
+    while (in < end) {
+        uint32_t c = *in++;
+        int extra = 0;
+        if (c < 0x80) {
+            *out++ = (jchar) c;
+            continue;
+        } else if (c >= 0xC0 && c < 0xE0) {
+            c &= 0x1F;
+            extra = 1;
+        } else if (c >= 0xE0 && c < 0xF0) {
+            c &= 0x0F;
+            extra = 2;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            c &= 0x07;
+            extra = 3;
+        } else {
+            *out++ = 0xFFFD; //非法的首字节：单独的后续字节(0x80 - 0xBF)，或者0xF5 - 0xFF
+            continue;
+        }
+        //后续字节不够(末尾被截断)或者不是10xxxxxx：整个不完整的序列替换为一个U+FFFD，
+        //从第一个不是后续字节的位置继续解码，后面的字符不会丢失
+        const int available = end - in < extra ? (int) (end - in) : extra;
+        int k = 0;
+        for (; k < available && (in[k] & 0xC0) == 0x80; ++k) {
+            c = (c << 6) | (in[k] & 0x3F);
+        }
+        in += k;
+        if (k < extra) {
+            *out++ = 0xFFFD;
+            continue;
+        }
+        //超长编码、超过U+10FFFF都替换为U+FFFD
+        //3字节编码的代理项(ED A0 80 - ED BF BF)不拒绝：utf16_to_utf8对单独的代理项就是这样编码的，保证往返无损
+        if (c < kMinCodePoint[extra] || c > 0x10FFFF) {
+            *out++ = 0xFFFD;
+        } else if (c >= 0x10000) {
+            c -= 0x10000;
+            *out++ = (jchar) (0xD800 + (c >> 10));
+            *out++ = (jchar) (0xDC00 + (c & 0x3FF));
+        } else {
+            *out++ = (jchar) c;
+        }
+    }
+    return out - dst;
+}
+
+bool pack_string_array(JNIEnv *env, jobjectArray array, PackedStrings &out) {
+    out.clear();
+    if (!array) {
+        return true;
+    }
+    const jsize count = env->GetArrayLength(array);
+    out.offsets.reserve((size_t) count + 1);
+    out.nulls.reserve((size_t) count);
+    out.bytes.reserve((size_t) count * 16);
+
+    Utf16Scratch utf16;
+    size_t copied = 0;        //统计用：最后一次性记录，见jni-stats.h
+    uint32_t refs = 0;
+    for (jsize base = 0; base < count; base += kStringFrameSize) {
+        if (env->PushLocalFrame(kStringFrameSize) != JNI_OK) {
+            return false;
+        }
+        jsize end = base + kStringFrameSize < count ? base + kStringFrameSize : count;
+        for (jsize i = base; i < end; ++i) {
+            auto str = (jstring) env->GetObjectArrayElement(array, i);
+            if (!str) {
+                out.append(nullptr, 0);
+                continue;
+            }
+            ++refs;
+            jsize len = env->GetStringLength(str);
+            jchar *chars = utf16.reserve((size_t) len);
+            if (!chars) {
+                env->PopLocalFrame(nullptr);
+                jni_throw(env, "java/lang/OutOfMemoryError", "pack_string_array: 分配UTF-16缓冲区失败");
+                return false;
+            }
+            env->GetStringRegion(str, 0, len, chars);
+            copied += (size_t) len * sizeof(jchar);
+            //先按最坏情况(每个jchar 3字节)预留，编码后再截断
+            size_t start = out.bytes.size();
+            out.bytes.resize(start + (size_t) len * 3);
+            size_t written = utf16_to_utf8(chars, (size_t) len, out.bytes.data() + start);
+            out.bytes.resize(start + written);
+            out.nulls.push_back(0);
+            out.offsets.push_back((uint32_t) out.bytes.size());
+            env->DeleteLocalRef(str);
+        }
+        //整个帧中的局部引用一次性释放
+        env->PopLocalFrame(nullptr);
+    }
+    jni_stats_add_bytes(copied);
+    jni_stats_add_local_refs(refs);
+    return !env->ExceptionCheck();
+}
+
+jobjectArray unpack_string_array(JNIEnv *env, const PackedStrings &packed) {
+    const auto count = (jsize) packed.size();
+    jobjectArray array = env->NewObjectArray(count, jni_cache().stringClass, nullptr);
+    if (!array) {
+        return nullptr;
+    }
+    Utf16Scratch utf16;
+    size_t copied = 0;
+    uint32_t refs = 1; //array
+    for (jsize base = 0; base < count; base += kStringFrameSize) {
+        if (env->PushLocalFrame(kStringFrameSize) != JNI_OK) {
+            env->DeleteLocalRef(array);
+            return nullptr;
+        }
+        jsize end = base + kStringFrameSize < count ? base + kStringFrameSize : count;
+        for (jsize i = base; i < end; ++i) {
+            if (packed.isNull((size_t) i)) {
+                continue; //NewObjectArray的初始值就是null
+            }
+            uint32_t len = packed.length((size_t) i);
+            jchar *buffer = utf16.reserve(len); //UTF-16的字符数不会超过UTF-8的字节数
+            if (!buffer) {
+                env->PopLocalFrame(nullptr);
+                env->DeleteLocalRef(array);
+                jni_throw(env, "java/lang/OutOfMemoryError", "unpack_string_array: 分配UTF-16缓冲区失败");
+                return nullptr;
+            }
+            size_t chars = utf8_to_utf16(packed.data((size_t) i), len, buffer);
+            //用NewString而不是NewStringUTF：NewStringUTF要求的是Modified UTF-8
+            jstring str = env->NewString(buffer, (jsize) chars);
+            if (!str) {
+                env->PopLocalFrame(nullptr);
+                env->DeleteLocalRef(array);
+                return nullptr;
+            }
+            env->SetObjectArrayElement(array, i, str);
+            env->DeleteLocalRef(str);
+            copied += chars * sizeof(jchar);
+            ++refs;
+        }
+        env->PopLocalFrame(nullptr);
+    }
+    jni_stats_add_bytes(copied);
+    jni_stats_add_local_refs(refs);
+    return array;
+}
@@ -0,0 +1,68 @@
+#ifndef STUDYJNI_STRING_BATCH_H
+#define STUDYJNI_STRING_BATCH_H
+
+#include <jni.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * String[] 与一块连续的native内存之间的批量转换
+ *
+ * 以前的写法：每个元素 GetObjectArrayElement + GetStringUTFChars + ReleaseStringUTFChars ...，
+ *      每次GetStringUTFChars都会分配一块新内存，并且局部引用在整个循环中一直累积
+ * 现在：
+ *      1.每个元素只有 GetObjectArrayElement + GetStringLength + GetStringRegion 三次JNI调用，
+ *        UTF-16拷贝到复用的缓冲区，再在C++中一次性编码为UTF-8追加到bytes中
+ *      2.每kStringFrameSize个元素一个局部引用帧(PushLocalFrame/PopLocalFrame)，局部引用数量有上限
+ *
+ * 编码：标准UTF-8(补充平面字符为4字节)，单独出现的代理项按3字节编码，保证往返无损
+ */
+constexpr jint kStringFrameSize = 64;
+
+//线程复用的PackedStrings在每次调用结束后最多保留的字节数，见PackedStrings::trim
+constexpr size_t kStringScratchBytes = 16 * 1024;
+
+struct PackedStrings {
+    std::vector<uint32_t> offsets;  //count + 1 个，第i个字符串为 bytes[offsets[i], offsets[i + 1])
+    std::vector<uint8_t> nulls;     //第i个元素为null时为1
+    std::vector<char> bytes;        //所有字符串的UTF-8，首尾相接，不带'\0'
+
+    size_t size() const { return nulls.size(); }
+
+    const char *data(size_t i) const { return bytes.data() + offsets[i]; }
+
+    uint32_t length(size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+    bool isNull(size_t i) const { return nulls[i] != 0; }
+
+    void clear() {
+        offsets.assign(1, 0);
+        nulls.clear();
+        bytes.clear();
+    }
+
+    //清空；容量超过maxBytes时释放内存，复用的对象不会一直占着最大一次调用的缓冲区
+    void trim(size_t maxBytes) {
+        if (bytes.capacity() > maxBytes || offsets.capacity() * sizeof(uint32_t) > maxBytes) {
+            *this = PackedStrings();
+        } else {
+            clear();
+        }
+    }
+
+    //追加一个字符串，utf8为nullptr表示null元素
+    void append(const char *utf8, uint32_t len);
+};
+
+//String[] -> PackedStrings，失败(有Java异常挂起)返回false
+bool pack_string_array(JNIEnv *env, jobjectArray array, PackedStrings &out);
+
+//PackedStrings -> String[]，失败返回nullptr
+jobjectArray unpack_string_array(JNIEnv *env, const PackedStrings &packed);
+
+//UTF-16 <-> UTF-8，返回写入的字节数/字符数。dst至少要有 len * 3 字节 / len 个jchar
+size_t utf16_to_utf8(const jchar *src, size_t len, char *dst);
+//非法的首字节、超长编码、超过U+10FFFF、被截断的序列都替换为U+FFFD
+size_t utf8_to_utf16(const char *src, size_t len, jchar *dst);
+
+#endif //STUDYJNI_STRING_BATCH_H
@@ -0,0 +1,258 @@
+#include "student-store.h"
+#include "jni-cache.h"
+#include "string-batch.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+void StudentStore::appendName(size_t row, const char *utf8, uint32_t len) {
+    if (!utf8) {
+        mNameStart[row] = kNullName;
+        mNameLength[row] = 0;
+        return;
+    }
+    mNameStart[row] = (uint32_t) mNameArena.size();
+    mNameLength[row] = len;
+    mNameArena.insert(mNameArena.end(), utf8, utf8 + len);
+}
+
+bool StudentStore::load(JNIEnv *env, jobjectArray students) {
+    mAges.clear();
+    mNameStart.clear();
+    mNameLength.clear();
+    mNameArena.clear();
+    mDirty.clear();
+    if (!students) {
+        return true;
+    }
+    const JniCache &cache = jni_cache();
+    const jsize count = env->GetArrayLength(students);
+    mAges.resize((size_t) count);
+    mNameStart.resize((size_t) count);
+    mNameLength.resize((size_t) count);
+    mDirty.assign((size_t) count, 0);
+    mNameArena.reserve((size_t) count * 8);
+
+    std::vector<jchar> utf16;
+    for (jsize base = 0; base < count; base += kStringFrameSize) {
+        if (env->PushLocalFrame(kStringFrameSize * 2) != JNI_OK) {
+            return false;
+        }
+        jsize end = std::min(base + kStringFrameSize, count);
+        for (jsize i = base; i < end; ++i) {
+            jobject student = env->GetObjectArrayElement(students, i);
+            if (!student) {
+                mAges[i] = 0;
+                appendName((size_t) i, nullptr, 0);
+                continue;
+            }
+            //直接读字段，不调用getAge()、getName()
+            mAges[i] = env->GetIntField(student, cache.studentAgeFid);
+            auto name = (jstring) env->GetObjectField(student, cache.studentNameFid);
+            if (!name) {
+                appendName((size_t) i, nullptr, 0);
+            } else {
+                jsize len = env->GetStringLength(name);
+                if (utf16.size() < (size_t) len) {
+                    utf16.resize((size_t) len);
+                }
+                env->GetStringRegion(name, 0, len, utf16.data());
+                size_t start = mNameArena.size();
+                mNameArena.resize(start + (size_t) len * 3);
+                size_t written = utf16_to_utf8(utf16.data(), (size_t) len, mNameArena.data() + start);
+                mNameArena.resize(start + written);
+                mNameStart[i] = (uint32_t) start;
+                mNameLength[i] = (uint32_t) written;
+                env->DeleteLocalRef(name);
+            }
+            env->DeleteLocalRef(student);
+        }
+        env->PopLocalFrame(nullptr);
+    }
+    return !env->ExceptionCheck();
+}
+
+bool StudentStore::validRows(const jint *rows, size_t rowCount) const {
+    for (size_t i = 0; i < rowCount; ++i) {
+        if (rows[i] < 0 || (size_t) rows[i] >= mAges.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<jint> StudentStore::filterByAge(jint minAge, jint maxAge) const {
+    std::vector<jint> rows;
+    const size_t n = mAges.size();
+    const jint *ages = mAges.data();
+    for (size_t i = 0; i < n; ++i) {
+        if (ages[i] >= minAge && ages[i] <= maxAge) {
+            rows.push_back((jint) i);
+        }
+    }
+    return rows;
+}
+
+std::vector<jint> StudentStore::sortByAge(bool ascending) const {
+    std::vector<jint> rows(mAges.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    const jint *ages = mAges.data();
+    if (ascending) {
+        std::stable_sort(rows.begin(), rows.end(), [ages](jint a, jint b) { return ages[a] < ages[b]; });
+    } else {
+        std::stable_sort(rows.begin(), rows.end(), [ages](jint a, jint b) { return ages[a] > ages[b]; });
+    }
+    return rows;
+}
+
+std::vector<jint> StudentStore::sortByName() const {
+    std::vector<jint> rows(mAges.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    std::stable_sort(rows.begin(), rows.end(), [this](jint a, jint b) {
+        bool nullA = mNameStart[a] == kNullName;
+        bool nullB = mNameStart[b] == kNullName;
+        if (nullA || nullB) {
+            return nullA && !nullB;
+        }
+        uint32_t lenA = mNameLength[a];
+        uint32_t lenB = mNameLength[b];
+        int cmp = memcmp(mNameArena.data() + mNameStart[a], mNameArena.data() + mNameStart[b],
+                         std::min(lenA, lenB));
+        return cmp < 0 || (cmp == 0 && lenA < lenB);
+    });
+    return rows;
+}
+
+//rows为nullptr时统计前n行，调用者保证行号合法
+static StudentStore::AgeStats age_stats(const jint *ages, const jint *rows, size_t n) {
+    StudentStore::AgeStats stats;
+    if (n == 0) {
+        return stats;
+    }
+    jint first = rows ? ages[rows[0]] : ages[0];
+    stats.min = first;
+    stats.max = first;
+    for (size_t i = 0; i < n; ++i) {
+        jint age = rows ? ages[rows[i]] : ages[i];
+        stats.sum += age;
+        stats.min = std::min(stats.min, age);
+        stats.max = std::max(stats.max, age);
+    }
+    stats.count = (jlong) n;
+    return stats;
+}
+
+StudentStore::AgeStats StudentStore::ageStats() const {
+    return age_stats(mAges.data(), nullptr, mAges.size());
+}
+
+bool StudentStore::ageStats(const jint *rows, size_t rowCount, AgeStats &stats) const {
+    if (!validRows(rows, rowCount)) {
+        return false;
+    }
+    //rows为空数组时统计结果为0行，而不是所有行
+    stats = rowCount == 0 ? AgeStats() : age_stats(mAges.data(), rows, rowCount);
+    return true;
+}
+
+bool StudentStore::addAge(const jint *rows, size_t rowCount, jint delta) {
+    if (!validRows(rows, rowCount)) {
+        return false;
+    }
+    for (size_t i = 0; i < rowCount; ++i) {
+        //与Java的int运算一致，溢出时回绕
+        mAges[rows[i]] = (jint) ((uint32_t) mAges[rows[i]] + (uint32_t) delta);
+        mDirty[rows[i]] |= kDirtyAge;
+    }
+    return true;
+}
+
+bool StudentStore::setName(const jint *rows, size_t rowCount, const char *utf8, uint32_t len) {
+    if (!validRows(rows, rowCount)) {
+        return false;
+    }
+    if (rowCount == 0) {
+        return true;
+    }
+    //同一个名字在arena中只存一份，所有行指向它
+    uint32_t start = kNullName;
+    if (utf8) {
+        start = (uint32_t) mNameArena.size();
+        mNameArena.insert(mNameArena.end(), utf8, utf8 + len);
+    }
+    for (size_t i = 0; i < rowCount; ++i) {
+        mNameStart[rows[i]] = start;
+        mNameLength[rows[i]] = utf8 ? len : 0;
+        mDirty[rows[i]] |= kDirtyName;
+    }
+    return true;
+}
+
+jint StudentStore::writeBack(JNIEnv *env, jobjectArray students) {
+    if (!students || env->GetArrayLength(students) != (jsize) mAges.size()) {
+        return -1;
+    }
+    const JniCache &cache = jni_cache();
+    const auto count = (jsize) mAges.size();
+    jint written = 0;
+    std::vector<jchar> utf16;
+    for (jsize base = 0; base < count; base += kStringFrameSize) {
+        jsize end = std::min(base + kStringFrameSize, count);
+        bool anyDirty = false;
+        for (jsize i = base; i < end && !anyDirty; ++i) {
+            anyDirty = mDirty[i] != 0;
+        }
+        if (!anyDirty) {
+            continue; //这一段没有修改，一次JNI调用都不需要
+        }
+        if (env->PushLocalFrame(kStringFrameSize * 2) != JNI_OK) {
+            return -1;
+        }
+        //同一个名字(arena中同一个位置、同样长度)只创建一次jstring
+        //只比较起始位置不够：空名字不占arena空间，与下一个追加的名字起始位置相同
+        uint32_t lastStart = kNullName;
+        uint32_t lastLength = 0;
+        jstring lastName = nullptr;
+        for (jsize i = base; i < end; ++i) {
+            if (!mDirty[i]) {
+                continue;
+            }
+            jobject student = env->GetObjectArrayElement(students, i);
+            if (!student) {
+                continue;
+            }
+            if (mDirty[i] & kDirtyAge) {
+                env->SetIntField(student, cache.studentAgeFid, mAges[i]);
+            }
+            if (mDirty[i] & kDirtyName) {
+                jstring name = nullptr;
+                if (mNameStart[i] != kNullName) {
+                    if (mNameStart[i] == lastStart && mNameLength[i] == lastLength && lastName) {
+                        name = lastName;
+                    } else {
+                        uint32_t len = mNameLength[i];
+                        if (utf16.size() < len) {
+                            utf16.resize(len);
+                        }
+                        size_t chars = utf8_to_utf16(mNameArena.data() + mNameStart[i], len, utf16.data());
+                        name = env->NewString(utf16.data(), (jsize) chars);
+                        if (!name) {
+                            //OutOfMemoryError挂起：不能再调用SetObjectField，这一行保持为脏
+                            env->PopLocalFrame(nullptr);
+                            return -1;
+                        }
+                        lastStart = mNameStart[i];
+                        lastLength = len;
+                        lastName = name;
+                    }
+                }
+                env->SetObjectField(student, cache.studentNameFid, name);
+            }
+            mDirty[i] = 0;
+            ++written;
+            env->DeleteLocalRef(student);
+        }
+        env->PopLocalFrame(nullptr);
+    }
+    return env->ExceptionCheck() ? -1 : written;
+}
@@ -0,0 +1,75 @@
+#ifndef STUDYJNI_STUDENT_STORE_H
+#define STUDYJNI_STUDENT_STORE_H
+
+#include <jni.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Student[] 的列式(struct-of-arrays)native存储
+ *
+ * 以前的写法：每个字段都通过 setName/getName/setAge/getAge 调用一次Java函数
+ * 现在：Student.name、Student.age 是public字段，用缓存的jfieldID直接读写，一次遍历全部载入：
+ *      age列：std::vector<jint>，过滤、聚合都是对连续内存的循环
+ *      name列：所有名字的UTF-8首尾相接存放在一块内存(arena)中，每行记录起始位置和长度
+ * 过滤、排序、聚合都在native完成，修改只记录到列中并标记为脏，writeBack()时一次性写回Java对象
+ *
+ * 行号i对应load()时Student[]的第i个元素，writeBack()必须传入同一个数组
+ */
+class StudentStore {
+public:
+    struct AgeStats {
+        jlong count = 0;
+        jlong sum = 0;
+        jint min = 0;
+        jint max = 0;
+    };
+
+    //载入Student[]，会清空之前的数据。失败(有Java异常挂起)返回false
+    bool load(JNIEnv *env, jobjectArray students);
+
+    size_t size() const { return mAges.size(); }
+
+    //===================查询===================
+    //返回age在[minAge, maxAge]内的行号
+    std::vector<jint> filterByAge(jint minAge, jint maxAge) const;
+
+    //返回按age排序后的行号(稳定排序)
+    std::vector<jint> sortByAge(bool ascending) const;
+
+    //返回按name排序后的行号(按UTF-8字节序，null排在最前面)
+    std::vector<jint> sortByName() const;
+
+    //统计所有行
+    AgeStats ageStats() const;
+
+    //统计rows中的行，非法行号返回false(与addAge、setName一致)
+    bool ageStats(const jint *rows, size_t rowCount, AgeStats &stats) const;
+
+    //===================修改(只改列，标记为脏)===================
+    //非法行号返回false
+    bool addAge(const jint *rows, size_t rowCount, jint delta);
+
+    bool setName(const jint *rows, size_t rowCount, const char *utf8, uint32_t len);
+
+    //===================写回===================
+    //把所有脏行写回students，返回写回的行数；失败返回-1，没写回的行保持为脏，可以再次writeBack()
+    jint writeBack(JNIEnv *env, jobjectArray students);
+
+private:
+    static constexpr uint32_t kNullName = 0xFFFFFFFFu;
+    static constexpr uint8_t kDirtyAge = 1;
+    static constexpr uint8_t kDirtyName = 2;
+
+    bool validRows(const jint *rows, size_t rowCount) const;
+
+    void appendName(size_t row, const char *utf8, uint32_t len);
+
+    std::vector<jint> mAges;
+    std::vector<uint32_t> mNameStart;   //kNullName表示name为null
+    std::vector<uint32_t> mNameLength;
+    std::vector<char> mNameArena;
+    std::vector<uint8_t> mDirty;
+};
+
+#endif //STUDYJNI_STUDENT_STORE_H
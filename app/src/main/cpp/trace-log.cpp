@@ -0,0 +1,457 @@
+#include "trace-log.h"
+#include "ring-buffer.h"
+#include <android/log.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <pthread.h>
+#include <semaphore.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr int kDrainIntervalMs = 100;
+static constexpr uint32_t kWakeupRecords = 64;
+
+namespace {
+
+//每个写日志的线程一个，生产者是该线程，消费者是后台线程
+struct ThreadBuffer {
+    SpscRing *ring = nullptr;
+    int tid = 0;
+    std::atomic<bool> exited{false};  //线程已退出，后台线程读完剩余记录后释放
+    uint32_t pending = 0;             //写线程私有：距离上次唤醒后台线程写入的记录数
+};
+
+struct Entry {
+    int64_t timeNs;
+    int level;
+    int tid;
+    std::string message;
+};
+
+class StderrSink : public TraceSink {
+public:
+    void write(int level, int tid, int64_t timeNs, const char *message) override;
+
+    void flush() override { fflush(stderr); }
+};
+
+}//namespace
+
+/**
+ * 全局状态在第一次使用时创建，并且永不释放：
+ * 没有调用trace_shutdown()时，进程退出析构静态对象时后台线程可能还在运行
+ */
+struct TraceState {
+    std::mutex registryMutex;            //保护buffers，只在线程第一次写日志、后台线程取快照时加锁
+    std::vector<ThreadBuffer *> buffers;
+    std::mutex drainMutex;               //保护sink和格式化过程
+    std::unique_ptr<TraceSink> sink;
+};
+
+static TraceState *sState = nullptr;
+static std::atomic<uint64_t> sDropped(0);
+static sem_t sWakeup;
+static std::atomic<bool> sStopping(false);
+static pthread_t sDrainer;
+static bool sHasDrainer = false;
+static pthread_once_t sStartOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t sBufferKey;
+static thread_local ThreadBuffer *tBuffer = nullptr;
+
+static std::unique_ptr<TraceSink> make_default_sink() {
+#ifdef __ANDROID__
+    return make_logcat_sink("lee");
+#else
+    return std::unique_ptr<TraceSink>(new StderrSink());
+#endif
+}
+
+static void drain_locked();
+
+static void *drain_main(void *) {
+    while (!sStopping.load(std::memory_order_acquire)) {
+        timespec deadline{};
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += kDrainIntervalMs * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        while (sem_timedwait(&sWakeup, &deadline) == -1 && errno == EINTR) {
+        }
+        std::lock_guard<std::mutex> lock(sState->drainMutex);
+        drain_locked();
+    }
+    return nullptr;
+}
+
+//线程退出时调用，只做标记，缓冲区由后台线程在读完之后释放
+static void mark_exited(void *buffer) {
+    static_cast<ThreadBuffer *>(buffer)->exited.store(true, std::memory_order_release);
+    tBuffer = nullptr;
+}
+
+static void start_drainer() {
+    pthread_key_create(&sBufferKey, mark_exited);
+    sem_init(&sWakeup, 0, 0);
+    sState = new TraceState();
+    sState->sink = make_default_sink();
+    sHasDrainer = pthread_create(&sDrainer, nullptr, drain_main, nullptr) == 0;
+}
+
+static ThreadBuffer *current_buffer() {
+    if (tBuffer) {
+        return tBuffer;
+    }
+    pthread_once(&sStartOnce, start_drainer);
+    SpscRing *ring = SpscRing::create(trace::kThreadRingBytes);
+    if (!ring) {
+        return nullptr;
+    }
+    auto *buffer = new ThreadBuffer();
+    buffer->ring = ring;
+    buffer->tid = (int) syscall(SYS_gettid);
+    {
+        std::lock_guard<std::mutex> lock(sState->registryMutex);
+        sState->buffers.push_back(buffer);
+    }
+    pthread_setspecific(sBufferKey, buffer);
+    tBuffer = buffer;
+    return buffer;
+}
+
+namespace trace {
+
+int64_t record_time_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void commit_record(const RecordWriter &writer) {
+    ThreadBuffer *buffer = current_buffer();
+    if (!buffer || !buffer->ring->write(writer.data(), writer.size())) {
+        sDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->ring->commit();
+    const TraceSite *site;
+    memcpy(&site, writer.data(), sizeof(site));
+    //错误日志尽快输出；连续写入很多条时也提前唤醒，避免缓冲区写满
+    if (site->level >= STUDYJNI_LEVEL_ERROR || ++buffer->pending >= kWakeupRecords) {
+        buffer->pending = 0;
+        sem_post(&sWakeup);
+    }
+}
+
+}//namespace trace
+
+//===================后台线程：解码、格式化===================
+namespace {
+
+class ArgReader {
+public:
+    ArgReader(const uint8_t *data, size_t len) : mData(data), mEnd(data + len) {}
+
+    bool next(uint8_t &tag) {
+        if (mData >= mEnd) {
+            return false;
+        }
+        tag = *mData++;
+        return true;
+    }
+
+    template<typename T>
+    bool read(T &out) {
+        if ((size_t) (mEnd - mData) < sizeof(T)) {
+            mData = mEnd;
+            return false;
+        }
+        memcpy(&out, mData, sizeof(T));
+        mData += sizeof(T);
+        return true;
+    }
+
+    bool readString(const char *&str, uint16_t &len) {
+        if (!read(len) || (size_t) (mEnd - mData) < len) {
+            mData = mEnd;
+            return false;
+        }
+        str = reinterpret_cast<const char *>(mData);
+        mData += len;
+        return true;
+    }
+
+private:
+    const uint8_t *mData;
+    const uint8_t *mEnd;
+};
+
+//取下一个整数参数，用于替换格式串中的 *
+bool next_int(ArgReader &reader, long long &value) {
+    uint8_t tag;
+    if (!reader.next(tag)) {
+        return false;
+    }
+    if (tag == trace::kTagInt32) {
+        int32_t v = 0;
+        bool ok = reader.read(v);
+        value = v;
+        return ok;
+    }
+    if (tag == trace::kTagInt64) {
+        int64_t v = 0;
+        bool ok = reader.read(v);
+        value = v;
+        return ok;
+    }
+    return false;
+}
+
+/**
+ * 按照格式串逐个还原参数：长度修饰符(l、ll、z...)被去掉，按记录时的实际类型重新生成，
+ * 所以即使调用点写的是%ld而参数是int，也不会读错
+ */
+void format_record(const trace::TraceSite *site, ArgReader &reader, std::string &out) {
+    const char *p = site->format;
+    char spec[48];
+    char tmp[trace::kMaxRecordBytes + 64];
+    while (*p) {
+        if (*p != '%') {
+            out.push_back(*p++);
+            continue;
+        }
+        ++p;
+        if (*p == '%') {
+            out.push_back('%');
+            ++p;
+            continue;
+        }
+        //spec = % + flags + width + precision，* 直接替换成参数的值
+        size_t n = 0;
+        spec[n++] = '%';
+        bool bad = false;
+        while (*p && strchr("-+ #0123456789.*", *p)) {
+            if (*p == '*') {
+                long long v = 0;
+                bad |= !next_int(reader, v);
+                int w = snprintf(spec + n, sizeof(spec) - n - 4, "%lld", v);
+                n = w > 0 ? std::min(n + (size_t) w, sizeof(spec) - 5) : n;
+            } else if (n < sizeof(spec) - 4) {
+                spec[n++] = *p;
+            }
+            ++p;
+        }
+        while (*p && strchr("hlLqjzt", *p)) {
+            ++p;
+        }
+        const char conv = *p;
+        if (!conv) {
+            break;
+        }
+        ++p;
+        uint8_t tag;
+        if (bad || !reader.next(tag)) {
+            out.append("<?>");
+            continue;
+        }
+        int written = -1;
+        if (tag == trace::kTagString) {
+            const char *str;
+            uint16_t len;
+            if (reader.readString(str, len) && conv == 's') {
+                //记录时已经按精度截断过了，这里精度就是实际长度
+                auto *dot = static_cast<char *>(memchr(spec, '.', n));
+                if (dot) {
+                    n = (size_t) (dot - spec);
+                }
+                memcpy(spec + n, ".*s", 4);
+                written = snprintf(tmp, sizeof(tmp), spec, (int) len, str);
+            }
+        } else if (tag == trace::kTagDouble) {
+            double v = 0;
+            if (reader.read(v) && strchr("fFeEgGaA", conv)) {
+                spec[n] = conv;
+                spec[n + 1] = '\0';
+                written = snprintf(tmp, sizeof(tmp), spec, v);
+            }
+        } else if (tag == trace::kTagPointer) {
+            uint64_t v = 0;
+            if (reader.read(v)) {
+                if (conv == 'p') {
+                    spec[n] = 'p';
+                    spec[n + 1] = '\0';
+                    written = snprintf(tmp, sizeof(tmp), spec, (void *) (uintptr_t) v);
+                } else if (strchr("diouxXc", conv)) {
+                    memcpy(spec + n, "ll", 2);
+                    spec[n + 2] = conv;
+                    spec[n + 3] = '\0';
+                    written = snprintf(tmp, sizeof(tmp), spec, (long long) v);
+                }
+            }
+        } else if (tag == trace::kTagInt32 || tag == trace::kTagInt64) {
+            long long v = 0;
+            bool ok;
+            if (tag == trace::kTagInt32) {
+                int32_t v32 = 0;
+                ok = reader.read(v32);
+                v = conv == 'u' || conv == 'x' || conv == 'X' || conv == 'o' ? (long long) (uint32_t) v32 : v32;
+            } else {
+                int64_t v64 = 0;
+                ok = reader.read(v64);
+                v = v64;
+            }
+            if (ok && strchr("diouxXc", conv)) {
+                if (conv == 'c') {
+                    spec[n] = 'c';
+                    spec[n + 1] = '\0';
+                    written = snprintf(tmp, sizeof(tmp), spec, (int) v);
+                } else {
+                    memcpy(spec + n, "ll", 2);
+                    spec[n + 2] = conv;
+                    spec[n + 3] = '\0';
+                    written = snprintf(tmp, sizeof(tmp), spec, v);
+                }
+            }
+        }
+        if (written < 0) {
+            out.append("<?>");
+        } else {
+            out.append(tmp, std::min((size_t) written, sizeof(tmp) - 1));
+        }
+    }
+}
+
+void StderrSink::write(int level, int tid, int64_t timeNs, const char *message) {
+    const char level_char = level >= STUDYJNI_LEVEL_ERROR ? 'E' : level >= STUDYJNI_LEVEL_INFO ? 'I' : 'D';
+    fprintf(stderr, "%lld.%06lld %d %c %s\n", (long long) (timeNs / 1000000000LL),
+            (long long) (timeNs % 1000000000LL / 1000), tid, level_char, message);
+}
+
+class LogcatSink : public TraceSink {
+public:
+    explicit LogcatSink(const char *tag) : mTag(tag) {}
+
+    void write(int level, int tid, int64_t timeNs, const char *message) override {
+        __android_log_write(level, mTag.c_str(), message);
+    }
+
+private:
+    std::string mTag;
+};
+
+class FileSink : public TraceSink {
+public:
+    explicit FileSink(FILE *file) : mFile(file) {}
+
+    ~FileSink() override { fclose(mFile); }
+
+    void write(int level, int tid, int64_t timeNs, const char *message) override {
+        const char level_char = level >= STUDYJNI_LEVEL_ERROR ? 'E' : level >= STUDYJNI_LEVEL_INFO ? 'I' : 'D';
+        fprintf(mFile, "%lld.%06lld %d %c %s\n", (long long) (timeNs / 1000000000LL),
+                (long long) (timeNs % 1000000000LL / 1000), tid, level_char, message);
+    }
+
+    void flush() override { fflush(mFile); }
+
+private:
+    FILE *mFile;
+};
+
+}//namespace
+
+static void drain_locked() {
+    std::vector<ThreadBuffer *> buffers;
+    {
+        std::lock_guard<std::mutex> lock(sState->registryMutex);
+        buffers = sState->buffers;
+    }
+    std::vector<Entry> entries;
+    std::vector<ThreadBuffer *> finished;
+    for (ThreadBuffer *buffer : buffers) {
+        //先读exited再读记录：看到exited == true时，该线程的所有记录都已经发布
+        bool exited = buffer->exited.load(std::memory_order_acquire);
+        buffer->ring->drain([&](const uint8_t *payload, uint32_t len) {
+            const trace::TraceSite *site;
+            int64_t timeNs;
+            if (len < sizeof(site) + sizeof(timeNs)) {
+                return true;
+            }
+            memcpy(&site, payload, sizeof(site));
+            memcpy(&timeNs, payload + sizeof(site), sizeof(timeNs));
+            ArgReader reader(payload + sizeof(site) + sizeof(timeNs), len - sizeof(site) - sizeof(timeNs));
+            Entry entry{timeNs, site->level, buffer->tid, std::string()};
+            format_record(site, reader, entry.message);
+            entries.push_back(std::move(entry));
+            return true;
+        });
+        if (exited) {
+            finished.push_back(buffer);
+        }
+    }
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(sState->registryMutex);
+        std::vector<ThreadBuffer *> &all = sState->buffers;
+        for (ThreadBuffer *buffer : finished) {
+            all.erase(std::find(all.begin(), all.end(), buffer));
+            delete buffer->ring;
+            delete buffer;
+        }
+    }
+    if (entries.empty() || !sState->sink) {
+        return;
+    }
+    //各线程的记录合并成一条时间线
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry &a, const Entry &b) { return a.timeNs < b.timeNs; });
+    for (const Entry &entry : entries) {
+        sState->sink->write(entry.level, entry.tid, entry.timeNs, entry.message.c_str());
+    }
+    sState->sink->flush();
+}
+
+std::unique_ptr<TraceSink> make_logcat_sink(const char *tag) {
+    return std::unique_ptr<TraceSink>(new LogcatSink(tag));
+}
+
+std::unique_ptr<TraceSink> make_file_sink(const char *path) {
+    FILE *file = fopen(path, "a");
+    if (!file) {
+        return nullptr;
+    }
+    return std::unique_ptr<TraceSink>(new FileSink(file));
+}
+
+void trace_set_sink(std::unique_ptr<TraceSink> sink) {
+    pthread_once(&sStartOnce, start_drainer);
+    std::lock_guard<std::mutex> lock(sState->drainMutex);
+    drain_locked();
+    sState->sink = sink ? std::move(sink) : make_default_sink();
+}
+
+void trace_flush() {
+    pthread_once(&sStartOnce, start_drainer);
+    std::lock_guard<std::mutex> lock(sState->drainMutex);
+    drain_locked();
+}
+
+void trace_shutdown() {
+    //pthread_once之后才能安全地读取sHasDrainer(从来没有写过日志时在这里启动，马上又停止)
+    pthread_once(&sStartOnce, start_drainer);
+    //只在JNI_OnUnload中调用一次，不与其它trace_shutdown()并发
+    if (sHasDrainer) {
+        sHasDrainer = false;
+        sStopping.store(true, std::memory_order_release);
+        sem_post(&sWakeup);
+        pthread_join(sDrainer, nullptr);
+    }
+    trace_flush();
+}
+
+uint64_t trace_dropped() {
+    return sDropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,318 @@
+#ifndef STUDYJNI_TRACE_LOG_H
+#define STUDYJNI_TRACE_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 低开销的二进制日志，取代在JNI调用路径上直接 __android_log_print
+ *
+ * 以前：每条LOGD都在调用线程上做printf格式化 + 写logcat(系统调用)，并且Release版本也无法去掉
+ * 现在：
+ *      1.编译期分级：低于STUDYJNI_LOG_LEVEL的日志展开为空语句，参数都不会求值
+ *      2.调用线程只写二进制记录：[调用点指针(即format-id)][时间戳][原始参数]，写入本线程的无锁环形缓冲区
+ *      3.后台线程定期取出所有线程的记录，按时间排序、格式化，再交给TraceSink(logcat、文件...)
+ *
+ * 格式串在编译期解析(parse_format)：参数个数与格式串不一致直接编译失败；
+ * %s只拷贝需要的字节(%.*s、%.3s按精度截断)，所以传入的字符串在记录后可以立即释放
+ *
+ * 注意：日志是异步输出的，进程崩溃前最后的若干条可能来不及输出；需要时调用trace_flush()
+ */
+
+//与android/log.h的优先级一致
+#define STUDYJNI_LEVEL_DEBUG 3
+#define STUDYJNI_LEVEL_INFO 4
+#define STUDYJNI_LEVEL_ERROR 6
+#define STUDYJNI_LEVEL_NONE 100
+
+#ifndef STUDYJNI_LOG_LEVEL
+#define STUDYJNI_LOG_LEVEL STUDYJNI_LEVEL_DEBUG
+#endif
+
+namespace trace {
+
+constexpr size_t kMaxArgs = 16;
+constexpr size_t kMaxRecordBytes = 512;      //单条记录的最大字节数，超出的字符串会被截断
+constexpr size_t kThreadRingBytes = 16 * 1024; //每个线程的缓冲区大小
+
+enum ArgKind : uint8_t {
+    kArgValue = 0,   //整数、浮点数、指针
+    kArgString = 1,  //%s
+    kArgStar = 2,    //宽度或精度中的 *
+};
+
+//格式串的编译期解析结果
+struct FormatInfo {
+    uint8_t argc = 0;
+    bool overflow = false;
+    uint8_t kind[kMaxArgs] = {};
+    int16_t precision[kMaxArgs] = {}; //只对%s有效：-1无精度，-2由前一个*参数决定，>=0为字面精度
+};
+
+constexpr bool is_flag(char c) {
+    return c == '-' || c == '+' || c == ' ' || c == '#' || c == '0';
+}
+
+constexpr bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool is_length(char c) {
+    return c == 'h' || c == 'l' || c == 'L' || c == 'q' || c == 'j' || c == 'z' || c == 't';
+}
+
+constexpr void push_arg(FormatInfo &info, uint8_t kind, int16_t precision) {
+    if (info.argc >= kMaxArgs) {
+        info.overflow = true;
+        return;
+    }
+    info.kind[info.argc] = kind;
+    info.precision[info.argc] = precision;
+    ++info.argc;
+}
+
+template<size_t N>
+constexpr FormatInfo parse_format(const char (&fmt)[N]) {
+    FormatInfo info;
+    size_t i = 0;
+    while (i < N && fmt[i]) {
+        if (fmt[i++] != '%') {
+            continue;
+        }
+        if (fmt[i] == '%') {
+            ++i;
+            continue;
+        }
+        while (is_flag(fmt[i])) {
+            ++i;
+        }
+        if (fmt[i] == '*') {
+            push_arg(info, kArgStar, -1);
+            ++i;
+        } else {
+            while (is_digit(fmt[i])) {
+                ++i;
+            }
+        }
+        int16_t precision = -1;
+        if (fmt[i] == '.') {
+            ++i;
+            if (fmt[i] == '*') {
+                push_arg(info, kArgStar, -1);
+                precision = -2;
+                ++i;
+            } else {
+                precision = 0;
+                while (is_digit(fmt[i])) {
+                    precision = (int16_t) (precision * 10 + (fmt[i] - '0'));
+                    ++i;
+                }
+            }
+        }
+        while (is_length(fmt[i])) {
+            ++i;
+        }
+        if (!fmt[i]) {
+            break;
+        }
+        push_arg(info, fmt[i] == 's' ? kArgString : kArgValue, precision);
+        ++i;
+    }
+    return info;
+}
+
+//每个日志调用点一个静态常量，它的地址就是format-id
+struct TraceSite {
+    int level;
+    const char *format;
+    FormatInfo info;
+};
+
+//二进制记录中参数的类型标记
+enum ArgTag : uint8_t {
+    kTagInt32 = 'i',
+    kTagInt64 = 'l',
+    kTagDouble = 'd',
+    kTagString = 's',
+    kTagPointer = 'p',
+};
+
+//调用线程上的编码器，写满kMaxRecordBytes后的参数被丢弃
+class RecordWriter {
+public:
+    RecordWriter(const TraceSite *site, int64_t timeNs) : mSite(site) {
+        put(&site, sizeof(site));
+        put(&timeNs, sizeof(timeNs));
+    }
+
+    template<typename T>
+    void arg(T value) {
+        using D = std::decay_t<T>;
+        if constexpr (std::is_same_v<D, char *> || std::is_same_v<D, const char *>) {
+            string(value);
+        } else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+            auto bits = (uint64_t) (uintptr_t) value;
+            tagged(kTagPointer, &bits, sizeof(bits));
+        } else if constexpr (std::is_floating_point_v<D>) {
+            auto v = (double) value;
+            tagged(kTagDouble, &v, sizeof(v));
+        } else if constexpr (std::is_enum_v<D> || std::is_integral_v<D>) {
+            //与printf的默认参数提升一致：不超过int的类型按int32，其余按int64
+            if constexpr (sizeof(D) <= sizeof(int32_t)) {
+                auto v = (int32_t) value;
+                mLastInt = v;
+                tagged(kTagInt32, &v, sizeof(v));
+            } else {
+                auto v = (int64_t) value;
+                mLastInt = (int32_t) v;
+                tagged(kTagInt64, &v, sizeof(v));
+            }
+        } else {
+            static_assert(std::is_arithmetic_v<D>, "trace: 不支持的日志参数类型");
+        }
+        ++mIndex;
+    }
+
+    const uint8_t *data() const { return mBuffer; }
+
+    uint32_t size() const { return (uint32_t) mSize; }
+
+private:
+    void string(const char *s) {
+        if (!s) {
+            s = "(null)";
+        }
+        size_t limit = kMaxRecordBytes;
+        if (mIndex < kMaxArgs) {
+            int16_t precision = mSite->info.precision[mIndex];
+            if (precision >= 0) {
+                limit = (size_t) precision;
+            } else if (precision == -2) {
+                limit = mLastInt < 0 ? kMaxRecordBytes : (size_t) mLastInt;
+            }
+        }
+        //只扫描需要的长度：%.*s的字符串可以没有'\0'
+        size_t len = strnlen(s, limit);
+        size_t room = kMaxRecordBytes - mSize;
+        if (room < 1 + sizeof(uint16_t)) {
+            return;
+        }
+        room -= 1 + sizeof(uint16_t);
+        if (len > room) {
+            len = room;
+        }
+        auto len16 = (uint16_t) len;
+        mBuffer[mSize++] = kTagString;
+        put(&len16, sizeof(len16));
+        put(s, len);
+    }
+
+    void tagged(uint8_t tag, const void *value, size_t len) {
+        if (mSize + 1 + len > kMaxRecordBytes) {
+            return;
+        }
+        mBuffer[mSize++] = tag;
+        put(value, len);
+    }
+
+    void put(const void *value, size_t len) {
+        memcpy(mBuffer + mSize, value, len);
+        mSize += len;
+    }
+
+    const TraceSite *mSite;
+    size_t mSize = 0;
+    size_t mIndex = 0;
+    int32_t mLastInt = -1;
+    uint8_t mBuffer[kMaxRecordBytes];
+};
+
+//写入本线程的缓冲区，缓冲区满时丢弃并计数
+void commit_record(const RecordWriter &writer);
+
+int64_t record_time_ns();
+
+template<typename... Args>
+inline void record(const TraceSite *site, Args &&... args) {
+    RecordWriter writer(site, record_time_ns());
+    (writer.arg(std::forward<Args>(args)), ...);
+    commit_record(writer);
+}
+
+//只用于在decltype、sizeof中得到参数个数，不会被调用
+template<typename... Args>
+std::integral_constant<size_t, sizeof...(Args)> count_args(Args &&...);
+
+}//namespace trace
+
+/**
+ * 输出端，在后台线程中调用，同一时间只有一个线程调用
+ * @level: ANDROID_LOG_DEBUG、ANDROID_LOG_INFO ...
+ * @tid: 写日志的线程
+ */
+class TraceSink {
+public:
+    virtual ~TraceSink() = default;
+
+    virtual void write(int level, int tid, int64_t timeNs, const char *message) = 0;
+
+    virtual void flush() {}
+};
+
+//输出到logcat
+std::unique_ptr<TraceSink> make_logcat_sink(const char *tag);
+
+//追加写入文件(Linux桌面或者设备上的私有目录)，打开失败返回nullptr
+std::unique_ptr<TraceSink> make_file_sink(const char *path);
+
+//替换输出端，之前缓冲的日志先输出到旧的输出端。传nullptr恢复默认(Android: logcat, 其它: stderr)
+void trace_set_sink(std::unique_ptr<TraceSink> sink);
+
+//同步输出所有线程中已缓冲的日志
+void trace_flush();
+
+/**
+ * 停止并回收后台线程(JNI_OnUnload中调用，so被卸载后不能再有线程执行其中的代码)，最后再输出一次
+ * 之后的日志只在调用trace_flush()时输出
+ */
+void trace_shutdown(); //只调用一次
+
+//因缓冲区满被丢弃的记录数
+uint64_t trace_dropped();
+
+//没有被编译掉的日志才会展开为记录调用
+#define STUDYJNI_TRACE(level, fmt, ...)                                                            \
+    do {                                                                                           \
+        static constexpr ::trace::TraceSite kTraceSite{level, fmt, ::trace::parse_format(fmt)};    \
+        static_assert(!kTraceSite.info.overflow, "trace: 参数太多");                                \
+        static_assert(decltype(::trace::count_args(__VA_ARGS__))::value == kTraceSite.info.argc,   \
+                      "trace: 参数个数与格式串不一致");                                               \
+        ::trace::record(&kTraceSite, ##__VA_ARGS__);                                               \
+    } while (0)
+
+//被编译掉的日志：参数只出现在sizeof中，不会求值，也不会产生"变量未使用"的警告
+#define STUDYJNI_TRACE_OFF(...) ((void) sizeof(::trace::count_args(__VA_ARGS__)))
+
+#if STUDYJNI_LOG_LEVEL <= STUDYJNI_LEVEL_DEBUG
+#define TRACE_D(fmt, ...) STUDYJNI_TRACE(STUDYJNI_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define TRACE_D(fmt, ...) STUDYJNI_TRACE_OFF(__VA_ARGS__)
+#endif
+
+#if STUDYJNI_LOG_LEVEL <= STUDYJNI_LEVEL_INFO
+#define TRACE_I(fmt, ...) STUDYJNI_TRACE(STUDYJNI_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define TRACE_I(fmt, ...) STUDYJNI_TRACE_OFF(__VA_ARGS__)
+#endif
+
+#if STUDYJNI_LOG_LEVEL <= STUDYJNI_LEVEL_ERROR
+#define TRACE_E(fmt, ...) STUDYJNI_TRACE(STUDYJNI_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define TRACE_E(fmt, ...) STUDYJNI_TRACE_OFF(__VA_ARGS__)
+#endif
+
+#endif //STUDYJNI_TRACE_LOG_H
@@ -0,0 +1,195 @@
+#include "work-stealing.h"
+#include "jni-log.h"
+#include <unistd.h>
+
+static constexpr size_t kMaxThreads = 16;
+
+struct WorkerArgs {
+    WorkStealingPool *pool;
+    size_t slot;
+    uint64_t generation; //创建时的mGeneration，之前的parallelFor与新线程无关
+};
+
+static inline uint64_t pack_range(uint32_t begin, uint32_t end) {
+    return ((uint64_t) end << 32) | begin;
+}
+
+static inline uint32_t range_begin(uint64_t bounds) { return (uint32_t) bounds; }
+
+static inline uint32_t range_end(uint64_t bounds) { return (uint32_t) (bounds >> 32); }
+
+WorkStealingPool &WorkStealingPool::instance() {
+    //不释放：没有调用shutdown()时，静态对象析构时工作线程可能还在等待条件变量
+    static WorkStealingPool *pool = new WorkStealingPool();
+    return *pool;
+}
+
+static size_t cpu_count() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t count = cpus < 1 ? 1 : (size_t) cpus;
+    return count > kMaxThreads ? kMaxThreads : count;
+}
+
+WorkStealingPool::WorkStealingPool()
+        : mConcurrency(cpu_count()), mRanges(new Range[cpu_count()]) {}
+
+//只在持有mCallMutex时调用
+void WorkStealingPool::ensureThreads(size_t count) {
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        generation = mGeneration;
+    }
+    while (mThreads.size() < count) {
+        auto *args = new WorkerArgs{this, mThreads.size() + 1, generation};
+        pthread_t tid;
+        if (pthread_create(&tid, nullptr, worker_main, args) != 0) {
+            delete args;
+            LOGE("WorkStealingPool: 创建线程失败，只使用%zu个线程", mThreads.size() + 1)
+            return;
+        }
+        mThreads.push_back(tid); //常驻线程，shutdown()时回收
+    }
+}
+
+size_t WorkStealingPool::parallelFor(size_t chunks, size_t threads, const Body &body) {
+    if (threads == 0 || threads > mConcurrency) {
+        threads = mConcurrency;
+    }
+    if (threads > chunks) {
+        threads = chunks;
+    }
+    //串行：不唤醒任何线程，按顺序执行
+    if (threads <= 1 || chunks > UINT32_MAX) {
+        for (size_t i = 0; i < chunks; ++i) {
+            body(i, 0);
+        }
+        return 1;
+    }
+
+    std::lock_guard<std::mutex> callLock(mCallMutex);
+    ensureThreads(threads - 1);
+    threads = mThreads.size() + 1 < threads ? mThreads.size() + 1 : threads;
+    //每个线程一段连续的chunk，余数分给前面的线程
+    size_t begin = 0;
+    for (size_t slot = 0; slot < threads; ++slot) {
+        size_t count = chunks / threads + (slot < chunks % threads ? 1 : 0);
+        mRanges[slot].bounds.store(pack_range((uint32_t) begin, (uint32_t) (begin + count)),
+                                   std::memory_order_relaxed);
+        begin += count;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBody = &body;
+        mParticipants = threads;
+        mBusy = threads - 1;
+        ++mGeneration; //mutex保证工作线程看到mGeneration变化时，也能看到上面写入的段
+    }
+    mWakeup.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mFinished.wait(lock, [this] { return mBusy == 0; });
+    mBody = nullptr;
+    return threads;
+}
+
+void WorkStealingPool::shutdown() {
+    std::lock_guard<std::mutex> callLock(mCallMutex); //等正在执行的parallelFor
+    if (mThreads.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWakeup.notify_all();
+    for (pthread_t tid : mThreads) {
+        pthread_join(tid, nullptr);
+    }
+    mThreads.clear();
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = false;
+}
+
+bool WorkStealingPool::popFront(size_t slot, size_t &chunk) {
+    std::atomic<uint64_t> &bounds = mRanges[slot].bounds;
+    uint64_t current = bounds.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t b = range_begin(current);
+        uint32_t e = range_end(current);
+        if (b >= e) {
+            return false;
+        }
+        //失败时current被更新为最新值(被偷走了一部分)，重试
+        if (bounds.compare_exchange_weak(current, pack_range(b + 1, e), std::memory_order_acq_rel)) {
+            chunk = b;
+            return true;
+        }
+    }
+}
+
+bool WorkStealingPool::steal(size_t slot, size_t &chunk) {
+    const size_t participants = mParticipants;
+    for (size_t i = 1; i < participants; ++i) {
+        size_t victim = (slot + i) % participants;
+        std::atomic<uint64_t> &bounds = mRanges[victim].bounds;
+        uint64_t current = bounds.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t b = range_begin(current);
+            uint32_t e = range_end(current);
+            if (b >= e) {
+                break; //这个线程也没有了，看下一个
+            }
+            //从后面偷走一半(向上取整)，被偷的线程继续从前面取，两者不会冲突
+            uint32_t mid = e - (e - b + 1) / 2;
+            if (bounds.compare_exchange_weak(current, pack_range(b, mid), std::memory_order_acq_rel)) {
+                chunk = mid;
+                //自己的段此时是空的，别的线程只会CAS非空的段，直接写入即可
+                mRanges[slot].bounds.store(pack_range(mid + 1, e), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(size_t slot) {
+    const Body &body = *mBody;
+    size_t chunk;
+    //每个chunk下标只会被取走一次；所有段都空了就结束(别的线程手上可能还有正在执行的chunk)
+    while (popFront(slot, chunk) || steal(slot, chunk)) {
+        body(chunk, slot);
+    }
+}
+
+void *WorkStealingPool::worker_main(void *args) {
+    auto *workerArgs = static_cast<WorkerArgs *>(args);
+    WorkStealingPool *pool = workerArgs->pool;
+    const size_t slot = workerArgs->slot;
+    uint64_t seen = workerArgs->generation;
+    delete workerArgs;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(pool->mMutex);
+            pool->mWakeup.wait(lock, [pool, seen] { return pool->mGeneration != seen || pool->mStopping; });
+            if (pool->mStopping) {
+                return nullptr;
+            }
+            seen = pool->mGeneration;
+            if (slot >= pool->mParticipants) {
+                continue; //本次不需要这么多线程
+            }
+        }
+        pool->work(slot);
+        {
+            std::lock_guard<std::mutex> lock(pool->mMutex);
+            if (--pool->mBusy == 0) {
+                pool->mFinished.notify_one();
+            }
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,92 @@
+#ifndef STUDYJNI_WORK_STEALING_H
+#define STUDYJNI_WORK_STEALING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <vector>
+
+/**
+ * 纯计算的work-stealing线程池，只执行parallelFor，不涉及任何JNI调用
+ *
+ * 与WorkerPool的区别：
+ *      WorkerPool的线程附加了JNIEnv，执行独立的小任务(可以回调Java)；
+ *      这里的线程不附加JNIEnv，把一个大循环拆成chunk，调用者线程也参与计算，全部完成才返回
+ *
+ * 调度：
+ *      1.[0, chunks)先平均分成连续的几段，每个参与的线程一段(相邻的chunk在同一个线程，缓存更友好)
+ *      2.每段是一个64位原子变量[begin, end)，自己从前面取，一次一个
+ *      3.自己的段取完后，去别的线程那里偷：从后面一次偷走一半，偷来的变成自己的段
+ *      所以chunk的耗时不均匀(e.g: 排序)时，先做完的线程会去分担其它线程的工作
+ *
+ * 同一时间只执行一个parallelFor，其它调用者排队；不能在body中再调用parallelFor
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @chunk: chunk的下标
+     * @slot: 执行该chunk的线程编号，[0, threads)，调用者线程为0。可用于每个线程一份的中间结果
+     */
+    using Body = std::function<void(size_t chunk, size_t slot)>;
+
+    static WorkStealingPool &instance();
+
+    //CPU核数(包括调用者线程)
+    size_t concurrency() const { return mConcurrency; }
+
+    /**
+     * 对[0, chunks)中的每个chunk调用一次body，返回时全部执行完
+     * @threads: 最多使用的线程数(包括调用者)，0表示concurrency()。chunks < 2或者threads == 1时直接在调用者线程中顺序执行
+     * @return: 实际参与的线程数
+     */
+    size_t parallelFor(size_t chunks, size_t threads, const Body &body);
+
+    /**
+     * 等正在执行的parallelFor完成后，停止并回收所有工作线程(JNI_OnUnload中调用)
+     * 之后再parallelFor会重新创建线程
+     */
+    void shutdown();
+
+private:
+    //一个线程的段，begin在低32位、end在高32位。独占缓存行，避免线程之间的伪共享
+    struct alignas(64) Range {
+        std::atomic<uint64_t> bounds{0};
+    };
+
+    WorkStealingPool();
+
+    void ensureThreads(size_t count);
+
+    //自己的段中取一个
+    bool popFront(size_t slot, size_t &chunk);
+
+    //从其它线程的段后面偷一半，成功时第一个chunk通过@chunk返回，其余的放进自己的段
+    bool steal(size_t slot, size_t &chunk);
+
+    void work(size_t slot);
+
+    static void *worker_main(void *args);
+
+    const size_t mConcurrency;
+    std::unique_ptr<Range[]> mRanges;  //每个线程一个，下标即slot
+
+    std::mutex mCallMutex;  //同一时间只有一个parallelFor
+
+    //以下由mMutex保护
+    std::mutex mMutex;
+    std::condition_variable mWakeup;
+    std::condition_variable mFinished;
+    uint64_t mGeneration = 0;   //每次parallelFor加1，工作线程据此知道有新任务
+    bool mStopping = false;     //shutdown()：工作线程醒来后退出
+    size_t mParticipants = 0;   //本次参与的线程数(包括调用者)
+    size_t mBusy = 0;           //本次还没做完的工作线程数
+    const Body *mBody = nullptr;
+    std::vector<pthread_t> mThreads;
+};
+
+#endif //STUDYJNI_WORK_STEALING_H
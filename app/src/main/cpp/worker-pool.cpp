@@ -0,0 +1,161 @@
+#include "worker-pool.h"
+#include "jni-thread.h"
+#include "jni-log.h"
+#include <algorithm>
+#include <sched.h>
+#include <unistd.h>
+
+static constexpr size_t kTaskQueueCapacity = 1024;
+static constexpr size_t kMaxWorkers = 8;
+
+static thread_local bool tIsWorker = false;
+
+WorkerPool &WorkerPool::instance() {
+    static WorkerPool pool;
+    return pool;
+}
+
+WorkerPool::WorkerPool() : mQueue(kTaskQueueCapacity) {
+    sem_init(&mSemaphore, 0, 0);
+    sem_init(&mStarted, 0, 0);
+}
+
+bool WorkerPool::isWorkerThread() {
+    return tIsWorker;
+}
+
+bool WorkerPool::ensureStarted() {
+    if (mRunning.load(std::memory_order_acquire)) {
+        return true;
+    }
+    if (tIsWorker) {
+        //工作线程不能重新启动线程池：shutdown()持有mLifecycleMutex等待工作线程退出，这里加锁会死锁
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mLifecycleMutex);
+    if (mRunning.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (!::jvm) {
+        LOGE("WorkerPool: JNI_OnLoad还未执行，无法启动")
+        return false;
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t count = cpus < 2 ? 2 : (size_t) cpus;
+    if (count > kMaxWorkers) {
+        count = kMaxWorkers;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pthread_t tid;
+        if (pthread_create(&tid, nullptr, worker_main, this) == 0) {
+            mThreads.push_back(tid);
+        }
+    }
+    //等每个线程报告附加结果：附加失败的线程已经退出，不能留在mThreads中，
+    //否则shutdown()为它投递的退出信号会留在队列里，下次启动后杀掉一个正常的工作线程
+    for (size_t i = 0; i < mThreads.size(); ++i) {
+        sem_wait(&mStarted);
+    }
+    {
+        std::lock_guard<std::mutex> failedLock(mFailedMutex);
+        for (pthread_t tid : mFailed) {
+            pthread_join(tid, nullptr);
+            mThreads.erase(std::find_if(mThreads.begin(), mThreads.end(),
+                                        [tid](pthread_t t) { return pthread_equal(t, tid); }));
+        }
+        mFailed.clear();
+    }
+    if (mThreads.empty()) {
+        LOGE("WorkerPool: 创建工作线程失败")
+        return false;
+    }
+    mRunning.store(true, std::memory_order_release);
+    LOGD("WorkerPool: 已启动%zu个工作线程", mThreads.size())
+    return true;
+}
+
+bool WorkerPool::submit(Task task) {
+    if (!task) {
+        return false;
+    }
+    //先登记再检查mRunning(同CallbackDispatcher::post)：shutdown()先清mRunning再等mSubmitters归零，
+    //两者都是seq_cst，任务要么在退出信号之前入队，要么看到mRunning == false重新启动线程池
+    for (;;) {
+        mSubmitters.fetch_add(1, std::memory_order_seq_cst);
+        if (mRunning.load(std::memory_order_seq_cst)) {
+            break;
+        }
+        mSubmitters.fetch_sub(1, std::memory_order_release);
+        if (!ensureStarted()) {
+            return false;
+        }
+    }
+    bool ok = mQueue.tryPush(task);
+    if (ok) {
+        sem_post(&mSemaphore);
+    }
+    mSubmitters.fetch_sub(1, std::memory_order_release);
+    if (!ok) {
+        LOGE("WorkerPool: 任务队列已满")
+    }
+    return ok;
+}
+
+void WorkerPool::shutdown() {
+    std::lock_guard<std::mutex> lock(mLifecycleMutex);
+    if (!mRunning.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (tIsWorker) {
+        LOGE("WorkerPool: 不能在工作线程中shutdown")
+        return;
+    }
+    mRunning.store(false, std::memory_order_seq_cst);
+    //等正在submit()的线程离开，之后不会再有任务排在退出信号后面
+    while (mSubmitters.load(std::memory_order_seq_cst) != 0) {
+        sched_yield();
+    }
+    //每个线程一个空任务作为退出信号。队列是FIFO，之前提交的任务会先执行完
+    for (size_t i = 0; i < mThreads.size(); ++i) {
+        while (!mQueue.tryPush(Task())) {
+            sched_yield(); //队列满了，等工作线程消化
+        }
+        sem_post(&mSemaphore);
+    }
+    for (pthread_t tid : mThreads) {
+        pthread_join(tid, nullptr);
+    }
+    mThreads.clear();
+    LOGD("WorkerPool: 已停止")
+}
+
+void *WorkerPool::worker_main(void *args) {
+    auto *pool = static_cast<WorkerPool *>(args);
+    tIsWorker = true;
+    //一生只附加一次，线程退出时自动Detach
+    JNIEnv *env = attach_current_thread("study_jni-worker");
+    if (!env) {
+        std::lock_guard<std::mutex> lock(pool->mFailedMutex);
+        pool->mFailed.push_back(pthread_self());
+        sem_post(&pool->mStarted);
+        return nullptr;
+    }
+    sem_post(&pool->mStarted);
+    for (;;) {
+        sem_wait(&pool->mSemaphore);
+        Task task;
+        //信号量保证一定有任务，但对应的槽位可能还没写完，稍等即可
+        while (!pool->mQueue.tryPop(task)) {
+            sched_yield();
+        }
+        if (!task) {
+            break; //退出信号
+        }
+        task(env);
+        if (env->ExceptionCheck()) {
+            env->ExceptionDescribe();
+            env->ExceptionClear(); //不能让一个任务的异常影响后面的任务
+        }
+    }
+    return nullptr; //线程退出，pthread_key析构函数中DetachCurrentThread
+}
@@ -0,0 +1,67 @@
+#ifndef STUDYJNI_WORKER_POOL_H
+#define STUDYJNI_WORKER_POOL_H
+
+#include <jni.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <pthread.h>
+#include <semaphore.h>
+#include <vector>
+#include "mpmc-queue.h"
+
+/**
+ * 常驻的native线程池
+ *
+ * 以前的写法：每次nativeThread()都 pthread_create + AttachCurrentThread + DetachCurrentThread + pthread_join
+ * 现在：
+ *      1.固定数量的工作线程，第一次submit()时才创建(此时JNI_OnLoad已保存::jvm)
+ *      2.每个工作线程一生只Attach一次，线程退出时由pthread_key的析构函数Detach，见jni-thread.h
+ *      3.任务通过无锁队列提交，空闲线程阻塞在信号量上，不空转
+ *
+ * 任务拿到的JNIEnv属于工作线程，只能在任务内使用；
+ * 任务里创建的局部引用，任务结束前要自己DeleteLocalRef(工作线程不会返回Java，局部引用不会自动释放)
+ */
+class WorkerPool {
+public:
+    using Task = std::function<void(JNIEnv *)>;
+
+    static WorkerPool &instance();
+
+    /**
+     * 提交任务，线程池没启动时会先启动(工作线程中提交时不会启动)
+     * @return: 队列已满、JavaVM不可用、或者在工作线程中提交而线程池已停止时返回false，任务不会执行
+     */
+    bool submit(Task task);
+
+    /**
+     * 执行完队列中已有的任务后，停止并回收所有工作线程
+     * 之后再submit()会重新启动线程池
+     * 注意：不能在工作线程中调用
+     */
+    void shutdown();
+
+    size_t threadCount() const { return mThreads.size(); }
+
+    //当前线程是否是本线程池的工作线程
+    static bool isWorkerThread();
+
+private:
+    WorkerPool();
+
+    bool ensureStarted();
+
+    static void *worker_main(void *args);
+
+    MpmcQueue<Task> mQueue;
+    sem_t mSemaphore;
+    std::mutex mLifecycleMutex;  //只保护启动/停止，不在任务提交的路径上
+    std::atomic<bool> mRunning{false};
+    std::atomic<int> mSubmitters{0}; //正在submit()的线程数，shutdown()等它归零后才投递退出信号
+    std::vector<pthread_t> mThreads; //只包含附加JNIEnv成功的线程，每个线程对应一个退出信号
+    sem_t mStarted;                  //启动时每个工作线程报告一次附加结果
+    std::mutex mFailedMutex;
+    std::vector<pthread_t> mFailed;  //附加失败、已经退出的线程，由ensureStarted()回收
+};
+
+#endif //STUDYJNI_WORKER_POOL_H
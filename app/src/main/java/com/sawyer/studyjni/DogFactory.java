@@ -0,0 +1,60 @@
+package com.sawyer.studyjni;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * 一次native调用批量创建Dog[]，见dog-factory.h
+ *
+ * 构造参数按对象顺序连续存放：
+ *      CTOR_DEFAULT：不需要参数，args可以为null
+ *      CTOR_INT：    [num_0, num_1, ...]，共count个
+ *      CTOR_INT_INT：[num1_0, num2_0, num1_1, num2_1, ...]，共2 * count个
+ */
+public final class DogFactory {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    //构造函数，与dog-factory.h的DogCtor一致
+    public static final int CTOR_DEFAULT = 0; //Dog()
+    public static final int CTOR_INT = 1;     //Dog(int)
+    public static final int CTOR_INT_INT = 2; //Dog(int, int)
+
+    private DogFactory() {
+    }
+
+    //构造函数的参数个数
+    public static int arity(int ctor) {
+        switch (ctor) {
+            case CTOR_DEFAULT:
+                return 0;
+            case CTOR_INT:
+                return 1;
+            case CTOR_INT_INT:
+                return 2;
+            default:
+                throw new IllegalArgumentException("ctor = " + ctor);
+        }
+    }
+
+    public static Dog[] create(int ctor, int count, int[] args) {
+        return nativeCreate(ctor, count, args);
+    }
+
+    /**
+     * args为DirectByteBuffer(本机字节序，见allocateArgs())，读取[position(), limit())，native直接读这块内存，不拷贝
+     */
+    public static Dog[] create(int ctor, int count, ByteBuffer args) {
+        return nativeCreateDirect(ctor, count, args, args == null ? 0 : args.position(), args == null ? 0 : args.remaining());
+    }
+
+    //分配能放下count个对象构造参数的DirectByteBuffer，用putInt()依次写入后flip()
+    public static ByteBuffer allocateArgs(int ctor, int count) {
+        return ByteBuffer.allocateDirect(count * arity(ctor) * 4).order(ByteOrder.nativeOrder());
+    }
+
+    private static native Dog[] nativeCreate(int ctor, int count, int[] args);
+    private static native Dog[] nativeCreateDirect(int ctor, int count, ByteBuffer args, int offset, int length);
+}
@@ -0,0 +1,80 @@
+package com.sawyer.studyjni;
+
+import java.io.Closeable;
+
+/**
+ * Java对象字段的native镜像，见field-mirror.h
+ *
+ * 用法(每帧一次)：
+ *      FieldMirror mirror = FieldMirror.create(FieldMirror.MAP_MAIN_ACTIVITY);
+ *      mirror.refresh(activity);   //一次读取name、age、num
+ *      ... native代码任意修改镜像 ...
+ *      mirror.sync(activity);      //只写回变化了的字段
+ *
+ * 以前changeName、changeAge、changeNum每修改一个字段就是一次native调用
+ */
+public final class FieldMirror implements Closeable {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    //字段表，与native-mirror.cpp的MirrorMap一致
+    public static final int MAP_MAIN_ACTIVITY = 0; //name, static age, final num
+
+    private long handle;
+
+    private FieldMirror(long handle) {
+        this.handle = handle;
+    }
+
+    public static FieldMirror create(int map) {
+        long handle = nativeCreate(map);
+        if (handle == 0) {
+            throw new IllegalStateException("FieldMirror: 创建失败, map = " + map);
+        }
+        return new FieldMirror(handle);
+    }
+
+    private long handle() {
+        if (handle == 0) {
+            throw new IllegalStateException("FieldMirror: 已经close()");
+        }
+        return handle;
+    }
+
+    //一次读取所有字段，覆盖还没有sync()的修改。静态字段从类上读取，target只用于实例字段
+    public void refresh(Object target) {
+        nativeRefresh(handle(), target);
+    }
+
+    //只写回变化了的字段，返回写回的字段数
+    public int sync(Object target) {
+        return nativeSync(handle(), target);
+    }
+
+    //第i位为1表示字段表中第i个字段需要写回
+    public long dirtyMask() {
+        return nativeDirtyMask(handle());
+    }
+
+    //示例：native修改rounds轮(每轮相当于changeName + changeAge + changeNum)，只修改镜像
+    public void step(int rounds) {
+        nativeStep(handle(), rounds);
+    }
+
+    @Override
+    public void close() {
+        if (handle != 0) {
+            nativeDestroy(handle);
+            handle = 0;
+        }
+    }
+
+    private static native long nativeCreate(int map);
+    private static native void nativeDestroy(long handle);
+    private static native void nativeRefresh(long handle, Object target);
+    private static native int nativeSync(long handle, Object target);
+    private static native long nativeDirtyMask(long handle);
+    private static native void nativeStep(long handle, int rounds);
+}
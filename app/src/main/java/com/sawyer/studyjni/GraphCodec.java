@@ -0,0 +1,227 @@
+package com.sawyer.studyjni;
+
+import java.nio.BufferOverflowException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Person ---> Student 对象图的扁平二进制编码，格式见graph-codec.h
+ *
+ * native ---> Java：native把整个对象图写进DirectByteBuffer(一次JNI调用)，decode()一遍扫描直接写public字段，
+ *                  不调用setter，也没有任何逐字段的JNI调用
+ * Java ---> native：encode()写进DirectByteBuffer，native直接读这块内存
+ *
+ * 多个Person指向同一个Student时只编码一次，解码后仍然是同一个对象
+ */
+public final class GraphCodec {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    //与graph-codec.h一致
+    private static final int MAGIC = 0x47524A53;
+    private static final int VERSION = 1;
+    private static final int HEADER_BYTES = 16;
+    private static final int STUDENT_BYTES = 12;
+    private static final int PERSON_BYTES = 4;
+    private static final int NULL = -1;
+
+    private GraphCodec() {
+    }
+
+    /**
+     * 从buffer.position()开始解码一个对象图，成功后position移到对象图之后
+     * @throws IllegalArgumentException 数据不完整、magic/版本不对、记录越界
+     */
+    public static Person[] decode(ByteBuffer buffer) {
+        ByteBuffer in = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+        final int base = in.position();
+        final int length = in.remaining();
+        if (length < HEADER_BYTES) {
+            throw new IllegalArgumentException("GraphCodec: 数据不完整");
+        }
+        if (in.getInt(base) != MAGIC) {
+            throw new IllegalArgumentException("GraphCodec: magic不对，不是对象图");
+        }
+        if ((in.getShort(base + 4) & 0xFFFF) != VERSION) {
+            throw new IllegalArgumentException("GraphCodec: 不支持的版本 " + (in.getShort(base + 4) & 0xFFFF));
+        }
+        final int headerBytes = in.getShort(base + 6) & 0xFFFF;
+        final long studentCount = in.getInt(base + 8) & 0xFFFFFFFFL;
+        final long personCount = in.getInt(base + 12) & 0xFFFFFFFFL;
+        final long poolSizeAt = headerBytes + studentCount * STUDENT_BYTES + personCount * PERSON_BYTES;
+        if (headerBytes < HEADER_BYTES || poolSizeAt + 4 > length) {
+            throw new IllegalArgumentException("GraphCodec: 数据不完整");
+        }
+        final long poolBytes = in.getInt(base + (int) poolSizeAt) & 0xFFFFFFFFL;
+        if (poolSizeAt + 4 + poolBytes > length) {
+            throw new IllegalArgumentException("GraphCodec: 数据不完整");
+        }
+        final int pool = base + (int) poolSizeAt + 4;
+
+        Student[] students = new Student[(int) studentCount];
+        byte[] scratch = new byte[64];
+        int record = base + headerBytes;
+        for (int i = 0; i < students.length; i++, record += STUDENT_BYTES) {
+            Student student = new Student();
+            student.age = in.getInt(record);
+            int nameLength = in.getInt(record + 4);
+            if (nameLength != NULL) {
+                long nameOffset = in.getInt(record + 8) & 0xFFFFFFFFL;
+                if (nameLength < 0 || nameOffset + nameLength > poolBytes) {
+                    throw new IllegalArgumentException("GraphCodec: 记录越界");
+                }
+                if (scratch.length < nameLength) {
+                    scratch = new byte[Math.max(nameLength, scratch.length * 2)];
+                }
+                in.position(pool + (int) nameOffset);
+                in.get(scratch, 0, nameLength);
+                student.name = new String(scratch, 0, nameLength, StandardCharsets.UTF_8);
+            }
+            students[i] = student;
+        }
+        Person[] persons = new Person[(int) personCount];
+        for (int i = 0; i < persons.length; i++, record += PERSON_BYTES) {
+            int index = in.getInt(record);
+            if (index != NULL && (index < 0 || index >= students.length)) {
+                throw new IllegalArgumentException("GraphCodec: 记录越界");
+            }
+            Person person = new Person();
+            person.student = index == NULL ? null : students[index];
+            persons[i] = person;
+        }
+        buffer.position(pool + (int) poolBytes);
+        return persons;
+    }
+
+    //编码前收集的Student(去重)和它们名字的UTF-8
+    private static final class Plan {
+        final List<Student> students = new ArrayList<>();
+        final List<byte[]> names = new ArrayList<>();
+        final Map<Student, Integer> index = new IdentityHashMap<>();
+        final int[] persons;
+        long poolBytes;
+
+        Plan(Person[] people) {
+            persons = new int[people.length];
+            for (int i = 0; i < people.length; i++) {
+                Student student = people[i] == null ? null : people[i].student;
+                if (student == null) {
+                    persons[i] = NULL;
+                    continue;
+                }
+                Integer existing = index.get(student);
+                if (existing == null) {
+                    existing = students.size();
+                    index.put(student, existing);
+                    students.add(student);
+                    byte[] name = student.name == null ? null : student.name.getBytes(StandardCharsets.UTF_8);
+                    names.add(name);
+                    poolBytes += name == null ? 0 : name.length;
+                }
+                persons[i] = existing;
+            }
+        }
+
+        long size() {
+            return HEADER_BYTES + (long) students.size() * STUDENT_BYTES + (long) persons.length * PERSON_BYTES
+                    + 4 + poolBytes;
+        }
+    }
+
+    //编码后的字节数。null的Person与student为null的Person编码相同
+    public static int encodedSize(Person[] persons) {
+        return checkedSize(new Plan(persons));
+    }
+
+    private static int checkedSize(Plan plan) {
+        long size = plan.size();
+        if (size > Integer.MAX_VALUE) {
+            throw new IllegalArgumentException("GraphCodec: 对象图超过2GB");
+        }
+        return (int) size;
+    }
+
+    /**
+     * 从out.position()开始编码，成功后position移到对象图之后
+     * @return: 写入的字节数
+     * @throws BufferOverflowException 空间不足，此时不写入任何数据
+     */
+    public static int encode(Person[] persons, ByteBuffer out) {
+        Plan plan = new Plan(persons);
+        final int size = checkedSize(plan);
+        if (out.remaining() < size) {
+            throw new BufferOverflowException();
+        }
+        ByteBuffer dst = out.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+        dst.putInt(MAGIC)
+                .putShort((short) VERSION)
+                .putShort((short) HEADER_BYTES)
+                .putInt(plan.students.size())
+                .putInt(plan.persons.length);
+        int nameOffset = 0;
+        for (int i = 0; i < plan.students.size(); i++) {
+            byte[] name = plan.names.get(i);
+            dst.putInt(plan.students.get(i).age);
+            dst.putInt(name == null ? NULL : name.length);
+            dst.putInt(name == null ? 0 : nameOffset);
+            nameOffset += name == null ? 0 : name.length;
+        }
+        for (int student : plan.persons) {
+            dst.putInt(student);
+        }
+        dst.putInt(nameOffset);
+        for (byte[] name : plan.names) {
+            if (name != null) {
+                dst.put(name);
+            }
+        }
+        out.position(out.position() + size);
+        return size;
+    }
+
+    //编码到一个大小正好的DirectByteBuffer，position为0
+    public static ByteBuffer encode(Person[] persons) {
+        Plan plan = new Plan(persons);
+        ByteBuffer out = ByteBuffer.allocateDirect(checkedSize(plan));
+        encode(persons, out);
+        out.flip();
+        return out;
+    }
+
+    /**
+     * native编码与insertObject相同的对象图(每个Person一个Student)，一次JNI调用
+     * 返回的DirectByteBuffer可以直接decode()
+     */
+    public static ByteBuffer sample(int persons) {
+        int size = nativeSampleSize(persons);
+        if (size < 0) {
+            throw new IllegalArgumentException("GraphCodec: 对象图超过2GB");
+        }
+        ByteBuffer out = ByteBuffer.allocateDirect(size);
+        out.limit(nativeSample(persons, out, 0, out.remaining()));
+        return out;
+    }
+
+    //native读取对象图([position(), limit()))：[占用的字节数, Person个数, Student个数, student为null的Person个数, age之和]
+    public static long[] summary(ByteBuffer in) {
+        return nativeSummary(in, in.position(), in.remaining());
+    }
+
+    //native解码in再编码到out(都在[position(), limit())内)，返回写入的字节数；不移动position
+    public static int echo(ByteBuffer in, ByteBuffer out) {
+        return nativeEcho(in, in.position(), in.remaining(), out, out.position(), out.remaining());
+    }
+
+    private static native int nativeSampleSize(int persons);
+    private static native int nativeSample(int persons, ByteBuffer out, int offset, int remaining);
+    private static native long[] nativeSummary(ByteBuffer in, int offset, int remaining);
+    private static native int nativeEcho(ByteBuffer in, int inOffset, int inRemaining,
+                                         ByteBuffer out, int outOffset, int outRemaining);
+}
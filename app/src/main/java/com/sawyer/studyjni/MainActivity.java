@@ -14,10 +14,15 @@ import com.sawyer.studyjni.databinding.ActivityMainBinding;
 
 public class MainActivity extends AppCompatActivity {
 
+    //System.loadLibrary的耗时(包含JNI_OnLoad)，冷启动时在onCreate中输出
+    private static final long LOAD_LIBRARY_NS;
+
     //静态代码块在类创建的时候会执行一次
     static {
-        //此行代码执行时会调用 JNI_OnLoad(),可用于JNI动态注册时使用
+        long start = System.nanoTime();
+        //此行代码执行时会调用 JNI_OnLoad(),所有native函数都在其中动态注册，任何一个注册失败都会抛出UnsatisfiedLinkError
         System.loadLibrary("study_jni");
+        LOAD_LIBRARY_NS = System.nanoTime() - start;
     }
 
     private ActivityMainBinding binding;
@@ -40,7 +45,9 @@ public class MainActivity extends AppCompatActivity {
         binding = ActivityMainBinding.inflate(getLayoutInflater());
         setContentView(binding.getRoot());
         TextView tv = binding.sampleText;
+        long start = System.nanoTime();
         tv.setText(stringFromJNI());
+        logStartup(System.nanoTime() - start);
 
         Log.d("lee","修改前name = " + name);
         changeName();
@@ -56,6 +63,16 @@ public class MainActivity extends AppCompatActivity {
 
         callAddMethod();
 
+        //native线程的updateActivityUI事件合并后，每帧在主线程最多处理一次
+        NativeEventDispatcher.start(events -> {
+            for (int i = 0; i < NativeEventDispatcher.countOf(events); i++) {
+                if (NativeEventDispatcher.typeOf(events, i) == NativeEventDispatcher.TYPE_UPDATE_UI) {
+                    Log.d("lee", "updateActivityUI 合并后的序号 = " + NativeEventDispatcher.valueOf(events, i));
+                    updateActivityUI();
+                }
+            }
+        }, NativeEventDispatcher.EVERY_FRAME, 256, NativeEventDispatcher.DROP_OLDEST);
+
         binding.btn1.setOnClickListener(v -> {
             int[] intArray = {1,2,3,4,5,6};
             String[] strArray = {"李小龙","李连杰","李元霸"};
@@ -114,9 +131,36 @@ public class MainActivity extends AppCompatActivity {
         binding.btn10.setOnClickListener(v -> {
             startActivity(new Intent(this,SecondActivity.class));
         });
+        binding.btn11.setOnClickListener(v -> {
+            Student stu = new Student();
+            stu.age = 12;
+            long[] result = benchIdCache(stu, 100000);
+            long[] typed = benchTypedCall(stu, 100000);
+            Toast.makeText(this, "未缓存 = " + result[0] + "ns/次, 缓存 = " + result[1] + "ns/次\n"
+                            + "原始调用 = " + typed[0] + "ns/次, 类型化调用 = " + typed[1] + "ns/次",
+                    Toast.LENGTH_LONG).show();
+            NativeStats.dump("lee");
+        });
+        binding.btn12.setOnClickListener(v -> {
+            //任务在native线程池中执行，不阻塞UI线程；再点一次协作式取消
+            if (asyncCall != null && asyncCall.cancel()) {
+                return;
+            }
+            asyncCall = NativeAsync.submit(NativeAsync.KIND_SLEEP, 3000, call -> runOnUiThread(() -> {
+                String state = call.status() == NativeAsync.DONE ? "完成" : "已取消";
+                Toast.makeText(this, "异步任务" + state + "，睡眠了" + call.result() + "ms",
+                        Toast.LENGTH_SHORT).show();
+                if (asyncCall == call) {
+                    asyncCall = null;
+                }
+            }));
+        });
     }
 
-    public native String stringFromJNI(); // 默认的写法，属于静态注册
+    //btn12提交的异步任务，只在主线程访问
+    private NativeAsync.Call asyncCall;
+
+    public native String stringFromJNI(); // 默认的写法，以前属于静态注册，现在与其它native函数一样在JNI_OnLoad中动态注册
     public native void changeName();
     public static native void changeAge();
     public native void changeNum();
@@ -157,7 +201,7 @@ public class MainActivity extends AppCompatActivity {
 
     //JNI线程
     public native void nativeThread(); // Java层调用Native层的函数，完成JNI线程
-    public native void closeThread();  // 释放全局引用
+    public native void closeThread();  // 停止进程级的线程池：只用于整个App退出时，Activity销毁时不要调用
     //todo =============下面是 被native代码调用的 Java方法=========
     public void updateActivityUI() {
         if (Looper.getMainLooper() == Looper.myLooper()) { // todo 代表C++用主线程调用此函数
@@ -188,11 +232,37 @@ public class MainActivity extends AppCompatActivity {
     public static native void staticFun3();
     public static native void staticFun4();
 
+    //todo =================JNI ID缓存基准测试===================
+    //返回[未缓存的单次耗时ns, 缓存后的单次耗时ns]
+    public native long[] benchIdCache(Student student, int rounds);
+    //返回[原始int调用, 类型化int调用, 原始object调用, 类型化object调用]的单次耗时ns
+    public native long[] benchTypedCall(Student student, int rounds);
+
+    //todo =================冷启动耗时===================
+    //返回[JNI_OnLoad总耗时ns, ID缓存ns, 注册ns, 注册的函数个数]
+    public native long[] nativeStartupStats();
+
+    private void logStartup(long firstCallNs) {
+        long[] stats = nativeStartupStats();
+        Log.i("lee", "冷启动: loadLibrary = " + LOAD_LIBRARY_NS / 1000 + "us"
+                + ", JNI_OnLoad = " + stats[0] / 1000 + "us(ID缓存 = " + stats[1] / 1000
+                + "us, 注册" + stats[3] + "个native函数 = " + stats[2] / 1000 + "us)"
+                + ", 首次调用stringFromJNI = " + firstCallNs / 1000 + "us");
+    }
+
 
     @Override
     protected void onDestroy() {
         super.onDestroy();
+        //只释放本Activity提交的异步任务：正在执行的任务在安全点退出，之后不会再回调已销毁的Activity
+        //不能用NativeAsync.releaseAll()，旋转屏幕也会onDestroy，会取消其他组件的任务(e.g: MappedFile.prefetchAsync)
+        if (asyncCall != null) {
+            asyncCall.release();
+            asyncCall = null;
+        }
         deleteQuote();
-        closeThread();
+        //线程池是进程级的，不在这里停止(以前调用closeThread()，每次旋转屏幕都在UI线程等待线程池退出)，由JNI_OnUnload回收
+        //分发器停止后，工作线程的updateActivityUI退回到直接调用，Activity的弱引用已失效，什么都不做
+        NativeEventDispatcher.stop();
     }
 }
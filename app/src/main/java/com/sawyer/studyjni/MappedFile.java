@@ -0,0 +1,233 @@
+package com.sawyer.studyjni;
+
+import java.io.Closeable;
+import java.io.IOException;
+import java.lang.ref.PhantomReference;
+import java.lang.ref.ReferenceQueue;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.Collections;
+import java.util.HashSet;
+import java.util.Set;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * 文件的内存映射，视图是直接指向映射页的DirectByteBuffer，读写不经过Java堆，见mapped-file.h
+ *
+ * 用法：
+ *      MappedFile file = MappedFile.openReadOnly(path);
+ *      file.advise(0, file.size(), MappedFile.ADVICE_SEQUENTIAL);
+ *      MappedFile.View view = file.view(0, (int) file.size());
+ *      ... view.buffer().getInt(i) ...
+ *      view.close();
+ *      file.close();
+ *
+ * 生命周期：映射和每个视图各持有一个native引用，全部释放后才munmap。
+ *      1.视图的native引用只在它的ByteBuffer不可达(被GC回收)之后，由后台线程释放：
+ *        已经拿到的buffer()、以及它的slice()、duplicate()还在使用时，映射一定不会被munmap
+ *      2.视图close()只是放开对buffer的强引用，之后buffer()抛出IllegalStateException
+ *      3.file.close()之后，还有视图的buffer可达时映射仍然有效
+ */
+public final class MappedFile implements Closeable {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    //madvise的提示，与mapped-file.h的MapAdvice一致
+    public static final int ADVICE_NORMAL = 0;
+    public static final int ADVICE_SEQUENTIAL = 1;
+    public static final int ADVICE_RANDOM = 2;
+    public static final int ADVICE_WILLNEED = 3;
+    public static final int ADVICE_DONTNEED = 4;
+
+    //视图的buffer被回收时放入sReleased，由sReleaser线程释放native引用
+    private static final ReferenceQueue<ByteBuffer> sReleased = new ReferenceQueue<>();
+    //还没回收的ViewRef：PhantomReference本身必须可达，否则不会被放入队列
+    private static final Set<ViewRef> sViewRefs = Collections.synchronizedSet(new HashSet<ViewRef>());
+    private static Thread sReleaser;
+
+    /**
+     * 一个视图的native引用。跟踪nativeView()返回的原始buffer，只读映射还跟踪asReadOnlyBuffer()的包装：
+     * slice()、duplicate()持有的是原始buffer(不同的虚拟机实现不同)，所以两者都不可达后才释放
+     */
+    private static final class ViewRelease {
+        private final long handle;
+        private final AtomicInteger pending;
+
+        ViewRelease(long handle, int buffers) {
+            this.handle = handle;
+            pending = new AtomicInteger(buffers);
+        }
+
+        void onUnreachable() {
+            if (pending.decrementAndGet() == 0) {
+                nativeReleaseView(handle);
+            }
+        }
+    }
+
+    private static final class ViewRef extends PhantomReference<ByteBuffer> {
+        private final ViewRelease release;
+
+        ViewRef(ByteBuffer buffer, ViewRelease release) {
+            super(buffer, sReleased);
+            this.release = release;
+            sViewRefs.add(this);
+        }
+    }
+
+    private static synchronized void startReleaser() {
+        if (sReleaser != null) {
+            return;
+        }
+        sReleaser = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                while (true) {
+                    try {
+                        ViewRef ref = (ViewRef) sReleased.remove();
+                        sViewRefs.remove(ref);
+                        ref.release.onUnreachable();
+                    } catch (InterruptedException ignored) {
+                    }
+                }
+            }
+        }, "MappedFile-releaser");
+        sReleaser.setDaemon(true);
+        sReleaser.start();
+    }
+
+    //映射的一段，持有一个native引用(buffer不可达后释放)
+    public static final class View implements Closeable {
+        private ByteBuffer buffer;
+
+        private View(ByteBuffer buffer) {
+            this.buffer = buffer;
+        }
+
+        //只读映射返回只读的buffer，字节序为本机字节序。close()之后抛出IllegalStateException
+        public synchronized ByteBuffer buffer() {
+            if (buffer == null) {
+                throw new IllegalStateException("MappedFile.View: 已经close()");
+            }
+            return buffer;
+        }
+
+        //只放开对buffer的强引用：已经拿到的buffer还可以安全使用，全部不可达后才释放native引用
+        @Override
+        public synchronized void close() {
+            buffer = null;
+        }
+    }
+
+    private long handle;
+    private final long size;
+    private final boolean writable;
+
+    private MappedFile(long handle) {
+        this.handle = handle;
+        size = nativeSize(handle);
+        writable = nativeWritable(handle);
+    }
+
+    //只读映射整个文件，空文件不能映射
+    public static MappedFile openReadOnly(String path) throws IOException {
+        return open(path, false, 0, 0);
+    }
+
+    /**
+     * @writable: true时以读写方式打开(不存在则创建)，文件不够offset + length时扩展文件
+     * @length: 0表示从offset到文件末尾
+     */
+    public static MappedFile open(String path, boolean writable, long offset, long length) throws IOException {
+        return new MappedFile(nativeOpen(path, writable, offset, length));
+    }
+
+    public long size() {
+        return size;
+    }
+
+    public boolean isWritable() {
+        return writable;
+    }
+
+    private long handle() {
+        if (handle == 0) {
+            throw new IllegalStateException("MappedFile: 已经close()");
+        }
+        return handle;
+    }
+
+    //[offset, offset + length)的零拷贝视图，用完要close()；native引用在buffer被回收后释放
+    public synchronized View view(long offset, int length) {
+        long h = handle();
+        startReleaser();
+        ByteBuffer raw = nativeView(h, offset, length);
+        if (writable) {
+            //order()返回的是同一个对象
+            new ViewRef(raw, new ViewRelease(h, 1));
+            return new View(raw.order(ByteOrder.nativeOrder()));
+        }
+        ByteBuffer readOnly = raw.asReadOnlyBuffer().order(ByteOrder.nativeOrder());
+        ViewRelease release = new ViewRelease(h, 2);
+        new ViewRef(raw, release);
+        new ViewRef(readOnly, release);
+        return new View(readOnly);
+    }
+
+    public synchronized void advise(long offset, long length, int advice) throws IOException {
+        nativeAdvise(handle(), offset, length, advice);
+    }
+
+    //在当前线程中逐页读一个字节，返回读过的页数
+    public synchronized long prefetch(long offset, long length) {
+        return nativePrefetch(handle(), offset, length);
+    }
+
+    /**
+     * 在native线程池中预读，完成时Call.result()为读过的页数，可以cancel()
+     * 任务持有一个native引用，close()之后也可以安全地执行完
+     */
+    public synchronized NativeAsync.Call prefetchAsync(final long offset, final long length,
+                                                       NativeAsync.Callback callback) {
+        final long h = handle();
+        return NativeAsync.submit(new NativeAsync.Submitter() {
+            @Override
+            public long submit() {
+                return nativePrefetchAsync(h, offset, length);
+            }
+        }, callback);
+    }
+
+    //msync：async为true时只安排写回，不等待。只读映射什么都不做
+    public synchronized void sync(long offset, long length, boolean async) throws IOException {
+        nativeSync(handle(), offset, length, async);
+    }
+
+    //当前的native引用数：1(映射本身) + buffer还没被回收的视图 + 正在执行的异步预读
+    public synchronized int refs() {
+        return nativeRefs(handle());
+    }
+
+    //释放映射本身的引用，所有视图释放后才真正munmap
+    @Override
+    public synchronized void close() {
+        if (handle != 0) {
+            nativeUnmap(handle);
+            handle = 0;
+        }
+    }
+
+    private static native long nativeOpen(String path, boolean writable, long offset, long length) throws IOException;
+    private static native long nativeSize(long handle);
+    private static native boolean nativeWritable(long handle);
+    private static native ByteBuffer nativeView(long handle, long offset, int length);
+    private static native void nativeReleaseView(long handle);
+    private static native int nativeRefs(long handle);
+    private static native void nativeUnmap(long handle);
+    private static native void nativeAdvise(long handle, long offset, long length, int advice) throws IOException;
+    private static native long nativePrefetch(long handle, long offset, long length);
+    private static native long nativePrefetchAsync(long handle, long offset, long length);
+    private static native void nativeSync(long handle, long offset, long length, boolean async) throws IOException;
+}
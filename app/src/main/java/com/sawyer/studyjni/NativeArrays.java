@@ -0,0 +1,55 @@
+package com.sawyer.studyjni;
+
+/**
+ * 基本类型数组的批量native运算
+ *
+ * 每个函数只调用一次JNI：native层一次性拿到整个数组，
+ * 小数组用Get<Type>ArrayRegion拷贝，大数组用GetPrimitiveArrayCritical直接访问，
+ * 在C++中用向量化的内核完成运算。适合10^5 ~ 10^7个元素的大数组
+ *
+ * 整数运算的溢出行为与Java一致(回绕)
+ */
+public final class NativeArrays {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    private NativeArrays() {
+    }
+
+    //求和，整数用long返回，浮点用double累加
+    public static native long sum(byte[] array);
+    public static native long sum(int[] array);
+    public static native long sum(long[] array);
+    public static native double sum(float[] array);
+    public static native double sum(double[] array);
+
+    //返回[min, max]，空数组返回null
+    public static native byte[] minMax(byte[] array);
+    public static native int[] minMax(int[] array);
+    public static native long[] minMax(long[] array);
+    public static native float[] minMax(float[] array);
+    public static native double[] minMax(double[] array);
+
+    //原地缩放：array[i] *= factor
+    public static native void scale(byte[] array, byte factor);
+    public static native void scale(int[] array, int factor);
+    public static native void scale(long[] array, long factor);
+    public static native void scale(float[] array, float factor);
+    public static native void scale(double[] array, double factor);
+
+    //原地前缀和：array[i] = array[0] + ... + array[i]
+    public static native void prefixSum(byte[] array);
+    public static native void prefixSum(int[] array);
+    public static native void prefixSum(long[] array);
+    public static native void prefixSum(float[] array);
+    public static native void prefixSum(double[] array);
+
+    //点积，两个数组长度必须一致，否则抛IllegalArgumentException
+    public static native long dot(byte[] a, byte[] b);
+    public static native long dot(int[] a, int[] b);
+    public static native long dot(long[] a, long[] b);
+    public static native double dot(float[] a, float[] b);
+    public static native double dot(double[] a, double[] b);
+}
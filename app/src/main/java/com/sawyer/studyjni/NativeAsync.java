@@ -0,0 +1,143 @@
+package com.sawyer.studyjni;
+
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * 异步native调用，见async-calls.h
+ *
+ * submit()立即返回Call，任务在native的常驻线程池中执行(不为每个请求创建线程)；
+ * 完成的任务合并成一批，native只调用一次onCompleted(long[])，再逐个回调Callback
+ *
+ * 注意：Callback在native的工作线程中回调，要更新UI需要自己runOnUiThread
+ */
+public final class NativeAsync {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    //任务类型，与async-calls.h的AsyncKind一致
+    public static final int KIND_SUM = 0;   //0 + 1 + ... + (arg - 1)
+    public static final int KIND_SLEEP = 1; //睡眠arg毫秒，结果为实际睡眠的毫秒数
+
+    //状态，与async-calls.h的AsyncStatus一致
+    public static final int PENDING = 0;
+    public static final int DONE = 1;
+    public static final int CANCELLED = 2;
+    public static final int FAILED = 3;
+
+    public interface Callback {
+        void onComplete(Call call);
+    }
+
+    public static final class Call {
+        public final long handle;
+        private final Callback callback;
+        private volatile int status = PENDING;
+        private volatile long result;
+
+        private Call(long handle, Callback callback) {
+            this.handle = handle;
+            this.callback = callback;
+        }
+
+        public int status() {
+            return status;
+        }
+
+        //status() == DONE时有效
+        public long result() {
+            return result;
+        }
+
+        public boolean isDone() {
+            return status >= DONE;
+        }
+
+        //协作式取消：还没开始的任务不再执行，正在执行的任务在下一个安全点返回，仍然会回调(CANCELLED)
+        public boolean cancel() {
+            return !isDone() && nativeCancel(handle);
+        }
+
+        //取消并释放句柄，之后不会再回调
+        public void release() {
+            synchronized (CALLS) {
+                CALLS.remove(handle);
+            }
+            nativeRelease(handle);
+        }
+    }
+
+    //还没完成的任务。native完成通知可能比submit()返回得更早，所以提交、查找都在锁内
+    private static final Map<Long, Call> CALLS = new HashMap<>();
+
+    private NativeAsync() {
+    }
+
+    /**
+     * @return: 线程池不可用、或者队列已满时返回null
+     */
+    public static Call submit(final int kind, final long arg, Callback callback) {
+        return submit(new Submitter() {
+            @Override
+            public long submit() {
+                return nativeSubmit(kind, arg);
+            }
+        }, callback);
+    }
+
+    //其它类的native函数提交的异步任务(e.g: MappedFile.prefetchAsync)，返回AsyncCalls的句柄，失败返回0
+    interface Submitter {
+        long submit();
+    }
+
+    static Call submit(Submitter submitter, Callback callback) {
+        synchronized (CALLS) {
+            long handle = submitter.submit();
+            if (handle == 0) {
+                return null;
+            }
+            Call call = new Call(handle, callback);
+            CALLS.put(handle, call);
+            return call;
+        }
+    }
+
+    //释放所有句柄(e.g: Activity.onDestroy)，之后不会再有回调。返回native释放的个数
+    public static int releaseAll() {
+        synchronized (CALLS) {
+            CALLS.clear();
+        }
+        return nativeReleaseAll();
+    }
+
+    //[submitted, completed, cancelled, batches]
+    public static long[] stats() {
+        return nativeStats();
+    }
+
+    //native代码通过JNI调用，方法名、签名不能修改。batch每三个long为(handle, status, result)
+    private static void onCompleted(long[] batch) {
+        for (int i = 0; i + 2 < batch.length; i += 3) {
+            Call call;
+            synchronized (CALLS) {
+                call = CALLS.remove(batch[i]);
+            }
+            if (call == null) {
+                continue; //已经release()
+            }
+            call.result = batch[i + 2];
+            call.status = (int) batch[i + 1];
+            if (call.callback != null) {
+                call.callback.onComplete(call);
+            }
+        }
+    }
+
+    private static native long nativeSubmit(int kind, long arg);
+    private static native boolean nativeCancel(long handle);
+    private static native void nativeRelease(long handle);
+    private static native int nativeReleaseAll();
+    private static native long[] nativeStats();
+}
@@ -0,0 +1,110 @@
+package com.sawyer.studyjni;
+
+import android.view.Choreographer;
+
+/**
+ * native ---> Java 的事件分发器，见callback-dispatcher.h
+ *
+ * native线程只往无锁队列里放事件，(type, key)相同的事件会被合并(只保留最新的value)，
+ * 合并后的一批事件用一个long[]一次性交给Listener，而不是每个事件一次JNI调用 + runOnUiThread
+ *
+ * 事件格式：每个事件占两个long，用typeOf()/keyOf()/valueOf()读取
+ */
+public final class NativeEventDispatcher {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    //事件类型，与callback-dispatcher.h一致
+    public static final int TYPE_UPDATE_UI = 1;
+
+    //队列满时的策略
+    public static final int DROP_NEWEST = 0;
+    public static final int DROP_OLDEST = 1;
+    public static final int BLOCK = 2;
+
+    //帧模式：每一帧在主线程拉取一次
+    public static final int EVERY_FRAME = 0;
+
+    public interface Listener {
+        //native代码通过JNI调用，方法名、签名不能修改
+        void onEvents(long[] events);
+    }
+
+    private static Choreographer.FrameCallback frameCallback;
+
+    private NativeEventDispatcher() {
+    }
+
+    /**
+     * @intervalMs: EVERY_FRAME表示帧模式，必须在主线程调用，listener在主线程每帧回调；
+     *              大于0表示间隔模式，listener在native的分发线程中回调
+     * @capacity: 队列容量
+     * @policy: DROP_NEWEST、DROP_OLDEST、BLOCK
+     */
+    public static boolean start(Listener listener, int intervalMs, int capacity, int policy) {
+        if (intervalMs != EVERY_FRAME) {
+            return nativeStart(listener, intervalMs, capacity, policy);
+        }
+        if (!nativeStart(null, EVERY_FRAME, capacity, policy)) {
+            return false;
+        }
+        frameCallback = new Choreographer.FrameCallback() {
+            @Override
+            public void doFrame(long frameTimeNanos) {
+                if (frameCallback != this) {
+                    return; //已经stop()
+                }
+                long[] events = nativePoll();
+                if (events != null) {
+                    listener.onEvents(events);
+                }
+                Choreographer.getInstance().postFrameCallback(this);
+            }
+        };
+        Choreographer.getInstance().postFrameCallback(frameCallback);
+        return true;
+    }
+
+    //帧模式下必须在主线程调用
+    public static void stop() {
+        if (frameCallback != null) {
+            Choreographer.getInstance().removeFrameCallback(frameCallback);
+            frameCallback = null;
+        }
+        nativeStop();
+    }
+
+    //Java线程也可以投递事件，未启动或者被丢弃时返回false
+    public static boolean post(int type, int key, long value) {
+        return nativePost(type, key, value);
+    }
+
+    //[enqueued, coalesced, dropped, batches, delivered]
+    public static long[] stats() {
+        return nativeStats();
+    }
+
+    public static int countOf(long[] events) {
+        return events.length / 2;
+    }
+
+    public static int typeOf(long[] events, int index) {
+        return (int) (events[index * 2] >> 32);
+    }
+
+    public static int keyOf(long[] events, int index) {
+        return (int) events[index * 2];
+    }
+
+    public static long valueOf(long[] events, int index) {
+        return events[index * 2 + 1];
+    }
+
+    private static native boolean nativeStart(Listener listener, int intervalMs, int capacity, int policy);
+    private static native void nativeStop();
+    private static native boolean nativePost(int type, int key, long value);
+    private static native long[] nativePoll();
+    private static native long[] nativeStats();
+}
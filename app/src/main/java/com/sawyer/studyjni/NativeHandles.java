@@ -0,0 +1,63 @@
+package com.sawyer.studyjni;
+
+/**
+ * native句柄表，见handle-table.h
+ *
+ * Java对象以强/弱全局引用保存在native，Java只拿到一个long句柄：
+ *      long h = NativeHandles.put(obj, NativeHandles.WEAK);
+ *      Object o = NativeHandles.get(h);   //弱引用的对象被回收后为null
+ *      NativeHandles.remove(h);           //之后get(h)返回null，不会崩溃
+ *
+ * 句柄带有generation，remove()之后槽位被复用，旧句柄也不会取到新对象
+ */
+public final class NativeHandles {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    //与handle-table.h的HandleKind一致
+    public static final int STRONG = 0;
+    public static final int WEAK = 1;
+
+    //stats()的下标，与native-handles.cpp一致
+    public static final int STAT_LIVE_STRONG = 0;
+    public static final int STAT_LIVE_WEAK = 1;
+    public static final int STAT_SLOTS = 2;         //已分配的槽位数(最大同时存在的句柄数)
+    public static final int STAT_CREATED = 3;
+    public static final int STAT_REMOVED = 4;
+    public static final int STAT_STALE_LOOKUPS = 5; //用已经释放的句柄查找的次数
+    public static final int STAT_CLEARED_WEAK = 6;  //查找时弱引用的对象已被回收的次数
+
+    private NativeHandles() {
+    }
+
+    //表满时返回0
+    public static long put(Object obj, int kind) {
+        return nativePut(obj, kind);
+    }
+
+    public static Object get(long handle) {
+        return nativeGet(handle);
+    }
+
+    //返回false表示句柄已经无效(重复释放)
+    public static boolean remove(long handle) {
+        return nativeRemove(handle);
+    }
+
+    //句柄是否有效(不检查弱引用的对象是否已被回收)
+    public static boolean isValid(long handle) {
+        return nativeValid(handle);
+    }
+
+    public static long[] stats() {
+        return nativeStats();
+    }
+
+    private static native long nativePut(Object obj, int kind);
+    private static native Object nativeGet(long handle);
+    private static native boolean nativeRemove(long handle);
+    private static native boolean nativeValid(long handle);
+    private static native long[] nativeStats();
+}
@@ -0,0 +1,125 @@
+package com.sawyer.studyjni;
+
+import android.util.Log;
+
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * 每个JNI入口的耗时统计，见jni-stats.h
+ *
+ * nativeSnapshot()的格式：[版本, 入口个数, 每个入口的字段数, 入口0的字段..., 入口1的字段...]
+ * 字段顺序与jni-stats.h的StatsField一致；编译时关闭STUDYJNI_JNI_STATS则返回null
+ */
+public final class NativeStats {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    private static final int VERSION = 1;
+
+    //字段下标，与jni-stats.h的StatsField一致
+    private static final int COUNT = 0;
+    private static final int TOTAL_NS = 1;
+    private static final int P50_NS = 2;
+    private static final int P99_NS = 3;
+    private static final int MAX_NS = 4;
+    private static final int UPCALLS = 5;
+    private static final int UPCALL_NS = 6;
+    private static final int BYTES = 7;
+    private static final int LOCAL_REFS = 8;
+
+    //nativeArenaStats()的下标，与native-stats.cpp、call-arena.h的ArenaStats一致
+    public static final int ARENA_SCOPES = 0;
+    public static final int ARENA_HIGH_WATER = 1;
+    public static final int ARENA_FALLBACKS = 2;
+    public static final int ARENA_FALLBACK_BYTES = 3;
+    public static final int ARENA_THREADS = 4;
+    public static final int ARENA_POOL_MISSES = 5;
+
+    private NativeStats() {
+    }
+
+    public static final class Entry {
+        public final String name; //e.g: "MainActivity.stringFromJNI()Ljava/lang/String;"
+        public final long count;
+        public final long totalNs;
+        public final long p50Ns;  //直方图的桶上界，相对误差不超过25%
+        public final long p99Ns;
+        public final long maxNs;
+        public final long upcalls;
+        public final long upcallNs;
+        public final long bytes;
+        public final long localRefs;
+
+        Entry(String name, long[] data, int offset) {
+            this.name = name;
+            this.count = data[offset + COUNT];
+            this.totalNs = data[offset + TOTAL_NS];
+            this.p50Ns = data[offset + P50_NS];
+            this.p99Ns = data[offset + P99_NS];
+            this.maxNs = data[offset + MAX_NS];
+            this.upcalls = data[offset + UPCALLS];
+            this.upcallNs = data[offset + UPCALL_NS];
+            this.bytes = data[offset + BYTES];
+            this.localRefs = data[offset + LOCAL_REFS];
+        }
+
+        @Override
+        public String toString() {
+            return name + ": count = " + count
+                    + ", p50 = " + p50Ns + "ns, p99 = " + p99Ns + "ns, max = " + maxNs + "ns"
+                    + ", upcalls = " + upcalls + "(" + upcallNs + "ns)"
+                    + ", bytes = " + bytes + ", localRefs = " + localRefs;
+        }
+    }
+
+    public static boolean isEnabled() {
+        return nativeEnabled();
+    }
+
+    //所有入口(包括没有被调用过的)，关闭统计时返回空列表
+    public static List<Entry> snapshot() {
+        List<Entry> entries = new ArrayList<>();
+        long[] data = nativeSnapshot();
+        String[] names = nativeNames();
+        if (data == null || names == null || data[0] != VERSION) {
+            return entries;
+        }
+        int count = (int) data[1];
+        int fields = (int) data[2];
+        for (int i = 0; i < count && i < names.length; i++) {
+            entries.add(new Entry(names[i], data, 3 + i * fields));
+        }
+        return entries;
+    }
+
+    /**
+     * 每次调用的临时内存(call-arena.h)的计数，下标见ARENA_*；不受STUDYJNI_JNI_STATS影响
+     * fallbacks一直增长说明kArenaBlockBytes太小
+     */
+    public static long[] arenaStats() {
+        return nativeArenaStats();
+    }
+
+    //输出被调用过的入口
+    public static void dump(String tag) {
+        for (Entry entry : snapshot()) {
+            if (entry.count > 0 || entry.upcalls > 0) {
+                Log.i(tag, entry.toString());
+            }
+        }
+        long[] arena = arenaStats();
+        Log.i(tag, "arena: scopes = " + arena[ARENA_SCOPES]
+                + ", highWater = " + arena[ARENA_HIGH_WATER] + "B"
+                + ", fallbacks = " + arena[ARENA_FALLBACKS] + "(" + arena[ARENA_FALLBACK_BYTES] + "B)"
+                + ", threads = " + arena[ARENA_THREADS]
+                + ", poolMisses = " + arena[ARENA_POOL_MISSES]);
+    }
+
+    private static native long[] nativeSnapshot();
+    private static native String[] nativeNames();
+    private static native boolean nativeEnabled();
+    private static native long[] nativeArenaStats();
+}
@@ -0,0 +1,24 @@
+package com.sawyer.studyjni;
+
+/**
+ * String[] 与连续UTF-8字节之间的批量转换，一次JNI调用处理整个数组
+ *
+ * pack()的结果格式(本机字节序)：
+ *      [int count][int length_0 ... length_count-1][UTF-8 bytes ...]
+ *      length == -1 表示该元素为null
+ */
+public final class NativeStrings {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    private NativeStrings() {
+    }
+
+    //String[] -> 打包后的UTF-8
+    public static native byte[] pack(String[] array);
+
+    //打包后的UTF-8 -> String[]，格式错误抛IllegalArgumentException
+    public static native String[] unpack(byte[] packed);
+}
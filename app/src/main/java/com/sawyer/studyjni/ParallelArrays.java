@@ -0,0 +1,53 @@
+package com.sawyer.studyjni;
+
+/**
+ * 大数组的多核运算，见parallel-arrays.h
+ *
+ * 数组按chunk(64KB，缓存行对齐)拆开，在native的work-stealing线程池上并行处理，调用者线程也参与；
+ * 小于128KB的数组不拆分，直接在调用者线程中串行执行
+ *
+ * 结果与threads == 1时完全一致(浮点求和的加法顺序不随线程数变化)
+ * 整数运算的溢出行为与Java一致(回绕)
+ *
+ * @threads: 最多使用的线程数(包括调用者)，0表示所有核
+ */
+public final class ParallelArrays {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    //map的运算，与parallel-arrays.h的MapOp一致
+    public static final int MAP_ADD = 0; //array[i] += operand
+    public static final int MAP_MUL = 1; //array[i] *= operand
+
+    //reduce的运算，与parallel-arrays.h的ReduceOp一致
+    public static final int REDUCE_SUM = 0;
+    public static final int REDUCE_MIN = 1; //空数组抛IllegalArgumentException
+    public static final int REDUCE_MAX = 2; //空数组抛IllegalArgumentException
+
+    private ParallelArrays() {
+    }
+
+    //原地：array[i] = array[i] op operand
+    public static native void map(int[] array, int op, int operand, int threads);
+    public static native void map(long[] array, int op, long operand, int threads);
+    public static native void map(float[] array, int op, float operand, int threads);
+    public static native void map(double[] array, int op, double operand, int threads);
+
+    //整数用long返回，浮点用double累加
+    public static native long reduce(int[] array, int op, int threads);
+    public static native long reduce(long[] array, int op, int threads);
+    public static native double reduce(float[] array, int op, int threads);
+    public static native double reduce(double[] array, int op, int threads);
+
+    //[min, max]等分成bins个桶，返回每个桶的个数，超出范围的值不计数
+    public static native long[] histogram(int[] array, int min, int max, int bins, int threads);
+
+    //原地升序排序
+    public static native void sort(int[] array, int threads);
+    public static native void sort(long[] array, int threads);
+
+    //CPU核数(线程池最多使用的线程数)
+    public static native int concurrency();
+}
@@ -0,0 +1,174 @@
+package com.sawyer.studyjni;
+
+import java.io.Closeable;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Java与native共享的单生产者/单消费者环形缓冲区，内存由native分配，通过DirectByteBuffer零拷贝访问
+ *
+ * 记录格式与ring-buffer.h一致：[int 长度][payload][补齐到8字节]，长度为-1表示跳回开头
+ *
+ * 用法：
+ *      Java -> native：Java端offer()若干条记录，最后flush()一次，native端drain
+ *      native -> Java：native端write + commit，Java端poll()
+ *      一个SharedRing只能有一个生产者和一个消费者；双向通信请使用两个SharedRing
+ *
+ * 只有flush()/poll()会调用JNI(门铃)，单条记录的读写都不会跨越JNI边界
+ */
+public final class SharedRing implements Closeable {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    private static final int WRAP_MARKER = -1;
+    private static final int HEADER_BYTES = 4;
+    private static final int ALIGN = 8;
+
+    //poll()的回调，返回false表示停止读取，该条记录不会被消费
+    public interface RecordHandler {
+        boolean onRecord(ByteBuffer buffer, int offset, int length);
+    }
+
+    private long handle;
+    //close()之后为null，不能再访问已经释放的native内存
+    private ByteBuffer buffer;
+    private ByteBuffer writeView;
+    private final int capacity;
+    private final int mask;
+
+    //Java作为生产者时使用
+    private long writePos;
+    private long cachedReadPos;
+    //Java作为消费者时使用
+    private long readPos;
+
+    //capacity会向上取整为2的幂，capacity <= 0时抛出IllegalArgumentException
+    public SharedRing(int capacity) {
+        if (capacity <= 0) {
+            throw new IllegalArgumentException("SharedRing: capacity = " + capacity);
+        }
+        handle = nativeCreate(capacity);
+        if (handle == 0) {
+            throw new OutOfMemoryError("SharedRing: native分配失败, capacity = " + capacity);
+        }
+        buffer = nativeBuffer(handle).order(ByteOrder.nativeOrder());
+        writeView = buffer.duplicate();
+        this.capacity = buffer.capacity();
+        mask = this.capacity - 1;
+    }
+
+    public int capacity() {
+        return capacity;
+    }
+
+    private long handle() {
+        if (handle == 0) {
+            throw new IllegalStateException("SharedRing: 已经close()");
+        }
+        return handle;
+    }
+
+    private static int recordSize(int length) {
+        return (HEADER_BYTES + length + ALIGN - 1) & ~(ALIGN - 1);
+    }
+
+    /**
+     * 写入一条记录，空间不足返回false。写入的记录要在flush()之后才对native可见
+     */
+    public boolean offer(byte[] src, int off, int len) {
+        handle();
+        if (len < 0 || len > capacity - HEADER_BYTES) {
+            throw new IllegalArgumentException("SharedRing: 记录长度非法 len = " + len);
+        }
+        int size = recordSize(len);
+        int offset = (int) (writePos & mask);
+        int contiguous = capacity - offset;
+        if (contiguous < size) {
+            if (!hasSpace(contiguous)) {
+                return false;
+            }
+            buffer.putInt(offset, WRAP_MARKER);
+            writePos += contiguous;
+            offset = 0;
+        }
+        if (!hasSpace(size)) {
+            return false;
+        }
+        buffer.putInt(offset, len);
+        writeView.position(offset + HEADER_BYTES);
+        writeView.put(src, off, len);
+        writePos += size;
+        return true;
+    }
+
+    public boolean offer(byte[] src) {
+        return offer(src, 0, src.length);
+    }
+
+    //先用上一次看到的读位置判断，不够时才通过门铃向native获取最新的读位置
+    private boolean hasSpace(int size) {
+        if (capacity - (writePos - cachedReadPos) >= size) {
+            return true;
+        }
+        flush();
+        return capacity - (writePos - cachedReadPos) >= size;
+    }
+
+    //门铃：发布所有已offer()的记录
+    public void flush() {
+        cachedReadPos = nativePublish(handle(), writePos);
+    }
+
+    /**
+     * 读取最多maxRecords条native已发布的记录
+     * @return 实际读取的记录数
+     */
+    public int poll(RecordHandler handler, int maxRecords) {
+        long head = nativeAcquire(handle());
+        long start = readPos;
+        int count = 0;
+        while (readPos != head && count < maxRecords) {
+            int offset = (int) (readPos & mask);
+            int len = buffer.getInt(offset);
+            if (len == WRAP_MARKER) {
+                readPos += capacity - offset;
+                continue;
+            }
+            if (!handler.onRecord(buffer, offset + HEADER_BYTES, len)) {
+                break;
+            }
+            readPos += recordSize(len);
+            count++;
+        }
+        if (readPos != start) {
+            nativeRelease(handle(), readPos);
+        }
+        return count;
+    }
+
+    //native把from中的记录全部转发到to，返回转发的记录数
+    public static int echo(SharedRing from, SharedRing to) {
+        return nativeEcho(from.handle(), to.handle());
+    }
+
+    //释放native内存，之后调用任何方法都会抛出IllegalStateException
+    @Override
+    public void close() {
+        if (handle != 0) {
+            buffer = null;
+            writeView = null;
+            nativeDestroy(handle);
+            handle = 0;
+        }
+    }
+
+    private static native long nativeCreate(int capacity);
+    private static native ByteBuffer nativeBuffer(long handle);
+    private static native void nativeDestroy(long handle);
+    private static native long nativePublish(long handle, long writePos);
+    private static native long nativeAcquire(long handle);
+    private static native void nativeRelease(long handle, long readPos);
+    private static native int nativeEcho(long fromHandle, long toHandle);
+}
@@ -0,0 +1,94 @@
+package com.sawyer.studyjni;
+
+import java.io.Closeable;
+
+/**
+ * Student[] 的native列式存储
+ *
+ * load()一次性把所有Student的age、name字段读入native(直接读public字段，不调用getter)，
+ * 之后的过滤、排序、聚合都在native完成，返回的是行号(即load()时数组的下标)。
+ * addAge()/setName()只修改native的列，writeBack()时一次性写回到Java对象(只写修改过的行)
+ */
+public final class StudentStore implements Closeable {
+
+    static {
+        System.loadLibrary("study_jni");
+    }
+
+    private long handle;
+
+    public StudentStore() {
+        handle = nativeCreate();
+    }
+
+    private long handle() {
+        if (handle == 0) {
+            throw new IllegalStateException("StudentStore: 已经close()");
+        }
+        return handle;
+    }
+
+    public void load(Student[] students) {
+        nativeLoad(handle(), students);
+    }
+
+    public int size() {
+        return nativeSize(handle());
+    }
+
+    //age在[minAge, maxAge]内的行号
+    public int[] filterByAge(int minAge, int maxAge) {
+        return nativeFilterByAge(handle(), minAge, maxAge);
+    }
+
+    public int[] sortByAge(boolean ascending) {
+        return nativeSortByAge(handle(), ascending);
+    }
+
+    //按名字的UTF-8字节序排序，null排在最前面
+    public int[] sortByName() {
+        return nativeSortByName(handle());
+    }
+
+    /**
+     * @rows: 要统计的行号，null表示所有行；行号越界时抛出IndexOutOfBoundsException
+     * @return [count, sum, min, max]
+     */
+    public long[] ageStats(int[] rows) {
+        return nativeAgeStats(handle(), rows);
+    }
+
+    public void addAge(int[] rows, int delta) {
+        nativeAddAge(handle(), rows, delta);
+    }
+
+    public void setName(int[] rows, String name) {
+        nativeSetName(handle(), rows, name);
+    }
+
+    //把修改过的行写回students(必须是load()时的同一个数组)，返回写回的行数
+    public int writeBack(Student[] students) {
+        return nativeWriteBack(handle(), students);
+    }
+
+    //释放native内存，之后调用任何方法都会抛出IllegalStateException
+    @Override
+    public void close() {
+        if (handle != 0) {
+            nativeDestroy(handle);
+            handle = 0;
+        }
+    }
+
+    private static native long nativeCreate();
+    private static native void nativeDestroy(long handle);
+    private static native void nativeLoad(long handle, Student[] students);
+    private static native int nativeSize(long handle);
+    private static native int[] nativeFilterByAge(long handle, int minAge, int maxAge);
+    private static native int[] nativeSortByAge(long handle, boolean ascending);
+    private static native int[] nativeSortByName(long handle);
+    private static native long[] nativeAgeStats(long handle, int[] rows);
+    private static native void nativeAddAge(long handle, int[] rows, int delta);
+    private static native void nativeSetName(long handle, int[] rows, String name);
+    private static native int nativeWriteBack(long handle, Student[] students);
+}